@@ -32,6 +32,9 @@
 #ifndef GARDENBEDCOMMON
 #define GARDENBEDCOMMON
 
+#include <LightRamp.h>
+#include <ModbusGroups.h>
+
 namespace GardenBed
 {
 
@@ -40,7 +43,14 @@ namespace GardenBed
 #define MODBUS_ID 2
 
 enum MODBUS_HOLDING_REGISTERS {
+    // Target light intensity as a percentage, the light ramps to each new value by itself
     GARDEN_LIGHT_COMMAND = MODBUS_START_REGISTER,
+    // Time to reach a new command in LIGHT_RAMP_TIME_UNIT, 0 to step. Written with the command to fade in one request
+    GARDEN_LIGHT_RAMP_TIME,
+    // LightRampCurve of the ramp to a new command
+    GARDEN_LIGHT_RAMP_CURVE,
+    // Current light intensity as a percentage, follows the ramp. Writes are overwritten
+    GARDEN_LIGHT_LEVEL,
     TOTAL_HOLDING_REGISTERS
 };
 
@@ -1,9 +1,6 @@
 #include <Arduino.h>
 
-#define USE_HOLDING_REGISTERS_ONLY
-
-#include <Modbus.h>
-#include <ModbusSerial.h>
+#include <ModbusSlave.h>
 #include <GardenBedCommon.h>
 
 // Modbus configuration
@@ -13,36 +10,97 @@
 // Misc configuration
 #define LIGHT_OUT_PIN 3
 
-ModbusSerial modbusClient;
+ModbusSlave modbusSlave;
+LightRamp lightRamp;
 
 using namespace GardenBed;
 
+// The registers the slave serves, sized by their enum
+uint16_t holdingRegisters[TOTAL_HOLDING_REGISTERS];
+uint16_t groupRegisters[GROUP_REGISTER_COUNT];
+
 void setup()
 {
     pinMode(LIGHT_OUT_PIN, OUTPUT);
 
     // Config Modbus Serial (port, speed, byte format)
-    modbusClient.config(&Serial1, MODBUS_BAUD_RATE, SERIAL_8N2, MAX485_ENABLE_PIN);
+    modbusSlave.config(&Serial1, MODBUS_BAUD_RATE, SERIAL_8N2, MAX485_ENABLE_PIN);
     // Set the Slave ID
-    modbusClient.setSlaveId(MODBUS_ID);
+    modbusSlave.setSlaveId(MODBUS_ID);
 
     // Configure our holding registers (Read/Write)
-    for (int i = TOTAL_HOLDING_REGISTERS - 1; i >= MODBUS_START_REGISTER; i--)
+    modbusSlave.addHoldingRegisters(MODBUS_START_REGISTER, holdingRegisters, TOTAL_HOLDING_REGISTERS);
+    // Group commands are broadcast to the same block on every device
+    modbusSlave.addHoldingRegisters(GROUP_REGISTERS_ADDRESS, groupRegisters, GROUP_REGISTER_COUNT);
+}
+
+/**
+ * @brief Copies a new group command into the light registers if the bed is in one of its groups,
+ * so it ramps exactly as if the hub had written to the bed alone
+ * 
+ */
+inline void groupHandler()
+{
+    static word lastSequence = 0;
+
+    word sequence = modbusSlave.Hreg(GROUP_REGISTER(GROUP_SEQUENCE));
+
+    if (sequence == lastSequence)
     {
-        modbusClient.addHreg(i, 0);
+        return;
     }
 
+    lastSequence = sequence;
+
+    // The whole command arrives in a single broadcast, so the rest of it is already set
+    if (!inGroups(modbusSlave.Hreg(GROUP_REGISTER(GROUP_MEMBERSHIP)), modbusSlave.Hreg(GROUP_REGISTER(GROUP_MASK))))
+    {
+        return;
+    }
+
+    modbusSlave.Hreg(GARDEN_LIGHT_RAMP_TIME, modbusSlave.Hreg(GROUP_REGISTER(GROUP_RAMP_TIME)));
+    modbusSlave.Hreg(GARDEN_LIGHT_RAMP_CURVE, modbusSlave.Hreg(GROUP_REGISTER(GROUP_RAMP_CURVE)));
+    modbusSlave.Hreg(GARDEN_LIGHT_COMMAND, modbusSlave.Hreg(GROUP_REGISTER(GROUP_LEVEL)));
+    modbusSlave.Hreg(GROUP_REGISTER(GROUP_APPLIED), sequence);
 }
 
-void loop()
+/**
+ * @brief Starts a ramp whenever the light command changes, and drives the light along it
+ * 
+ */
+inline void lightHandler()
 {
-    // Modbus main execute task. Update values etc
-    modbusClient.task();
+    static word lastLightCommand = 0;
+    static int lastDuty = -1;
 
-    int lightCommand = map(min(modbusClient.Hreg(GARDEN_LIGHT_COMMAND), 100), 0, 100, 0, 255);
+    unsigned long now = millis();
+    word lightCommand = modbusSlave.Hreg(GARDEN_LIGHT_COMMAND);
 
-    analogWrite(LIGHT_OUT_PIN, lightCommand);
+    // The ramp time and curve arrive in the same request as the command, so they are already set
+    if (lightCommand != lastLightCommand)
+    {
+        uint32_t duration = (uint32_t) modbusSlave.Hreg(GARDEN_LIGHT_RAMP_TIME) * LIGHT_RAMP_TIME_UNIT;
+
+        lightRamp.begin(lightDuty(lightCommand), duration, modbusSlave.Hreg(GARDEN_LIGHT_RAMP_CURVE), now);
+        lastLightCommand = lightCommand;
+    }
+
+    uint8_t duty = lightRamp.update(now);
+
+    if (duty != lastDuty)
+    {
+        analogWrite(LIGHT_OUT_PIN, duty);
+        modbusSlave.Hreg(GARDEN_LIGHT_LEVEL, lightLevel(duty));
+        lastDuty = duty;
+    }
+}
+
+void loop()
+{
+    // Modbus main execute task. Update values etc
+    modbusSlave.task();
 
-    // Using delay here as it's a fairly simple sketch
-    delay(250);
+    groupHandler();
+    // No delay, the ramp is only smooth if the light is updated every few milliseconds
+    lightHandler();
 }
@@ -32,6 +32,9 @@
 #ifndef GARDENSHEDCOMMON
 #define GARDENSHEDCOMMON
 
+#include <LightRamp.h>
+#include <ModbusEvents.h>
+#include <ModbusGroups.h>
 #include <ModbusUtils.h>
 
 namespace GardenShed
@@ -41,31 +44,75 @@ namespace GardenShed
 #define MODBUS_START_REGISTER 0
 #define MODBUS_ID 3
 
+// Longest identity strings held in the input registers, longer strings are truncated
+#define VICTRON_SERIAL_NUMBER_LENGTH 12
+#define VICTRON_PRODUCT_ID_LENGTH 6
+#define VICTRON_FIRMWARE_LENGTH 6
+
+// Door and light changes held for the hub. Every register costs RAM on the shed, so the ring only covers a few polls
+#define SHED_EVENT_LOG_LENGTH 4
+
+// Types of the events in SHED_EVENTS
+enum SHED_EVENT_TYPES {
+    SHED_EVENT_DOOR,        // Value is 1 when the door opened, 0 when it closed
+    SHED_EVENT_LIGHT        // Value is the light intensity being ramped to, as a percentage
+};
+
 enum MODBUS_INPUT_REGISTERS {
     DOUBLE_REGISTER_VALUE(VICTRON_VOLTAGE, MODBUS_START_REGISTER),
     DOUBLE_REGISTER(VICTRON_PANEL_VOLTAGE),
-    VICTRON_CURRENT,
+    // Currents pass 32.767 A in mA, so they take two registers like the voltages
+    DOUBLE_REGISTER(VICTRON_CURRENT),
     VICTRON_PANEL_POWER,
-    VICTRON_LOAD_CURRENT,
+    DOUBLE_REGISTER(VICTRON_LOAD_CURRENT),
     VICTRON_OPERATION_STATE,
     VICTRON_ERROR_STATE,
     VICTRON_LOAD,
-    VICTRON_YIELD_TOTAL,
+    // Lifetime yield in 0.01 kWh, past 16 bits after 655 kWh
+    DOUBLE_REGISTER(VICTRON_YIELD_TOTAL),
     VICTRON_YIELD_TODAY,
     VICTRON_MAX_POWER_TODAY,
     VICTRON_YIELD_YESTERDAY,
     VICTRON_MAX_POWER_YESTERDAY,
     VICTRON_TRACKER_OPERATION_MODE,
     VICTRON_DAY_SEQUENCE,
-    VICTRON_SERIAL_NUMBER,
-    VICTRON_PRODUCT_ID,
-    VICTRON_FIRMWARE,
+    // Identity strings, packed two characters a register so they arrive with every bulk read
+    STRING_REGISTER(VICTRON_SERIAL_NUMBER, VICTRON_SERIAL_NUMBER_LENGTH),
+    STRING_REGISTER(VICTRON_PRODUCT_ID, VICTRON_PRODUCT_ID_LENGTH),
+    STRING_REGISTER(VICTRON_FIRMWARE, VICTRON_FIRMWARE_LENGTH),
     VICTRON_OFF_REASON,
+    // Last VE.Direct HEX register received, either requested or async
+    VICTRON_HEX_ADDRESS,
+    VICTRON_HEX_FLAGS,
+    DOUBLE_REGISTER(VICTRON_HEX_VALUE),
+    // Current light intensity as a percentage, follows ramps and the door
+    SHED_LIGHT_LEVEL,
+    // 1 while the door is open
+    SHED_DOOR_STATE,
+    // Times the door has opened since the shed started
+    SHED_DOOR_OPEN_COUNT,
+    // Shed uptime in seconds when the door last opened or closed
+    DOUBLE_REGISTER(SHED_DOOR_CHANGED),
+    // Door and light changes, small enough for the hub to read every poll without the rest of the registers
+    EVENT_LOG(SHED_EVENTS, SHED_EVENT_LOG_LENGTH),
     TOTAL_INPUT_REGISTERS
 };
 
+enum MODBUS_DISCRETE_INPUTS {
+    SHED_DOOR_OPEN = MODBUS_START_REGISTER,
+    SHED_LIGHT_ON,
+    TOTAL_DISCRETE_INPUTS
+};
+
 enum MODBUS_HOLDING_REGISTERS {
+    // Light intensity as a percentage while the door is open, the light ramps to each new value by itself
     SHED_LIGHT_COMMAND = MODBUS_START_REGISTER,
+    // Time to reach a new command in LIGHT_RAMP_TIME_UNIT, 0 to step. Written with the command to fade in one request
+    SHED_LIGHT_RAMP_TIME,
+    // LightRampCurve of the ramp to a new command
+    SHED_LIGHT_RAMP_CURVE,
+    // Writing a VE.Direct register address here requests it from the charger. Cleared once sent
+    VICTRON_HEX_REQUEST,
     TOTAL_HOLDING_REGISTERS
 };
 
@@ -4,8 +4,7 @@
 
 #include <GardenShedCommon.h>
 
-#include <Modbus.h>
-#include <ModbusSerial.h>
+#include <ModbusSlave.h>
 
 // Serial configuration
 #define SERIAL_TIMER 500UL
@@ -26,6 +25,8 @@
 #define LIGHT_OUT_PIN 5
 #define DOOR_SENSOR_PIN 10
 #define DEBOUNCE_TIMER 5
+// Milliseconds to fade the light when the door opens or closes
+#define DOOR_RAMP_TIME 500UL
 
 enum DoorState
 {
@@ -34,7 +35,20 @@ enum DoorState
 };
 
 
-ModbusSerial modbusClient;
+ModbusSlave modbusSlave;
+LightRamp lightRamp;
+
+// Seconds since the shed started, kept separately from millis so it does not wrap after 49 days
+uint32_t uptime = 0;
+uint16_t eventSequence = 0;
+
+using namespace GardenShed;
+
+// The registers the slave serves, sized by their enums
+uint16_t inputRegisters[TOTAL_INPUT_REGISTERS];
+uint16_t holdingRegisters[TOTAL_HOLDING_REGISTERS];
+uint16_t groupRegisters[GROUP_REGISTER_COUNT];
+uint8_t discreteInputs[TOTAL_DISCRETE_INPUTS];
 
 /**
  * @brief Called for each field when the VictronParser recieves a valid transmission
@@ -48,50 +62,87 @@ void victronDataHandler(uint32_t id, void* data, size_t size)
     switch (id)
     {
         case VOLTAGE:
-            WRITE_DOUBLE_REGISTER(modbusClient.Ireg, VICTRON_VOLTAGE, *((int32_t*) data));
+            WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_VOLTAGE, *((int32_t*) data));
             break;
         case PANEL_VOLTAGE:
-            WRITE_DOUBLE_REGISTER(modbusClient.Ireg, VICTRON_PANEL_VOLTAGE, *((int32_t*) data));
+            WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_PANEL_VOLTAGE, *((int32_t*) data));
             break;
         case CURRENT:
-            modbusClient.Ireg(VICTRON_CURRENT, *((int16_t*) data));
+            WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_CURRENT, *((int32_t*) data));
             break;    
+        case PANEL_POWER:
+            modbusSlave.Ireg(VICTRON_PANEL_POWER, *((int16_t*) data));
+            break;
+        case LOAD_CURRENT:
+            WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_LOAD_CURRENT, *((int32_t*) data));
+            break;
+        case YIELD_TOTAL:
+            WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_YIELD_TOTAL, *((int32_t*) data));
+            break;
         case YIELD_TODAY:
-            modbusClient.Ireg(VICTRON_YIELD_TOTAL, *((int16_t*) data));
+            modbusSlave.Ireg(VICTRON_YIELD_TODAY, *((int16_t*) data));
             break;
         case MAX_POWER_TODAY:
-            modbusClient.Ireg(VICTRON_MAX_POWER_TODAY, *((int16_t*) data));
+            modbusSlave.Ireg(VICTRON_MAX_POWER_TODAY, *((int16_t*) data));
             break;
         case YIELD_YESTERDAY:
-            modbusClient.Ireg(VICTRON_YIELD_YESTERDAY, *((int16_t*) data));
+            modbusSlave.Ireg(VICTRON_YIELD_YESTERDAY, *((int16_t*) data));
             break;
         case MAX_POWER_YESTERDAY:
-            modbusClient.Ireg(VICTRON_MAX_POWER_YESTERDAY, *((int16_t*) data));
+            modbusSlave.Ireg(VICTRON_MAX_POWER_YESTERDAY, *((int16_t*) data));
             break;
         case DAY_SEQUENCE:
-            modbusClient.Ireg(VICTRON_DAY_SEQUENCE, *((int16_t*) data));
+            modbusSlave.Ireg(VICTRON_DAY_SEQUENCE, *((int16_t*) data));
             break;
         case OPERATION_STATE:
-            modbusClient.Ireg(VICTRON_OPERATION_STATE, *((int8_t*) data));
+            modbusSlave.Ireg(VICTRON_OPERATION_STATE, *((uint8_t*) data));
             break;
         case ERROR_STATE:
-            modbusClient.Ireg(VICTRON_ERROR_STATE, *((int8_t*) data));
+            modbusSlave.Ireg(VICTRON_ERROR_STATE, *((int8_t*) data));
             break;
         case TRACKER_OPERATION_MODE:
-            modbusClient.Ireg(VICTRON_TRACKER_OPERATION_MODE, *((int8_t*) data));
+            modbusSlave.Ireg(VICTRON_TRACKER_OPERATION_MODE, *((int8_t*) data));
             break;
         case LOAD:
-            modbusClient.Ireg(VICTRON_LOAD, *((bool*) data));
+            modbusSlave.Ireg(VICTRON_LOAD, *((bool*) data));
+            break;
+        case OFF_REASON: // Bitmask, all defined reasons fit in the lower 16 bits
+            modbusSlave.Ireg(VICTRON_OFF_REASON, *((uint32_t*) data) & 0xFFFF);
+            break;
+        case PRODUCT_ID: // Strings are copied straight out of the parser block into their register span
+            WRITE_STRING_REGISTER(modbusSlave.Ireg, VICTRON_PRODUCT_ID, (const char*) data, victronStringView(data, size).length);
             break;
-        case PRODUCT_ID: // All Strings, Might implement in Modbus later
         case FIRMWARE:
+        case FIRMWARE_24:
+            WRITE_STRING_REGISTER(modbusSlave.Ireg, VICTRON_FIRMWARE, (const char*) data, victronStringView(data, size).length);
+            break;
         case SERIAL_NUMBER:
-        case OFF_REASON:
+            WRITE_STRING_REGISTER(modbusSlave.Ireg, VICTRON_SERIAL_NUMBER, (const char*) data, victronStringView(data, size).length);
+            break;
         default:
             break;
     }
 };
 
+/**
+ * @brief Called for each valid VE.Direct HEX frame. Get responses and async updates are exposed to the hub
+ * 
+ * @param frame The decoded frame
+ */
+void victronHexHandler(VictronHexFrame_t* frame)
+{
+    if (frame->command != VICTRON_HEX_GET && frame->command != VICTRON_HEX_ASYNC)
+    {
+        return;
+    }
+
+    uint32_t value = victronHexValue(frame);
+
+    modbusSlave.Ireg(VICTRON_HEX_ADDRESS, frame->address);
+    modbusSlave.Ireg(VICTRON_HEX_FLAGS, frame->flags);
+    WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, VICTRON_HEX_VALUE, value);
+};
+
 VictronParser victronParser = VictronParser(victronDataHandler);
 SoftwareSerial softwareSerial = SoftwareSerial(SOFTWARE_SERIAL_RX, SOFTWARE_SERIAL_TX);
 
@@ -102,26 +153,103 @@ void setup()
     pinMode(SOFTWARE_SERIAL_TX, OUTPUT);
 
     softwareSerial.begin(VICTRON_BAUD_RATE);
+    victronParser.setHexHandler(victronHexHandler);
 
     pinMode(DOOR_SENSOR_PIN, INPUT_PULLUP);
     pinMode(LIGHT_OUT_PIN, OUTPUT);
 
     // Config Modbus Serial (port, speed, byte format)
-    modbusClient.config(&Serial, MODBUS_BAUD_RATE, SERIAL_8N2, MAX485_ENABLE_PIN);
+    modbusSlave.config(&Serial, MODBUS_BAUD_RATE, SERIAL_8N2, MAX485_ENABLE_PIN);
     // Set the Slave ID
-    modbusClient.setSlaveId(MODBUS_ID);
+    modbusSlave.setSlaveId(MODBUS_ID);
+
+    // Input registers and discrete inputs (Read only), holding registers (Read/Write)
+    modbusSlave.addInputRegisters(MODBUS_START_REGISTER, inputRegisters, TOTAL_INPUT_REGISTERS);
+    modbusSlave.addHoldingRegisters(MODBUS_START_REGISTER, holdingRegisters, TOTAL_HOLDING_REGISTERS);
+    // Group commands are broadcast to the same block on every device
+    modbusSlave.addHoldingRegisters(GROUP_REGISTERS_ADDRESS, groupRegisters, GROUP_REGISTER_COUNT);
+    modbusSlave.addDiscreteInputs(MODBUS_START_REGISTER, discreteInputs, TOTAL_DISCRETE_INPUTS);
+}
+
+/**
+ * @brief Adds an event to the log the hub reads each poll
+ * 
+ * @param type A SHED_EVENT_TYPES
+ * @param value 
+ */
+inline void logEvent(uint16_t type, uint16_t value)
+{
+    eventSequence++;
+    WRITE_EVENT(modbusSlave.Ireg, SHED_EVENTS, eventSequence, type, value, uptime);
+}
+
+/**
+ * @brief Starts ramping the light, logging an event if it is heading somewhere new
+ * 
+ * @param level Percentage
+ * @param duration Milliseconds
+ * @param curve A LightRampCurve
+ */
+inline void rampLight(word level, uint32_t duration, uint8_t curve)
+{
+    uint8_t duty = lightDuty(level);
+
+    if (duty != lightRamp.getTarget())
+    {
+        logEvent(SHED_EVENT_LIGHT, lightLevel(duty));
+    }
+
+    lightRamp.begin(duty, duration, curve, millis());
+}
+
+/**
+ * @brief Exposes a debounced door change to the hub
+ * 
+ * @param open 
+ */
+inline void doorChanged(bool open)
+{
+    static word openCount = 0;
 
-    // Configure our input registers (Read only)
-    for (int i = TOTAL_INPUT_REGISTERS - 1; i >= MODBUS_START_REGISTER; i--)
+    if (open)
     {
-        modbusClient.addIreg(i, 0);
+        modbusSlave.Ireg(SHED_DOOR_OPEN_COUNT, ++openCount);
     }
 
-    // Configure our holding registers (Read/Write)
-    for (int i = TOTAL_HOLDING_REGISTERS - 1; i >= MODBUS_START_REGISTER; i--)
+    modbusSlave.Ists(SHED_DOOR_OPEN, open);
+    modbusSlave.Ireg(SHED_DOOR_STATE, open);
+    WRITE_DOUBLE_REGISTER(modbusSlave.Ireg, SHED_DOOR_CHANGED, uptime);
+    logEvent(SHED_EVENT_DOOR, open);
+}
+
+/**
+ * @brief Copies a new group command into the light registers if the shed is in one of its groups.
+ * The door handler then ramps to it while the door is open, as if the hub had written to the shed alone
+ * 
+ */
+inline void groupHandler()
+{
+    static word lastSequence = 0;
+
+    word sequence = modbusSlave.Hreg(GROUP_REGISTER(GROUP_SEQUENCE));
+
+    if (sequence == lastSequence)
+    {
+        return;
+    }
+
+    lastSequence = sequence;
+
+    // The whole command arrives in a single broadcast, so the rest of it is already set
+    if (!inGroups(modbusSlave.Hreg(GROUP_REGISTER(GROUP_MEMBERSHIP)), modbusSlave.Hreg(GROUP_REGISTER(GROUP_MASK))))
     {
-        modbusClient.addHreg(i, 0);
+        return;
     }
+
+    modbusSlave.Hreg(SHED_LIGHT_RAMP_TIME, modbusSlave.Hreg(GROUP_REGISTER(GROUP_RAMP_TIME)));
+    modbusSlave.Hreg(SHED_LIGHT_RAMP_CURVE, modbusSlave.Hreg(GROUP_REGISTER(GROUP_RAMP_CURVE)));
+    modbusSlave.Hreg(SHED_LIGHT_COMMAND, modbusSlave.Hreg(GROUP_REGISTER(GROUP_LEVEL)));
+    modbusSlave.Hreg(GROUP_REGISTER(GROUP_APPLIED), sequence);
 }
 
 /**
@@ -155,10 +283,20 @@ inline void doorHandler()
     // Button is pressed if digitalRead returns 0
     if (digitalRead(DOOR_SENSOR_PIN) == 1)
     {
-        word lightCommand = modbusClient.Hreg(SHED_LIGHT_COMMAND);
-        if (debounceCheck(OPEN) || lightCommand != lastLightCommand) 
+        word lightCommand = modbusSlave.Hreg(SHED_LIGHT_COMMAND);
+        if (debounceCheck(OPEN)) 
+        {
+            doorChanged(true);
+            // The door always fades quickly, whatever ramp the hub last asked for
+            rampLight(lightCommand, DOOR_RAMP_TIME, RAMP_PERCEPTUAL);
+            lastLightCommand = lightCommand;
+        }
+        else if (doorState == OPEN && lightCommand != lastLightCommand)
         {
-            analogWrite(LIGHT_OUT_PIN, map(min(lightCommand, 100), 0, 100, 0, 255));
+            // The ramp time and curve arrive in the same request as the command, so they are already set
+            uint32_t duration = (uint32_t) modbusSlave.Hreg(SHED_LIGHT_RAMP_TIME) * LIGHT_RAMP_TIME_UNIT;
+
+            rampLight(lightCommand, duration, modbusSlave.Hreg(SHED_LIGHT_RAMP_CURVE));
             lastLightCommand = lightCommand;
         }
     }
@@ -166,11 +304,51 @@ inline void doorHandler()
     {
         if (debounceCheck(CLOSED)) 
         {
-            analogWrite(LIGHT_OUT_PIN, 0);
+            doorChanged(false);
+            rampLight(0, DOOR_RAMP_TIME, RAMP_PERCEPTUAL);
         }
     }
 }
 
+/**
+ * @brief Drives the light along the current ramp
+ * 
+ */
+inline void lightHandler()
+{
+    static int lastDuty = -1;
+
+    uint8_t duty = lightRamp.update(millis());
+
+    if (duty != lastDuty)
+    {
+        analogWrite(LIGHT_OUT_PIN, duty);
+        modbusSlave.Ireg(SHED_LIGHT_LEVEL, lightLevel(duty));
+        modbusSlave.Ists(SHED_LIGHT_ON, duty > 0);
+        lastDuty = duty;
+    }
+}
+
+/**
+ * @brief Counts the uptime the events are timestamped with
+ * 
+ */
+inline void uptimeHandler()
+{
+    static unsigned long lastSecond = millis();
+
+    if (millis() - lastSecond >= 1000UL)
+    {
+        while (millis() - lastSecond >= 1000UL)
+        {
+            lastSecond += 1000UL;
+            uptime++;
+        }
+
+        WRITE_EVENT_LOG_UPTIME(modbusSlave.Ireg, SHED_EVENTS, uptime);
+    }
+}
+
 /**
  * @brief Reads from the victron serial and handles 
  * 
@@ -180,6 +358,15 @@ inline void victronHandler()
     // Buffer for reading from the serial line
     static char buffer[SERIAL_BUFFER_SIZE];
 
+    // Forward any register request from the hub, the charger answers between text blocks
+    word request = modbusSlave.Hreg(VICTRON_HEX_REQUEST);
+    if (request != 0)
+    {
+        int length = victronHexEncodeGet(request, buffer, SERIAL_BUFFER_SIZE);
+        softwareSerial.write(buffer, length);
+        modbusSlave.Hreg(VICTRON_HEX_REQUEST, 0);
+    }
+
     // Read buffer until nothing left
     while(softwareSerial.available() > SERIAL_BUFFER_MIN)
     {
@@ -199,8 +386,13 @@ void loop()
     if (difference > SERIAL_TIMER || difference > MAX_SERIAL_TIMER)
     {
         // Modbus main execute task. Update values etc
-        modbusClient.task();
+        modbusSlave.task();
+        groupHandler();
         doorHandler();
         victronHandler();
     }
+
+    // Outside the timer, the ramp is only smooth if the light is updated every few milliseconds
+    lightHandler();
+    uptimeHandler();
 }
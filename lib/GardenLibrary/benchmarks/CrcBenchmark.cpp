@@ -1,7 +1,7 @@
 /*
- * File: GardenShedClient.cpp
+ * File: CrcBenchmark.cpp
  * Project: gardener
- * Created Date: Saturday November 12th 2022
+ * Created Date: Monday October 19th 2026
  * Author: Kyle Hofer
  * 
  * MIT License
@@ -29,48 +29,40 @@
  * HISTORY:
  */
 
-#include "GardenShedClient.h"
-#include "GardenShedCommon.h"
-#include <iostream>
 
-using namespace GardenShed;
 
-#define LIGHT_HIGH 15
-#define LIGHT_LOW 0
 
-// This is a delay to prevent polling/writing at too high of a frequency
-// This is chosen purely from testing and hasn't yet been chosen by calculations
-#define POLL_TIME 5
-#define GARDEN_SHED "Garden Shed: " <<
+/**
+ * CRC-16/MODBUS throughput of each variant, from a request frame up to the longest RTU frame
+ * and past it, as a capture tool would checksum a whole log.
+ */
 
-GardenShedClient::GardenShedClient() : ModbusClient() {};
-GardenShedClient::GardenShedClient(ModbusConnection* connection) : ModbusClient(connection, MODBUS_ID) {};
+#include <benchmark/benchmark.h>
 
-int32_t GardenShedClient::doExecute()
-{
-    uint16_t registers[TOTAL_HOLDING_REGISTERS];
-    uint16_t inputRegisters[TOTAL_INPUT_REGISTERS];
-    
-    int result;
+#include "ModbusCrc.h"
 
-    result = readInputRegisters(MODBUS_START_REGISTER, TOTAL_INPUT_REGISTERS, inputRegisters);
+#define BENCHMARK_MAX_LENGTH 4096
 
-    if (result < 0)
-    {
-        // return POLL_TIME;
-    }
+static uint8_t data[BENCHMARK_MAX_LENGTH];
 
-    result = readRegisters(MODBUS_START_REGISTER, TOTAL_HOLDING_REGISTERS, registers);
+template <uint16_t (*Crc)(uint16_t, const uint8_t*, size_t)> static void BM_Crc(benchmark::State& state)
+{
+    size_t length = state.range(0);
 
-    if (result < 0)
+    for (size_t i = 0; i < length; i++)
     {
-        // return POLL_TIME;
+        data[i] = i * 31 + 7;
     }
 
-    if (registers[SHED_LIGHT_COMMAND] != LIGHT_HIGH)
+    for (auto _ : state)
     {
-        writeRegister(SHED_LIGHT_COMMAND + MODBUS_START_REGISTER, LIGHT_HIGH);
+        benchmark::DoNotOptimize(data);
+        benchmark::DoNotOptimize(Crc(MODBUS_CRC_INITIAL, data, length));
     }
 
-    return POLL_TIME;
-}
\ No newline at end of file
+    state.SetBytesProcessed(state.iterations() * length);
+}
+// 8 bytes is a request, 256 the longest RTU frame
+BENCHMARK_TEMPLATE(BM_Crc, modbusCrcBitwise)->Arg(8)->Arg(256)->Arg(BENCHMARK_MAX_LENGTH);
+BENCHMARK_TEMPLATE(BM_Crc, modbusCrcTable)->Arg(8)->Arg(256)->Arg(BENCHMARK_MAX_LENGTH);
+BENCHMARK_TEMPLATE(BM_Crc, modbusCrcSlicing)->Arg(8)->Arg(256)->Arg(BENCHMARK_MAX_LENGTH);
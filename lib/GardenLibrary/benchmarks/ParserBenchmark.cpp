@@ -0,0 +1,205 @@
+/*
+ * File: ParserBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+/**
+ * VictronParser benchmarks, run against the release libgardenlibrary.
+ * 
+ * A capture of MPPT and BMV blocks with an interleaved HEX frame is parsed in reads of several
+ * sizes, from single bytes as an interrupt driven reader would see them, up to whole buffers.
+ * Heap allocations are counted per block, which should stay at zero.
+ */
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "VictronParser.h"
+
+// Copies of the capture parsed per iteration, so single byte reads still run long enough to time
+#define CAPTURE_REPEATS 64
+
+using namespace std;
+
+static const char MPPT_BLOCK[] = "\r\nPID\t0xA053\r\nFW\t159\r\nSER#\tHQ21094NFGX\r\nV\t22930\r\nI\t-50\r\nVPV\t41200\r\nPPV\t8\r\nCS\t3\r\nMPPT\t2\r\nOR\t0x00000000\r\nERR\t0\r\nLOAD\tON\r\nIL\t400\r\nH19\t2679\r\nH20\t1\r\nH21\t14\r\nH22\t18\r\nH23\t79\r\nHSDS\t297\r\nChecksum\t";
+static const char BMV_BLOCK[] = "\r\nPID\t0x203\r\nV\t26201\r\nVS\t13104\r\nI\t-3480\r\nP\t-91\r\nCE\t-7200\r\nSOC\t876\r\nTTG\t1230\r\nAlarm\tOFF\r\nRelay\tON\r\nAR\t0\r\nBMV\t700\r\nFW\t0308\r\nH1\t-102345\r\nH9\t86400\r\nH17\t4567\r\nChecksum\t";
+static const char ASYNC_FRAME[] = ":A010200040044\n";
+
+// Only allocations made while the parser is running are counted, not those of the framework
+static atomic<uint64_t> allocations(0);
+static atomic<bool> counting(false);
+
+void* operator new(size_t size)
+{
+    if (counting)
+    {
+        allocations++;
+    }
+
+    void* pointer = malloc(size);
+
+    if (pointer == NULL)
+    {
+        throw bad_alloc();
+    }
+
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t size) noexcept
+{
+    free(pointer);
+}
+
+class CountingHandler : public VictronFieldHandler
+{
+public:
+    uint64_t fields = 0;
+
+    void fieldUpdate(uint32_t id, void* data, size_t size)
+    {
+        benchmark::DoNotOptimize(data);
+        fields++;
+    }
+};
+
+static string withChecksum(const char* block)
+{
+    string result(block);
+    char checksum = 0;
+
+    for (char input : result)
+    {
+        checksum -= input;
+    }
+
+    return result + checksum;
+}
+
+static const string& capture()
+{
+    static string result;
+
+    if (result.empty())
+    {
+        string pattern = withChecksum(MPPT_BLOCK) + ASYNC_FRAME + withChecksum(BMV_BLOCK);
+
+        for (int i = 0; i < CAPTURE_REPEATS; i++)
+        {
+            result += pattern;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Parse throughput by read size. Reports blocks and heap allocations per block alongside the byte rate.
+ */
+static void BM_Parse(benchmark::State& state)
+{
+    const string& input = capture();
+    size_t readSize = state.range(0);
+    CountingHandler handler;
+    VictronParser parser(&handler);
+    uint64_t allocationsBefore = allocations;
+
+    for (auto _ : state)
+    {
+        counting = true;
+
+        for (size_t index = 0; index < input.size(); index += readSize)
+        {
+            parser.parse(input.c_str() + index, min(readSize, input.size() - index));
+        }
+
+        counting = false;
+    }
+
+    VictronStatistics_t statistics = parser.getStatistics();
+
+    if (statistics.blocksLost != 0)
+    {
+        state.SkipWithError("Blocks were lost parsing a clean capture");
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.size());
+    state.counters["blocks"] = benchmark::Counter(statistics.blocks, benchmark::Counter::kIsRate);
+    state.counters["allocs/block"] = statistics.blocks ? (double) (allocations - allocationsBefore) / statistics.blocks : 0;
+}
+BENCHMARK(BM_Parse)->Arg(1)->Arg(16)->Arg(64)->Arg(4096);
+
+/**
+ * @brief Cost of a single block, from the first byte to the last field handed to the handler
+ */
+static void BM_ParseBlock(benchmark::State& state)
+{
+    string block = withChecksum(MPPT_BLOCK);
+    CountingHandler handler;
+    VictronParser parser(&handler);
+
+    for (auto _ : state)
+    {
+        parser.parse(block.c_str(), block.size());
+    }
+
+    state.SetBytesProcessed(state.iterations() * block.size());
+    state.counters["fields"] = benchmark::Counter(handler.fields, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ParseBlock);
+
+/**
+ * @brief Label lookup, the per line cost of every field
+ */
+static void BM_FindLabel(benchmark::State& state)
+{
+    const char* labels[] = { "V", "VPV", "PPV", "SER#", "Checksum", "AC_OUT_V", "H19", "UNKNOWN" };
+    VictronLabel_t label;
+
+    for (auto _ : state)
+    {
+        for (const char* name : labels)
+        {
+            benchmark::DoNotOptimize(victronFindLabel(name, &label));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * (sizeof(labels) / sizeof(labels[0])));
+}
+BENCHMARK(BM_FindLabel);
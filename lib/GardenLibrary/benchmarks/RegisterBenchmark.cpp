@@ -0,0 +1,144 @@
+/*
+ * File: RegisterBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+/**
+ * Register codec benchmarks: converting a register snapshot into measurements, and packing
+ * 32 bit values and strings into registers as the slaves do on every update.
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+#include "ModbusUtils.h"
+#include "Units.h"
+
+// A snapshot laid out like the shed input registers
+enum BENCHMARK_REGISTERS {
+    DOUBLE_REGISTER(BENCHMARK_VOLTAGE),
+    DOUBLE_REGISTER(BENCHMARK_PANEL_VOLTAGE),
+    BENCHMARK_CURRENT,
+    BENCHMARK_PANEL_POWER,
+    BENCHMARK_LOAD_CURRENT,
+    BENCHMARK_YIELD_TOTAL,
+    BENCHMARK_YIELD_TODAY,
+    BENCHMARK_STATE,
+    STRING_REGISTER(BENCHMARK_SERIAL_NUMBER, 12),
+    TOTAL_BENCHMARK_REGISTERS
+};
+
+static const RegisterUnit_t BENCHMARK_UNITS[] = {
+    { BENCHMARK_VOLTAGE_UPPER,          REGISTER_INT32,     UNIT_VOLT,              -3 },
+    { BENCHMARK_PANEL_VOLTAGE_UPPER,    REGISTER_INT32,     UNIT_VOLT,              -3 },
+    { BENCHMARK_CURRENT,                REGISTER_INT16,     UNIT_AMP,               -3 },
+    { BENCHMARK_PANEL_POWER,            REGISTER_UINT16,    UNIT_WATT,              0 },
+    { BENCHMARK_LOAD_CURRENT,           REGISTER_INT16,     UNIT_AMP,               -3 },
+    { BENCHMARK_YIELD_TOTAL,            REGISTER_UINT16,    UNIT_KILOWATT_HOUR,     -2 },
+    { BENCHMARK_YIELD_TODAY,            REGISTER_UINT16,    UNIT_KILOWATT_HOUR,     -2 },
+    { BENCHMARK_STATE,                  REGISTER_UINT16,    UNIT_NONE,              0 }
+};
+
+#define BENCHMARK_UNITS_COUNT (sizeof(BENCHMARK_UNITS) / sizeof(RegisterUnit_t))
+
+static uint16_t registers[TOTAL_BENCHMARK_REGISTERS];
+
+static void writeRegister(int address, uint16_t value)
+{
+    registers[address] = value;
+}
+
+static void BM_ConvertRegisters(benchmark::State& state)
+{
+    Measurement_t measurements[BENCHMARK_UNITS_COUNT];
+
+    WRITE_DOUBLE_REGISTER(writeRegister, BENCHMARK_VOLTAGE, 22930);
+    WRITE_DOUBLE_REGISTER(writeRegister, BENCHMARK_PANEL_VOLTAGE, 41200);
+    registers[BENCHMARK_CURRENT] = (uint16_t) -50;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(registers);
+        benchmark::DoNotOptimize(convertRegisters(registers, TOTAL_BENCHMARK_REGISTERS, BENCHMARK_UNITS, BENCHMARK_UNITS_COUNT, measurements));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_UNITS_COUNT);
+}
+BENCHMARK(BM_ConvertRegisters);
+
+static void BM_WriteDoubleRegister(benchmark::State& state)
+{
+    uint32_t value = 0;
+
+    for (auto _ : state)
+    {
+        WRITE_DOUBLE_REGISTER(writeRegister, BENCHMARK_VOLTAGE, value);
+        benchmark::ClobberMemory();
+        value += 12345;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteDoubleRegister);
+
+static void BM_WriteStringRegister(benchmark::State& state)
+{
+    const char* serial = "HQ21094NFGX";
+    size_t length = strlen(serial);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(serial);
+        WRITE_STRING_REGISTER(writeRegister, BENCHMARK_SERIAL_NUMBER, serial, length);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_WriteStringRegister);
+
+static void BM_UnpackStringRegisters(benchmark::State& state)
+{
+    const char* serial = "HQ21094NFGX";
+    char buffer[16];
+
+    WRITE_STRING_REGISTER(writeRegister, BENCHMARK_SERIAL_NUMBER, serial, strlen(serial));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(registers);
+        benchmark::DoNotOptimize(unpackStringRegisters(&registers[BENCHMARK_SERIAL_NUMBER], STRING_REGISTER_COUNT(BENCHMARK_SERIAL_NUMBER), buffer, sizeof(buffer)));
+    }
+
+    state.SetBytesProcessed(state.iterations() * strlen(serial));
+}
+BENCHMARK(BM_UnpackStringRegisters);
@@ -0,0 +1,344 @@
+/*
+ * File: SlaveBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+/**
+ * Register storage of the field devices: ModbusSerial's list of registers against the flat arrays
+ * of ModbusSlave, with the shed's register layout. Covers the register writes of a Victron block,
+ * the group handler, and answering the hub's reads. Cycles are counted on x86 hosts only.
+ */
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_CYCLES 1
+#endif
+
+#include "ModbusSlave.h"
+
+// The shed's tables
+#define BENCHMARK_INPUT_REGISTERS 65
+#define BENCHMARK_HOLDING_REGISTERS 4
+#define BENCHMARK_DISCRETE_INPUTS 2
+// Registers set by one Victron block, the most victronDataHandler sets at a time
+#define BENCHMARK_BLOCK_WRITES 18
+
+// ModbusSerial keeps every table in one list, told apart by an offset on the address
+#define LIST_ISTS_OFFSET 10001
+#define LIST_IREG_OFFSET 30001
+#define LIST_HREG_OFFSET 40001
+
+/**
+ * @brief A register of ModbusSerial, a node each
+ * 
+ */
+typedef struct ListRegister {
+    uint16_t address;
+    uint16_t value;
+    ListRegister* next;
+} ListRegister_t;
+
+/**
+ * @brief Registers kept the way ModbusSerial keeps them, searched from the first added on every access
+ * 
+ */
+class ListSlave
+{
+private:
+    uint8_t slaveId;
+    ListRegister_t* first;
+    ListRegister_t* last;
+
+    ListRegister_t* search(uint16_t address) const
+    {
+        for (ListRegister_t* reg = first; reg != NULL; reg = reg->next)
+        {
+            if (reg->address == address)
+            {
+                return reg;
+            }
+        }
+
+        return NULL;
+    }
+
+    void add(uint16_t address)
+    {
+        ListRegister_t* reg = new ListRegister_t { address, 0, NULL };
+
+        if (first == NULL)
+        {
+            first = reg;
+        }
+        else
+        {
+            last->next = reg;
+        }
+
+        last = reg;
+    }
+
+    uint16_t get(uint16_t address) const
+    {
+        ListRegister_t* reg = search(address);
+
+        return reg == NULL ? 0 : reg->value;
+    }
+
+    bool set(uint16_t address, uint16_t value)
+    {
+        ListRegister_t* reg = search(address);
+
+        if (reg == NULL)
+        {
+            return false;
+        }
+
+        reg->value = value;
+
+        return true;
+    }
+
+public:
+    ListSlave() : slaveId(1), first(NULL), last(NULL) {}
+
+    ~ListSlave()
+    {
+        while (first != NULL)
+        {
+            ListRegister_t* next = first->next;
+            delete first;
+            first = next;
+        }
+    }
+
+    void setSlaveId(uint8_t slaveId) { this->slaveId = slaveId; }
+    void addIreg(uint16_t address) { add(address + LIST_IREG_OFFSET); }
+    void addHreg(uint16_t address) { add(address + LIST_HREG_OFFSET); }
+    void addIsts(uint16_t address) { add(address + LIST_ISTS_OFFSET); }
+    uint16_t Ireg(uint16_t address) const { return get(address + LIST_IREG_OFFSET); }
+    bool Ireg(uint16_t address, uint16_t value) { return set(address + LIST_IREG_OFFSET, value); }
+    uint16_t Hreg(uint16_t address) const { return get(address + LIST_HREG_OFFSET); }
+    bool Hreg(uint16_t address, uint16_t value) { return set(address + LIST_HREG_OFFSET, value); }
+
+    /**
+     * @brief Answers register reads like ModbusSerial: every register is searched for once to check it
+     * exists, then again for its value
+     * 
+     */
+    size_t process(uint8_t* frame, size_t length)
+    {
+        uint8_t id;
+        ModbusPdu_t request;
+        uint8_t* pdu = RTU_PDU(frame);
+        int pduLength = rtuParse(frame, length, &id);
+        uint16_t offset;
+
+        if (pduLength < 0 || id != slaveId || pduParseRequest(pdu, pduLength, &request) != 0)
+        {
+            return 0;
+        }
+
+        offset = request.function == PDU_READ_INPUT_REGISTERS ? LIST_IREG_OFFSET : LIST_HREG_OFFSET;
+
+        for (uint16_t i = 0; i < request.count; i++)
+        {
+            if (search(request.address + offset + i) == NULL)
+            {
+                return rtuFrame(frame, slaveId, pduException(pdu, request.function, PDU_ILLEGAL_DATA_ADDRESS));
+            }
+        }
+
+        pdu[1] = request.count * 2;
+
+        for (uint16_t i = 0; i < request.count; i++)
+        {
+            pduPutWord(&pdu[2 + i * 2], get(request.address + offset + i));
+        }
+
+        return rtuFrame(frame, slaveId, 2 + request.count * 2);
+    }
+};
+
+/**
+ * @brief The shed's registers as ModbusSerial held them, added in the order of its setup
+ * 
+ */
+struct ListShed
+{
+    ListSlave slave;
+
+    ListShed()
+    {
+        for (int i = BENCHMARK_INPUT_REGISTERS - 1; i >= 0; i--)
+        {
+            slave.addIreg(i);
+        }
+
+        for (int i = BENCHMARK_HOLDING_REGISTERS - 1; i >= 0; i--)
+        {
+            slave.addHreg(i);
+        }
+
+        for (int i = GROUP_REGISTER_COUNT - 1; i >= 0; i--)
+        {
+            slave.addHreg(GROUP_REGISTER(i));
+        }
+
+        for (int i = BENCHMARK_DISCRETE_INPUTS - 1; i >= 0; i--)
+        {
+            slave.addIsts(i);
+        }
+    }
+};
+
+/**
+ * @brief The shed's registers in arrays
+ * 
+ */
+struct FlatShed
+{
+    ModbusSlave slave;
+    uint16_t inputRegisters[BENCHMARK_INPUT_REGISTERS];
+    uint16_t holdingRegisters[BENCHMARK_HOLDING_REGISTERS];
+    uint16_t groupRegisters[GROUP_REGISTER_COUNT];
+    uint8_t discreteInputs[BENCHMARK_DISCRETE_INPUTS];
+
+    FlatShed() : inputRegisters(), holdingRegisters(), groupRegisters(), discreteInputs()
+    {
+        slave.addInputRegisters(0, inputRegisters, BENCHMARK_INPUT_REGISTERS);
+        slave.addHoldingRegisters(0, holdingRegisters, BENCHMARK_HOLDING_REGISTERS);
+        slave.addHoldingRegisters(GROUP_REGISTERS_ADDRESS, groupRegisters, GROUP_REGISTER_COUNT);
+        slave.addDiscreteInputs(0, discreteInputs, BENCHMARK_DISCRETE_INPUTS);
+    }
+};
+
+static inline uint64_t cycles()
+{
+#ifdef BENCHMARK_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Reports the time stamp counter cycles an iteration took, on hosts that have one
+ * 
+ */
+static void countCycles(benchmark::State& state, uint64_t start)
+{
+#ifdef BENCHMARK_CYCLES
+    state.counters["cycles"] = benchmark::Counter(cycles() - start, benchmark::Counter::kAvgIterations);
+#endif
+}
+
+template <class Shed> static void BM_VictronBlock(benchmark::State& state)
+{
+    Shed shed;
+    uint16_t value = 0;
+    uint64_t start = cycles();
+
+    // The first registers are the Victron readings, set a block at a time
+    for (auto _ : state)
+    {
+        for (uint16_t i = 0; i < BENCHMARK_BLOCK_WRITES; i++)
+        {
+            shed.slave.Ireg(i, value++);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    countCycles(state, start);
+    state.SetItemsProcessed(state.iterations() * BENCHMARK_BLOCK_WRITES);
+}
+BENCHMARK_TEMPLATE(BM_VictronBlock, ListShed);
+BENCHMARK_TEMPLATE(BM_VictronBlock, FlatShed);
+
+template <class Shed> static void BM_GroupHandler(benchmark::State& state)
+{
+    Shed shed;
+    uint16_t sequence = 0;
+    uint64_t start = cycles();
+
+    // A new command every time, so the whole handler runs
+    for (auto _ : state)
+    {
+        shed.slave.Hreg(GROUP_REGISTER(GROUP_SEQUENCE), ++sequence);
+        shed.slave.Hreg(GROUP_REGISTER(GROUP_MEMBERSHIP), GROUP_ALL);
+        shed.slave.Hreg(GROUP_REGISTER(GROUP_MASK), 1);
+
+        if (inGroups(shed.slave.Hreg(GROUP_REGISTER(GROUP_MEMBERSHIP)), shed.slave.Hreg(GROUP_REGISTER(GROUP_MASK))))
+        {
+            shed.slave.Hreg(1, shed.slave.Hreg(GROUP_REGISTER(GROUP_RAMP_TIME)));
+            shed.slave.Hreg(2, shed.slave.Hreg(GROUP_REGISTER(GROUP_RAMP_CURVE)));
+            shed.slave.Hreg(0, shed.slave.Hreg(GROUP_REGISTER(GROUP_LEVEL)));
+            shed.slave.Hreg(GROUP_REGISTER(GROUP_APPLIED), shed.slave.Hreg(GROUP_REGISTER(GROUP_SEQUENCE)));
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    countCycles(state, start);
+}
+BENCHMARK_TEMPLATE(BM_GroupHandler, ListShed);
+BENCHMARK_TEMPLATE(BM_GroupHandler, FlatShed);
+
+template <class Shed> static void BM_ReadRequest(benchmark::State& state)
+{
+    Shed shed;
+    uint8_t request[RTU_MAX_LENGTH];
+    uint8_t frame[RTU_MAX_LENGTH];
+    size_t length = rtuFrame(request, 3, pduReadRequest(RTU_PDU(request), PDU_READ_INPUT_REGISTERS, 0, state.range(0)));
+    uint64_t start;
+
+    shed.slave.setSlaveId(3);
+    start = cycles();
+
+    // The response is built over the request, so it is copied in fresh each time as if received
+    for (auto _ : state)
+    {
+        memcpy(frame, request, length);
+        benchmark::DoNotOptimize(shed.slave.process(frame, length));
+        benchmark::ClobberMemory();
+    }
+
+    countCycles(state, start);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// A single register, and every input register as the hub reads them
+BENCHMARK_TEMPLATE(BM_ReadRequest, ListShed)->Arg(1)->Arg(BENCHMARK_INPUT_REGISTERS);
+BENCHMARK_TEMPLATE(BM_ReadRequest, FlatShed)->Arg(1)->Arg(BENCHMARK_INPUT_REGISTERS);
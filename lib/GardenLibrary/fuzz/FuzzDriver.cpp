@@ -0,0 +1,188 @@
+/*
+ * File: FuzzDriver.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+/**
+ * Standalone driver for fuzz targets when libFuzzer isn't available, such as with gcc.
+ * Runs every corpus file, then mutates corpus entries the way a noisy serial line would.
+ * 
+ * Usage: VictronParserFuzzer [-runs=N] [-seed=N] [corpus files or directories]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#define DEFAULT_RUNS 100000
+#define MAX_INPUT_LENGTH 4096
+#define MAX_MUTATIONS 8
+#define MAX_BURST_LENGTH 64
+
+using namespace std;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void loadInput(const string& path, vector<string>& corpus)
+{
+    ifstream file(path.c_str(), ios::binary);
+
+    if (file)
+    {
+        corpus.push_back(string(istreambuf_iterator<char>(file), istreambuf_iterator<char>()));
+    }
+}
+
+static void loadCorpus(const string& path, vector<string>& corpus)
+{
+    DIR* directory = opendir(path.c_str());
+
+    if (directory == NULL)
+    {
+        loadInput(path, corpus);
+        return;
+    }
+
+    for (struct dirent* entry = readdir(directory); entry != NULL; entry = readdir(directory))
+    {
+        if (entry->d_name[0] != '.')
+        {
+            loadInput(path + "/" + entry->d_name, corpus);
+        }
+    }
+
+    closedir(directory);
+}
+
+static void mutate(string& input, const vector<string>& corpus, mt19937& random)
+{
+    int mutations = random() % MAX_MUTATIONS + 1;
+
+    for (int i = 0; i < mutations; i++)
+    {
+        size_t position = input.empty() ? 0 : random() % input.size();
+
+        switch (random() % 6)
+        {
+            case 0: // Flipped bit
+                if (!input.empty())
+                {
+                    input[position] ^= 1 << (random() % 8);
+                }
+                break;
+            case 1: // Dropped byte
+                if (!input.empty())
+                {
+                    input.erase(position, 1);
+                }
+                break;
+            case 2: // Inserted byte
+                input.insert(position, 1, (char) random());
+                break;
+            case 3: // Burst of garbage
+            {
+                string burst(random() % MAX_BURST_LENGTH + 1, '\0');
+                for (char& value : burst)
+                {
+                    value = (char) random();
+                }
+                input.insert(position, burst);
+                break;
+            }
+            case 4: // Truncated
+                input.resize(position);
+                break;
+            case 5: // Spliced with another entry, like a dropout mid block
+            {
+                const string& other = corpus[random() % corpus.size()];
+                input = input.substr(0, position) + other.substr(other.empty() ? 0 : random() % other.size());
+                break;
+            }
+        }
+    }
+
+    if (input.size() > MAX_INPUT_LENGTH)
+    {
+        input.resize(MAX_INPUT_LENGTH);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    vector<string> corpus;
+    long runs = DEFAULT_RUNS;
+    unsigned long seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "-runs=", 6) == 0)
+        {
+            runs = atol(argv[i] + 6);
+        }
+        else if (strncmp(argv[i], "-seed=", 6) == 0)
+        {
+            seed = strtoul(argv[i] + 6, NULL, 10);
+        }
+        else if (argv[i][0] != '-')
+        {
+            loadCorpus(argv[i], corpus);
+        }
+    }
+
+    for (const string& input : corpus)
+    {
+        LLVMFuzzerTestOneInput((const uint8_t*) input.data(), input.size());
+    }
+
+    if (corpus.empty())
+    {
+        corpus.push_back(string());
+    }
+
+    mt19937 random(seed);
+
+    for (long run = 0; run < runs; run++)
+    {
+        string input = corpus[random() % corpus.size()];
+        mutate(input, corpus, random);
+        LLVMFuzzerTestOneInput((const uint8_t*) input.data(), input.size());
+    }
+
+    printf("Done %ld runs over %zu corpus entries, seed %lu\n", runs, corpus.size(), seed);
+
+    return 0;
+}
@@ -0,0 +1,357 @@
+/*
+ * File: VictronCorruptionBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+/**
+ * Measures how well VictronParser recovers blocks from a corrupted VE.Direct stream.
+ * 
+ * A capture of MPPT, BMV and Phoenix blocks with interleaved HEX frames is repeated into a
+ * megabyte of input, corrupted at several rates, and parsed in serial sized reads.
+ * Reports the good blocks recovered per megabyte, corrupted blocks wrongly accepted, parse
+ * throughput, how many blocks are lost resynchronizing after a burst of garbage or a truncated
+ * block, and how long the parser takes to deliver its first block when started mid stream.
+ * 
+ * Usage: VictronCorruptionBenchmark [seed]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "VictronParser.h"
+
+#define CAPTURE_BYTES (1 << 20)
+// Bytes handed to the parser per call, like polling a SoftwareSerial buffer
+#define READ_SIZE 16
+#define RESYNC_TRIALS 2000
+#define RESYNC_BLOCKS_AFTER 6
+#define MAX_BURST_LENGTH 64
+#define STARTUP_TRIALS 2000
+// VE.Direct runs at 19200 baud, 10 bits a byte
+#define BYTES_PER_SECOND 1920.0
+
+using namespace std;
+
+typedef vector<pair<uint32_t, string>> Block;
+
+// A capture of each product, checksums included
+static const char MPPT_BLOCK[] = "\r\nPID\t0xA053\r\nFW\t159\r\nSER#\tHQ21094NFGX\r\nV\t22930\r\nI\t-50\r\nVPV\t41200\r\nPPV\t8\r\nCS\t3\r\nMPPT\t2\r\nOR\t0x00000000\r\nERR\t0\r\nLOAD\tON\r\nIL\t400\r\nH19\t2679\r\nH20\t1\r\nH21\t14\r\nH22\t18\r\nH23\t79\r\nHSDS\t297\r\nChecksum\t";
+static const char BMV_BLOCK[] = "\r\nPID\t0x203\r\nV\t26201\r\nVS\t13104\r\nI\t-3480\r\nP\t-91\r\nCE\t-7200\r\nSOC\t876\r\nTTG\t1230\r\nAlarm\tOFF\r\nRelay\tON\r\nAR\t0\r\nBMV\t700\r\nFW\t0308\r\nH1\t-102345\r\nH9\t86400\r\nH17\t4567\r\nChecksum\t";
+static const char PHOENIX_BLOCK[] = "\r\nPID\t0xA231\r\nFW\t0114\r\nMODE\t2\r\nCS\t9\r\nAC_OUT_V\t23002\r\nAC_OUT_I\t14\r\nAC_OUT_S\t322\r\nV\t12840\r\nAR\t0\r\nWARN\t0\r\nOR\t0x00000004\r\nChecksum\t";
+static const char ASYNC_FRAME[] = ":A010200040044\n";
+
+/**
+ * @brief Collects delivered fields into blocks. Every product starts its blocks with PID.
+ * 
+ */
+class BlockCollector : public VictronFieldHandler
+{
+public:
+    vector<Block> blocks;
+
+    void fieldUpdate(uint32_t id, void* data, size_t size)
+    {
+        if (id == PRODUCT_ID || blocks.empty())
+        {
+            blocks.push_back(Block());
+        }
+
+        blocks.back().push_back(make_pair(id, string((const char*) data, size)));
+    }
+};
+
+static string withChecksum(const char* block)
+{
+    string result(block);
+    char checksum = 0;
+
+    for (char input : result)
+    {
+        checksum -= input;
+    }
+
+    return result + checksum;
+}
+
+typedef struct {
+    const char* name;
+    double flipRate;        // Chance of each byte having a bit flipped
+    double dropRate;        // Chance of each byte being dropped
+    double insertRate;      // Chance of a random byte being inserted before each byte
+    int burstInterval;      // Blocks between bursts of garbage, 0 for none
+    int truncateInterval;   // Blocks between blocks cut short, like a dropout, 0 for none
+} Scenario_t;
+
+static const Scenario_t SCENARIOS[] = {
+    { "clean",              0,      0,      0,      0,      0 },
+    { "flips 1e-4",         1e-4,   0,      0,      0,      0 },
+    { "flips 1e-3",         1e-3,   0,      0,      0,      0 },
+    { "drops 1e-3",         0,      1e-3,   0,      0,      0 },
+    { "inserts 1e-3",       0,      0,      1e-3,   0,      0 },
+    { "mixed 1e-3",         1e-3,   1e-3,   1e-3,   0,      0 },
+    { "bursts every 10",    0,      0,      0,      10,     0 },
+    { "bursts every 2",     0,      0,      0,      2,      0 },
+    { "truncated every 10", 0,      0,      0,      0,      10 },
+    { "truncated every 2",  0,      0,      0,      0,      2 }
+};
+
+static void parseAll(VictronParser& parser, const string& stream)
+{
+    for (size_t index = 0; index < stream.size(); index += READ_SIZE)
+    {
+        size_t length = stream.size() - index < READ_SIZE ? stream.size() - index : READ_SIZE;
+        parser.parse(&stream[index], (int) length);
+    }
+}
+
+static string garbage(mt19937& random)
+{
+    string burst(random() % MAX_BURST_LENGTH + 1, '\0');
+
+    for (char& value : burst)
+    {
+        value = (char) random();
+    }
+
+    return burst;
+}
+
+static void runScenario(const Scenario_t& scenario, const vector<string>& capture, const map<string, Block>& expected, mt19937& random)
+{
+    uniform_real_distribution<double> chance(0.0, 1.0);
+    string stream;
+    int sent = 0;
+    int damaged = 0;
+
+    stream.reserve(CAPTURE_BYTES + CAPTURE_BYTES / 8);
+
+    while (stream.size() < CAPTURE_BYTES)
+    {
+        string block = capture[sent % capture.size()];
+
+        if (scenario.burstInterval && sent % scenario.burstInterval == scenario.burstInterval - 1)
+        {
+            stream += garbage(random);
+        }
+
+        if (scenario.truncateInterval && sent % scenario.truncateInterval == scenario.truncateInterval - 1)
+        {
+            block.resize(random() % block.size());
+            damaged++;
+        }
+
+        for (char input : block)
+        {
+            if (scenario.insertRate && chance(random) < scenario.insertRate)
+            {
+                stream += (char) random();
+            }
+
+            if (scenario.dropRate && chance(random) < scenario.dropRate)
+            {
+                continue;
+            }
+
+            if (scenario.flipRate && chance(random) < scenario.flipRate)
+            {
+                input ^= 1 << (random() % 8);
+            }
+
+            stream += input;
+        }
+
+        sent++;
+    }
+
+    BlockCollector collector;
+    VictronParser parser(&collector);
+
+    auto start = chrono::steady_clock::now();
+    parseAll(parser, stream);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int good = 0;
+    int corrupted = 0;
+
+    for (const Block& block : collector.blocks)
+    {
+        auto match = expected.find(block.front().second);
+
+        if (match != expected.end() && match->second == block)
+        {
+            good++;
+        }
+        else
+        {
+            corrupted++;
+        }
+    }
+
+    double megabytes = (double) stream.size() / (1 << 20);
+    // Truncated blocks can't be recovered, so they aren't counted against the parser
+    int recoverable = sent - damaged;
+
+    printf("%-20s %8d %8d %7.2f%% %10.0f %10d %8u %8.1f\n", scenario.name, recoverable, good, 100.0 * good / recoverable,
+        good / megabytes, corrupted, parser.getStatistics().blocksLost, megabytes / seconds);
+}
+
+/**
+ * @brief Inserts a burst of garbage into a random block of a clean stream, and counts the
+ * clean blocks after it that are lost before the parser recovers.
+ */
+static void runResync(const vector<string>& capture, mt19937& random, bool truncate)
+{
+    long lostBlocks = 0;
+    long resyncBytes = 0;
+    int recovered = 0;
+
+    for (int trial = 0; trial < RESYNC_TRIALS; trial++)
+    {
+        BlockCollector collector;
+        VictronParser parser(&collector);
+        const string& damaged = capture[random() % capture.size()];
+        size_t position = random() % damaged.size();
+        string burst = truncate ? string() : garbage(random);
+
+        // Start in sync with a clean block
+        parseAll(parser, capture[0]);
+        size_t before = collector.blocks.size();
+
+        parser.parse(damaged.data(), (int) position);
+        parser.parse(burst.data(), (int) burst.size());
+
+        long bytes = 0;
+
+        if (!truncate)
+        {
+            parser.parse(&damaged[position], (int) (damaged.size() - position));
+            bytes = damaged.size() - position;
+        }
+
+        for (int i = 0; i < RESYNC_BLOCKS_AFTER; i++)
+        {
+            const string& block = capture[i % capture.size()];
+            size_t delivered = collector.blocks.size();
+
+            for (size_t index = 0; index < block.size() && collector.blocks.size() == delivered; index++)
+            {
+                parser.parse(&block[index], 1);
+                bytes++;
+            }
+
+            if (collector.blocks.size() > delivered)
+            {
+                lostBlocks += i;
+                resyncBytes += bytes;
+                recovered++;
+                break;
+            }
+        }
+
+        // Blocks before the damage must not be affected
+        if (before != 1)
+        {
+            printf("Clean block was lost before the burst\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("Resync after a %s: %d of %d recovered within %d blocks, %.3f clean blocks lost, %.0f bytes to the first good block\n",
+        truncate ? "truncated block" : "burst", recovered, RESYNC_TRIALS, RESYNC_BLOCKS_AFTER,
+        (double) lostBlocks / recovered, (double) resyncBytes / recovered);
+}
+
+/**
+ * @brief Starts parsers at random points of a clean stream, and measures how long they take to deliver a block
+ */
+static void runStartup(const vector<string>& capture, mt19937& random)
+{
+    string stream;
+    double firstBlockBytes = 0;
+
+    for (int i = 0; i < RESYNC_BLOCKS_AFTER; i++)
+    {
+        stream += capture[i % capture.size()];
+    }
+
+    for (int trial = 0; trial < STARTUP_TRIALS; trial++)
+    {
+        BlockCollector collector;
+        VictronParser parser(&collector);
+        size_t start = random() % capture[0].size();
+
+        parseAll(parser, stream.substr(start));
+        firstBlockBytes += parser.getStatistics().firstBlockBytes;
+    }
+
+    firstBlockBytes /= STARTUP_TRIALS;
+
+    printf("Startup mid stream: %.0f bytes, %.2f s at 19200 baud, to the first valid block\n",
+        firstBlockBytes, firstBlockBytes / BYTES_PER_SECOND);
+}
+
+int main(int argc, char *argv[])
+{
+    mt19937 random(argc > 1 ? strtoul(argv[1], NULL, 10) : 1);
+    vector<string> capture;
+    map<string, Block> expected;
+
+    capture.push_back(withChecksum(MPPT_BLOCK));
+    capture.push_back(string(ASYNC_FRAME) + withChecksum(BMV_BLOCK));
+    capture.push_back(withChecksum(PHOENIX_BLOCK));
+
+    // The fields of every clean block, keyed by product id
+    for (const string& block : capture)
+    {
+        BlockCollector collector;
+        VictronParser parser(&collector);
+
+        parser.parse(block.data(), (int) block.size());
+        expected[collector.blocks.front().front().second] = collector.blocks.front();
+    }
+
+    printf("%-20s %8s %8s %8s %10s %10s %8s %8s\n", "scenario", "sent", "good", "ratio", "good/MB", "corrupted", "lost", "MB/s");
+
+    for (const Scenario_t& scenario : SCENARIOS)
+    {
+        runScenario(scenario, capture, expected, random);
+    }
+
+    runResync(capture, random, false);
+    runResync(capture, random, true);
+    runStartup(capture, random);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * File: VictronParserFuzzer.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+/**
+ * libFuzzer entry point for VictronParser. Build with clang and -fsanitize=fuzzer,address,undefined,
+ * or with gcc and FuzzDriver.cpp, which provides a standalone mutation loop.
+ * 
+ * Every input is parsed twice, once split into small chunks like serial reads and once whole.
+ * Both parsers must emit the same fields, and every field must be well formed.
+ */
+
+#include "VictronParser.h"
+#include <cstdlib>
+#include <cstring>
+
+// Aborts, so both libFuzzer and the standalone driver report the input
+#define FUZZ_CHECK(condition) if (!(condition)) { abort(); }
+
+static uint32_t functionFields;
+static uint32_t functionFrames;
+static uint32_t functionChecksum;
+
+/**
+ * @brief Validates a field and reads every byte of it, so ASan catches reads outside the block
+ * 
+ * @return uint32_t A sum of the field, to compare parsers with
+ */
+static uint32_t checkField(uint32_t id, void* data, size_t size)
+{
+    VictronLabel_t label;
+    uint32_t sum = id;
+
+    FUZZ_CHECK(victronGetLabel(id, &label) >= 0);
+    FUZZ_CHECK(((uintptr_t) data % VICTRON_RECORD_ALIGNMENT) == 0);
+
+    switch (label.type)
+    {
+        case VICTRON_INT8:
+        case VICTRON_UINT8:
+            FUZZ_CHECK(size == sizeof(int8_t));
+            break;
+        case VICTRON_INT16:
+            FUZZ_CHECK(size == sizeof(int16_t));
+            break;
+        case VICTRON_INT32:
+        case VICTRON_HEX:
+            FUZZ_CHECK(size == sizeof(int32_t));
+            break;
+        case VICTRON_ON_OFF:
+            FUZZ_CHECK(size == sizeof(bool));
+            break;
+        case VICTRON_STRING:
+            FUZZ_CHECK(size >= 1 && size <= MAX_FIELD_LENGTH + 1);
+            FUZZ_CHECK(((const char*) data)[size - 1] == '\0');
+            break;
+        default:
+            // Checksums are never passed on
+            FUZZ_CHECK(false);
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        sum = sum * 31 + ((const uint8_t*) data)[i];
+    }
+
+    return sum;
+}
+
+static uint32_t checkFrame(VictronHexFrame_t* frame)
+{
+    uint32_t sum = frame->command;
+
+    FUZZ_CHECK(frame->size <= VICTRON_BLOCK_SIZE);
+
+    for (size_t i = 0; i < frame->size; i++)
+    {
+        sum = sum * 31 + frame->data[i];
+    }
+
+    return sum;
+}
+
+class CheckingHandler : public VictronFieldHandler
+{
+public:
+    uint32_t fields;
+    uint32_t frames;
+    uint32_t checksum;
+
+    CheckingHandler() : fields(0), frames(0), checksum(0) {}
+
+    void fieldUpdate(uint32_t id, void* data, size_t size)
+    {
+        checksum += checkField(id, data, size);
+        fields++;
+    }
+
+    void hexUpdate(VictronHexFrame_t* frame)
+    {
+        checksum += checkFrame(frame);
+        frames++;
+    }
+};
+
+static void functionFieldHandler(uint32_t id, void* data, size_t size)
+{
+    functionChecksum += checkField(id, data, size);
+    functionFields++;
+}
+
+static void functionHexHandler(VictronHexFrame_t* frame)
+{
+    functionChecksum += checkFrame(frame);
+    functionFrames++;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    CheckingHandler handler;
+    VictronParser chunked(&handler);
+    VictronParser whole(functionFieldHandler);
+
+    functionFields = 0;
+    functionFrames = 0;
+    functionChecksum = 0;
+    whole.setHexHandler(functionHexHandler);
+
+    // The first byte picks the read size, from single bytes up to a full SoftwareSerial buffer
+    size_t chunkSize = size > 0 ? (data[0] & 0x3F) + 1 : 1;
+
+    for (size_t index = 0; index < size; index += chunkSize)
+    {
+        size_t length = size - index < chunkSize ? size - index : chunkSize;
+        chunked.parse((const char*) &data[index], (int) length);
+    }
+
+    whole.parse((const char*) data, (int) size);
+
+    FUZZ_CHECK(handler.fields == functionFields);
+    FUZZ_CHECK(handler.frames == functionFrames);
+    FUZZ_CHECK(handler.checksum == functionChecksum);
+    FUZZ_CHECK(chunked.getFootprint().blockPeak <= VICTRON_BLOCK_SIZE);
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * File: LightRamp.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef LIGHTRAMP
+#define LIGHTRAMP
+
+#ifndef __AVR__
+#include <cstdint>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// Milliseconds per step of a ramp time register, so a single register covers up to 109 minutes
+#define LIGHT_RAMP_TIME_UNIT 100
+// Highest light level, as a percentage
+#define LIGHT_MAX_LEVEL 100
+// Highest PWM duty cycle
+#define LIGHT_MAX_DUTY 255
+// Ramp progress is fixed point with this many fractional bits, there are no floats on the field devices
+#define LIGHT_RAMP_FRACTION_BITS 12
+#define LIGHT_RAMP_FRACTION_ONE (1UL << LIGHT_RAMP_FRACTION_BITS)
+
+// Shape of a ramp over its duration
+enum LightRampCurve {
+    RAMP_LINEAR,        // Duty changes at a constant rate
+    RAMP_SMOOTH,        // Eases in and out of the ramp
+    RAMP_PERCEPTUAL,    // Duty changes slowly when dim, so the brightness appears to change at a constant rate
+    RAMP_CURVE_COUNT
+};
+
+/**
+ * @brief Converts a light level to a PWM duty cycle
+ * 
+ * @param level Percentage, clamped to LIGHT_MAX_LEVEL
+ * @return uint8_t 
+ */
+inline uint8_t lightDuty(uint16_t level)
+{
+    return level >= LIGHT_MAX_LEVEL ? LIGHT_MAX_DUTY : (uint8_t) ((uint16_t) level * LIGHT_MAX_DUTY / LIGHT_MAX_LEVEL);
+}
+
+/**
+ * @brief Converts a PWM duty cycle back to the nearest light level
+ * 
+ * @param duty 
+ * @return uint8_t Percentage
+ */
+inline uint8_t lightLevel(uint8_t duty)
+{
+    return (uint8_t) (((uint16_t) duty * LIGHT_MAX_LEVEL + LIGHT_MAX_DUTY / 2) / LIGHT_MAX_DUTY);
+}
+
+/**
+ * @brief Fades a PWM duty cycle to a target over a duration. Driven by a millisecond clock,
+ * so the field device keeps fading on its own after a single command.
+ * 
+ */
+class LightRamp
+{
+private:
+    uint8_t from;
+    uint8_t to;
+    uint8_t duty;
+    uint8_t curve;
+    // Square roots of the duties scaled by 16, for perceptual ramps
+    uint8_t rootFrom;
+    uint8_t rootTo;
+    uint32_t start;
+    uint32_t duration;
+    bool active;
+public:
+    LightRamp();
+
+    /**
+     * @brief Starts a ramp from the current duty. A duration of 0 steps straight to the target
+     * 
+     * @param target Duty cycle at the end of the ramp
+     * @param duration Milliseconds
+     * @param curve A LightRampCurve, unknown curves are linear
+     * @param now The current millisecond clock
+     */
+    void begin(uint8_t target, uint32_t duration, uint8_t curve, uint32_t now);
+
+    /**
+     * @brief Advances the ramp. The clock may wrap around during a ramp
+     * 
+     * @param now The current millisecond clock
+     * @return uint8_t The duty cycle at now
+     */
+    uint8_t update(uint32_t now);
+
+    /**
+     * @brief Get the duty cycle from the last update
+     * 
+     * @return uint8_t 
+     */
+    inline uint8_t getDuty() const { return duty; }
+
+    /**
+     * @brief Get the duty cycle the ramp ends at
+     * 
+     * @return uint8_t 
+     */
+    inline uint8_t getTarget() const { return to; }
+
+    /**
+     * @brief Check if the duty is still changing
+     * 
+     * @return true until the ramp has reached its target
+     */
+    inline bool isActive() const { return active; }
+};
+
+#endif /* LIGHTRAMP */
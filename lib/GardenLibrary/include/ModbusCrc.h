@@ -0,0 +1,147 @@
+/*
+ * File: ModbusCrc.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef MODBUSCRC
+#define MODBUSCRC
+
+#ifndef __AVR__
+#include <cstdint>
+#include <cstddef>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// CRC-16/MODBUS: reflected polynomial 0x8005, starting from 0xFFFF, sent low byte first
+#define MODBUS_CRC_INITIAL 0xFFFF
+#define MODBUS_CRC_POLYNOMIAL 0xA001
+#define MODBUS_CRC_LENGTH 2
+
+/**
+ * @brief Continues a CRC a bit at a time. The reference the table variants are checked against
+ * 
+ * @param crc MODBUS_CRC_INITIAL, or the CRC of the bytes before
+ * @param data 
+ * @param length 
+ * @return uint16_t The CRC including the data
+ */
+uint16_t modbusCrcBitwise(uint16_t crc, const uint8_t* data, size_t length);
+
+/**
+ * @brief Continues a CRC a byte at a time from a 512 byte table, kept in flash on AVR
+ * 
+ * @param crc MODBUS_CRC_INITIAL, or the CRC of the bytes before
+ * @param data 
+ * @param length 
+ * @return uint16_t The CRC including the data
+ */
+uint16_t modbusCrcTable(uint16_t crc, const uint8_t* data, size_t length);
+
+#ifndef __AVR__
+/**
+ * @brief Continues a CRC eight bytes at a time from eight tables, 4 KB in all, so each step
+ * only depends on the one before through the CRC itself
+ * 
+ * @param crc MODBUS_CRC_INITIAL, or the CRC of the bytes before
+ * @param data Any alignment
+ * @param length 
+ * @return uint16_t The CRC including the data
+ */
+uint16_t modbusCrcSlicing(uint16_t crc, const uint8_t* data, size_t length);
+#endif // __AVR__
+
+/**
+ * @brief Continues a CRC with the fastest variant for the platform, so a frame can be checked as its bytes arrive
+ * 
+ * @param crc MODBUS_CRC_INITIAL, or the CRC of the bytes before
+ * @param data 
+ * @param length 
+ * @return uint16_t The CRC including the data
+ */
+inline uint16_t modbusCrcUpdate(uint16_t crc, const uint8_t* data, size_t length)
+{
+#ifdef __AVR__
+    return modbusCrcTable(crc, data, length);
+#else
+    return modbusCrcSlicing(crc, data, length);
+#endif // __AVR__
+}
+
+/**
+ * @brief The CRC of a whole frame
+ * 
+ * @param data 
+ * @param length 
+ * @return uint16_t 
+ */
+inline uint16_t modbusCrc(const uint8_t* data, size_t length)
+{
+    return modbusCrcUpdate(MODBUS_CRC_INITIAL, data, length);
+}
+
+/**
+ * @brief Appends the CRC of a frame to it, low byte first
+ * 
+ * @param frame At least length + MODBUS_CRC_LENGTH long
+ * @param length The length of the frame without the CRC
+ * @return size_t The length of the frame with the CRC
+ */
+inline size_t modbusCrcAppend(uint8_t* frame, size_t length)
+{
+    uint16_t crc = modbusCrc(frame, length);
+
+    frame[length] = crc & 0xFF;
+    frame[length + 1] = crc >> 8;
+
+    return length + MODBUS_CRC_LENGTH;
+}
+
+/**
+ * @brief Whether a frame ends with its own CRC
+ * 
+ * @param frame 
+ * @param length The length of the frame with the CRC
+ * @return true 
+ * @return false 
+ */
+inline bool modbusCrcCheck(const uint8_t* frame, size_t length)
+{
+    if (length < MODBUS_CRC_LENGTH)
+    {
+        return false;
+    }
+
+    uint16_t crc = modbusCrc(frame, length - MODBUS_CRC_LENGTH);
+
+    return frame[length - 2] == (crc & 0xFF) && frame[length - 1] == (crc >> 8);
+}
+
+#endif /* MODBUSCRC */
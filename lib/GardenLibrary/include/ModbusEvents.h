@@ -0,0 +1,185 @@
+/*
+ * File: ModbusEvents.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef MODBUSEVENTS
+#define MODBUSEVENTS
+
+#include "ModbusUtils.h"
+
+// An event log is a block of registers a master reads in one request to find every change
+// since the last sequence it saw, instead of reading all of a device's registers each poll.
+// The block starts with the latest sequence and the device uptime, followed by a ring of events.
+// The sequence is 0 until the first event after the device starts, and the uptime never goes backwards
+// until the device restarts, so a master can tell a restart apart from a quiet device.
+
+// Registers at the start of an event log
+enum EVENT_LOG_HEADER {
+    EVENT_LOG_SEQUENCE,
+    DOUBLE_REGISTER(EVENT_LOG_UPTIME),
+    EVENT_LOG_HEADER_REGISTERS
+};
+
+// Registers of each event in the ring
+enum EVENT_LOG_FIELDS {
+    EVENT_SEQUENCE,
+    EVENT_TYPE,
+    EVENT_VALUE,
+    DOUBLE_REGISTER(EVENT_TIME),
+    EVENT_REGISTERS
+};
+
+// Registers needed for a log of up to length events
+#define EVENT_LOG_REGISTERS(length) (EVENT_LOG_HEADER_REGISTERS + (length) * EVENT_REGISTERS)
+// Reserves a span of registers from register to register##_END for a log of length events
+#define EVENT_LOG(register, length) register, register##_END = register + EVENT_LOG_REGISTERS(length) - 1
+#define EVENT_LOG_LENGTH(register) ((register##_END - register + 1 - EVENT_LOG_HEADER_REGISTERS) / EVENT_REGISTERS)
+// Writes an event into its slot of the ring, then publishes its sequence.
+// The slot is written first so a master never sees a sequence before its event
+#define WRITE_EVENT(func, register, sequence, type, value, time) \
+    for (uint8_t _index = 0; _index < EVENT_REGISTERS; _index++) \
+    { \
+        func(register + eventLogSlot(sequence, EVENT_LOG_LENGTH(register)) + _index, packEventRegister(sequence, type, value, time, _index)); \
+    } \
+    func(register + EVENT_LOG_SEQUENCE, sequence);
+// Writes the uptime of the device, which event times are relative to
+#define WRITE_EVENT_LOG_UPTIME(func, register, uptime) \
+    func(register + EVENT_LOG_UPTIME_UPPER, ((uptime) >> 16) & 0xFFFF); func(register + EVENT_LOG_UPTIME_LOWER, (uptime) & 0xFFFF);
+
+/**
+ * @brief A single event read back from a log
+ * 
+ */
+typedef struct {
+    uint16_t sequence;
+    uint16_t type;
+    uint16_t value;
+    uint32_t time;          // Device uptime in seconds when the event happened
+} ModbusEvent_t;
+
+/**
+ * @brief Offset of the slot of an event from the start of its log
+ * 
+ * @param sequence 
+ * @param length Events the log holds
+ * @return uint16_t 
+ */
+inline uint16_t eventLogSlot(uint16_t sequence, uint8_t length)
+{
+    return EVENT_LOG_HEADER_REGISTERS + (sequence % length) * EVENT_REGISTERS;
+}
+
+/**
+ * @brief Packs a register of an event
+ * 
+ * @param sequence 
+ * @param type 
+ * @param value 
+ * @param time Device uptime in seconds
+ * @param index An EVENT_LOG_FIELDS
+ * @return uint16_t 
+ */
+inline uint16_t packEventRegister(uint16_t sequence, uint16_t type, uint16_t value, uint32_t time, uint8_t index)
+{
+    switch (index)
+    {
+        case EVENT_SEQUENCE:
+            return sequence;
+        case EVENT_TYPE:
+            return type;
+        case EVENT_VALUE:
+            return value;
+        case EVENT_TIME_UPPER:
+            return (time >> 16) & 0xFFFF;
+        case EVENT_TIME_LOWER:
+            return time & 0xFFFF;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Get the device uptime from a snapshot of an event log
+ * 
+ * @param registers The first register of the log
+ * @return uint32_t Seconds
+ */
+inline uint32_t eventLogUptime(const uint16_t* registers)
+{
+    return ((uint32_t) registers[EVENT_LOG_UPTIME_UPPER] << 16) | registers[EVENT_LOG_UPTIME_LOWER];
+}
+
+/**
+ * @brief Reads the events newer than a sequence from a snapshot of an event log, oldest first
+ * 
+ * @param registers The first register of the log
+ * @param length Events the log holds
+ * @param sequence The last sequence already seen, updated to the latest sequence of the log
+ * @param uptime The uptime of the last snapshot, updated to the uptime of this one
+ * @param events Populated with the new events, room for length events
+ * @return int The number of new events, or -1 if events were overwritten before they were read
+ * or the device restarted, in which case the device state needs to be read in full
+ */
+inline int readEventLog(const uint16_t* registers, uint8_t length, uint16_t* sequence, uint32_t* uptime, ModbusEvent_t* events)
+{
+    uint16_t latest = registers[EVENT_LOG_SEQUENCE];
+    uint16_t count = latest - *sequence;
+    bool restarted = eventLogUptime(registers) < *uptime;
+
+    *sequence = latest;
+    *uptime = eventLogUptime(registers);
+
+    if (restarted || count > length)
+    {
+        return -1;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint16_t eventSequence = latest - count + 1 + i;
+        const uint16_t* slot = &registers[eventLogSlot(eventSequence, length)];
+
+        // A slot that does not hold the sequence was torn or overwritten
+        if (slot[EVENT_SEQUENCE] != eventSequence)
+        {
+            return -1;
+        }
+
+        events[i].sequence = eventSequence;
+        events[i].type = slot[EVENT_TYPE];
+        events[i].value = slot[EVENT_VALUE];
+        events[i].time = ((uint32_t) slot[EVENT_TIME_UPPER] << 16) | slot[EVENT_TIME_LOWER];
+    }
+
+    return count;
+}
+
+#endif /* MODBUSEVENTS */
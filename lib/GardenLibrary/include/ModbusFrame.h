@@ -0,0 +1,666 @@
+/*
+ * File: ModbusFrame.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef MODBUSFRAME
+#define MODBUSFRAME
+
+#ifndef __AVR__
+#include <cstdint>
+#include <cstddef>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+#include "ModbusCrc.h"
+
+// Builds and parses Modbus PDUs and RTU ADUs in place, in buffers owned by the caller. Nothing is
+// allocated or copied: a PDU is built straight into the ADU that carries it, and a parsed frame
+// points back into the buffer it was received into, so it is only valid while that buffer is.
+// Function codes the codec does not know are passed through as raw data, for custom payloads.
+
+// Longest PDU, and the RTU ADU carrying it with the slave id and CRC
+#define PDU_MAX_LENGTH 253
+#define RTU_MAX_LENGTH (PDU_MAX_LENGTH + 1 + MODBUS_CRC_LENGTH)
+// The slave id in front of the PDU, and the smallest frame: slave id, function code and CRC
+#define RTU_PDU_OFFSET 1
+#define RTU_MIN_LENGTH (RTU_PDU_OFFSET + 1 + MODBUS_CRC_LENGTH)
+// The PDU of an ADU, so it can be built in place before rtuFrame
+#define RTU_PDU(adu) ((adu) + RTU_PDU_OFFSET)
+
+// Largest counts a single request may carry
+#define PDU_MAX_READ_BITS 2000
+#define PDU_MAX_READ_REGISTERS 125
+#define PDU_MAX_WRITE_BITS 1968
+#define PDU_MAX_WRITE_REGISTERS 123
+
+// Set in the function code of an exception response
+#define PDU_EXCEPTION_FLAG 0x80
+// The value of a single coil write that turns it on, any other than 0 is invalid
+#define PDU_COIL_ON 0xFF00
+
+// Function codes of the requests ModbusConnection makes
+enum PduFunction {
+    PDU_READ_COILS = 0x01,
+    PDU_READ_DISCRETE_INPUTS = 0x02,
+    PDU_READ_HOLDING_REGISTERS = 0x03,
+    PDU_READ_INPUT_REGISTERS = 0x04,
+    PDU_WRITE_SINGLE_COIL = 0x05,
+    PDU_WRITE_SINGLE_REGISTER = 0x06,
+    PDU_WRITE_MULTIPLE_COILS = 0x0F,
+    PDU_WRITE_MULTIPLE_REGISTERS = 0x10
+};
+
+// Exception codes a slave replies with
+enum PduException {
+    PDU_ILLEGAL_FUNCTION = 0x01,
+    PDU_ILLEGAL_DATA_ADDRESS = 0x02,
+    PDU_ILLEGAL_DATA_VALUE = 0x03,
+    PDU_SERVER_DEVICE_FAILURE = 0x04
+};
+
+/**
+ * @brief A parsed request or response. The data points into the parsed buffer.
+ * 
+ */
+typedef struct {
+    uint8_t function;       // Without PDU_EXCEPTION_FLAG
+    uint8_t exception;      // A PduException, or 0 if the frame is not an exception
+    uint16_t address;       // First bit or register, for requests and write responses
+    uint16_t count;         // Bits or registers read or written, 1 for single writes
+    uint16_t value;         // Written by a single write
+    const uint8_t* data;    // Packed bits or big endian registers of a read response or a multiple write
+    uint8_t size;           // Bytes at data
+} ModbusPdu_t;
+
+/**
+ * @brief Reads a big endian word
+ */
+inline uint16_t pduWord(const uint8_t* data)
+{
+    return ((uint16_t) data[0] << 8) | data[1];
+}
+
+/**
+ * @brief Writes a big endian word
+ */
+inline void pduPutWord(uint8_t* data, uint16_t value)
+{
+    data[0] = value >> 8;
+    data[1] = value & 0xFF;
+}
+
+/**
+ * @brief Bytes taken by a number of packed bits
+ */
+inline uint16_t pduBitBytes(uint16_t count)
+{
+    return (count + 7) / 8;
+}
+
+/**
+ * @brief Whether a function reads or writes bits rather than registers
+ */
+inline bool pduIsBitFunction(uint8_t function)
+{
+    return function == PDU_READ_COILS || function == PDU_READ_DISCRETE_INPUTS ||
+        function == PDU_WRITE_SINGLE_COIL || function == PDU_WRITE_MULTIPLE_COILS;
+}
+
+/**
+ * @brief Whether a function is one of the reads
+ */
+inline bool pduIsRead(uint8_t function)
+{
+    return function >= PDU_READ_COILS && function <= PDU_READ_INPUT_REGISTERS;
+}
+
+/**
+ * @brief A register of a read response or a multiple register write
+ * 
+ * @param frame 
+ * @param index 
+ * @return uint16_t 
+ */
+inline uint16_t pduRegister(const ModbusPdu_t* frame, uint16_t index)
+{
+    return pduWord(&frame->data[index * 2]);
+}
+
+/**
+ * @brief A bit of a read response or a multiple coil write
+ * 
+ * @param frame 
+ * @param index 
+ * @return bool 
+ */
+inline bool pduBit(const ModbusPdu_t* frame, uint16_t index)
+{
+    return (frame->data[index / 8] >> (index % 8)) & 1;
+}
+
+/**
+ * @brief Packs bits, one a byte as libmodbus takes them, eight a byte with the first in the lowest bit
+ * 
+ * @param data Room for pduBitBytes(count)
+ * @param values Non-zero for a set bit
+ * @param count 
+ */
+inline void pduPackBits(uint8_t* data, const uint8_t* values, uint16_t count)
+{
+    for (uint16_t i = 0; i < pduBitBytes(count); i++)
+    {
+        data[i] = 0;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        data[i / 8] |= (values[i] ? 1 : 0) << (i % 8);
+    }
+}
+
+/**
+ * @brief Builds a read of bits or registers
+ * 
+ * @param pdu Room for 5 bytes
+ * @param function One of the reads
+ * @param address 
+ * @param count 
+ * @return int The length of the PDU, or -1 if the count is out of range
+ */
+inline int pduReadRequest(uint8_t* pdu, uint8_t function, uint16_t address, uint16_t count)
+{
+    if (!pduIsRead(function) || count == 0 || count > (pduIsBitFunction(function) ? PDU_MAX_READ_BITS : PDU_MAX_READ_REGISTERS))
+    {
+        return -1;
+    }
+
+    pdu[0] = function;
+    pduPutWord(&pdu[1], address);
+    pduPutWord(&pdu[3], count);
+
+    return 5;
+}
+
+/**
+ * @brief Builds a write of a single coil or register. Also the response to one, which echoes it
+ * 
+ * @param pdu Room for 5 bytes
+ * @param function PDU_WRITE_SINGLE_COIL or PDU_WRITE_SINGLE_REGISTER
+ * @param address 
+ * @param value The register, or non-zero to turn the coil on
+ * @return int The length of the PDU, or -1 if the function is not a single write
+ */
+inline int pduWriteSingle(uint8_t* pdu, uint8_t function, uint16_t address, uint16_t value)
+{
+    if (function != PDU_WRITE_SINGLE_COIL && function != PDU_WRITE_SINGLE_REGISTER)
+    {
+        return -1;
+    }
+
+    pdu[0] = function;
+    pduPutWord(&pdu[1], address);
+    pduPutWord(&pdu[3], function == PDU_WRITE_SINGLE_COIL ? (value ? PDU_COIL_ON : 0) : value);
+
+    return 5;
+}
+
+/**
+ * @brief Builds a write of several registers
+ * 
+ * @param pdu Room for 6 + count * 2 bytes
+ * @param address 
+ * @param count 
+ * @param values 
+ * @return int The length of the PDU, or -1 if the count is out of range
+ */
+inline int pduWriteRegistersRequest(uint8_t* pdu, uint16_t address, uint16_t count, const uint16_t* values)
+{
+    if (count == 0 || count > PDU_MAX_WRITE_REGISTERS)
+    {
+        return -1;
+    }
+
+    pdu[0] = PDU_WRITE_MULTIPLE_REGISTERS;
+    pduPutWord(&pdu[1], address);
+    pduPutWord(&pdu[3], count);
+    pdu[5] = count * 2;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        pduPutWord(&pdu[6 + i * 2], values[i]);
+    }
+
+    return 6 + count * 2;
+}
+
+/**
+ * @brief Builds a write of several coils
+ * 
+ * @param pdu Room for 6 + pduBitBytes(count) bytes
+ * @param address 
+ * @param count 
+ * @param values One a byte, non-zero to turn the coil on
+ * @return int The length of the PDU, or -1 if the count is out of range
+ */
+inline int pduWriteBitsRequest(uint8_t* pdu, uint16_t address, uint16_t count, const uint8_t* values)
+{
+    if (count == 0 || count > PDU_MAX_WRITE_BITS)
+    {
+        return -1;
+    }
+
+    pdu[0] = PDU_WRITE_MULTIPLE_COILS;
+    pduPutWord(&pdu[1], address);
+    pduPutWord(&pdu[3], count);
+    pdu[5] = pduBitBytes(count);
+    pduPackBits(&pdu[6], values, count);
+
+    return 6 + pdu[5];
+}
+
+/**
+ * @brief Builds the response to a read of registers
+ * 
+ * @param pdu Room for 2 + count * 2 bytes
+ * @param function PDU_READ_HOLDING_REGISTERS or PDU_READ_INPUT_REGISTERS
+ * @param count 
+ * @param values 
+ * @return int The length of the PDU, or -1 if the count is out of range
+ */
+inline int pduReadRegistersResponse(uint8_t* pdu, uint8_t function, uint16_t count, const uint16_t* values)
+{
+    if ((function != PDU_READ_HOLDING_REGISTERS && function != PDU_READ_INPUT_REGISTERS) || count == 0 || count > PDU_MAX_READ_REGISTERS)
+    {
+        return -1;
+    }
+
+    pdu[0] = function;
+    pdu[1] = count * 2;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        pduPutWord(&pdu[2 + i * 2], values[i]);
+    }
+
+    return 2 + count * 2;
+}
+
+/**
+ * @brief Builds the response to a read of bits
+ * 
+ * @param pdu Room for 2 + pduBitBytes(count) bytes
+ * @param function PDU_READ_COILS or PDU_READ_DISCRETE_INPUTS
+ * @param count 
+ * @param values One a byte, non-zero for a set bit
+ * @return int The length of the PDU, or -1 if the count is out of range
+ */
+inline int pduReadBitsResponse(uint8_t* pdu, uint8_t function, uint16_t count, const uint8_t* values)
+{
+    if ((function != PDU_READ_COILS && function != PDU_READ_DISCRETE_INPUTS) || count == 0 || count > PDU_MAX_READ_BITS)
+    {
+        return -1;
+    }
+
+    pdu[0] = function;
+    pdu[1] = pduBitBytes(count);
+    pduPackBits(&pdu[2], values, count);
+
+    return 2 + pdu[1];
+}
+
+/**
+ * @brief Builds the response to a write of several coils or registers
+ * 
+ * @param pdu Room for 5 bytes
+ * @param function PDU_WRITE_MULTIPLE_COILS or PDU_WRITE_MULTIPLE_REGISTERS
+ * @param address 
+ * @param count 
+ * @return int The length of the PDU
+ */
+inline int pduWriteMultipleResponse(uint8_t* pdu, uint8_t function, uint16_t address, uint16_t count)
+{
+    pdu[0] = function;
+    pduPutWord(&pdu[1], address);
+    pduPutWord(&pdu[3], count);
+
+    return 5;
+}
+
+/**
+ * @brief Builds an exception response
+ * 
+ * @param pdu Room for 2 bytes
+ * @param function The function of the request
+ * @param exception A PduException
+ * @return int The length of the PDU
+ */
+inline int pduException(uint8_t* pdu, uint8_t function, uint8_t exception)
+{
+    pdu[0] = function | PDU_EXCEPTION_FLAG;
+    pdu[1] = exception;
+
+    return 2;
+}
+
+/**
+ * @brief Parses a request, as a slave receives it
+ * 
+ * @param pdu 
+ * @param length 
+ * @param request Populated with the request. For an unknown function, data holds everything after the function code
+ * @return int 0 if the request is valid, or the PduException to reply with
+ */
+inline int pduParseRequest(const uint8_t* pdu, size_t length, ModbusPdu_t* request)
+{
+    if (length < 1 || length > PDU_MAX_LENGTH)
+    {
+        return PDU_ILLEGAL_DATA_VALUE;
+    }
+
+    request->function = pdu[0];
+    request->exception = 0;
+    request->address = 0;
+    request->count = 0;
+    request->value = 0;
+    request->data = &pdu[1];
+    request->size = length - 1;
+
+    switch (request->function)
+    {
+        case PDU_READ_COILS:
+        case PDU_READ_DISCRETE_INPUTS:
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+            if (length != 5)
+            {
+                return PDU_ILLEGAL_DATA_VALUE;
+            }
+
+            request->address = pduWord(&pdu[1]);
+            request->count = pduWord(&pdu[3]);
+            request->size = 0;
+
+            return request->count == 0 || request->count > (pduIsBitFunction(request->function) ? PDU_MAX_READ_BITS : PDU_MAX_READ_REGISTERS) ?
+                PDU_ILLEGAL_DATA_VALUE : 0;
+        case PDU_WRITE_SINGLE_COIL:
+        case PDU_WRITE_SINGLE_REGISTER:
+            if (length != 5)
+            {
+                return PDU_ILLEGAL_DATA_VALUE;
+            }
+
+            request->address = pduWord(&pdu[1]);
+            request->count = 1;
+            request->value = pduWord(&pdu[3]);
+            request->size = 0;
+
+            return request->function == PDU_WRITE_SINGLE_COIL && request->value != 0 && request->value != PDU_COIL_ON ? PDU_ILLEGAL_DATA_VALUE : 0;
+        case PDU_WRITE_MULTIPLE_COILS:
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+        {
+            if (length < 6)
+            {
+                return PDU_ILLEGAL_DATA_VALUE;
+            }
+
+            bool bits = request->function == PDU_WRITE_MULTIPLE_COILS;
+
+            request->address = pduWord(&pdu[1]);
+            request->count = pduWord(&pdu[3]);
+            request->data = &pdu[6];
+            request->size = pdu[5];
+
+            return request->count == 0 || request->count > (bits ? PDU_MAX_WRITE_BITS : PDU_MAX_WRITE_REGISTERS) ||
+                request->size != (bits ? pduBitBytes(request->count) : request->count * 2) || length != 6u + request->size ? PDU_ILLEGAL_DATA_VALUE : 0;
+        }
+        default:
+            return PDU_ILLEGAL_FUNCTION;
+    }
+}
+
+/**
+ * @brief Parses a response, as a master receives it
+ * 
+ * @param pdu 
+ * @param length 
+ * @param response Populated with the response. For an unknown function, data holds everything after the function code
+ * @return int 0 if the response is well formed, including exceptions, or -1 if it is not
+ */
+inline int pduParseResponse(const uint8_t* pdu, size_t length, ModbusPdu_t* response)
+{
+    if (length < 2 || length > PDU_MAX_LENGTH)
+    {
+        return -1;
+    }
+
+    response->function = pdu[0] & ~PDU_EXCEPTION_FLAG;
+    response->exception = 0;
+    response->address = 0;
+    response->count = 0;
+    response->value = 0;
+    response->data = &pdu[1];
+    response->size = length - 1;
+
+    if (pdu[0] & PDU_EXCEPTION_FLAG)
+    {
+        response->exception = pdu[1];
+        response->size = 0;
+
+        return length == 2 && pdu[1] != 0 ? 0 : -1;
+    }
+
+    switch (response->function)
+    {
+        case PDU_READ_COILS:
+        case PDU_READ_DISCRETE_INPUTS:
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+            response->data = &pdu[2];
+            response->size = pdu[1];
+            // Bit responses are padded to whole bytes, so only registers tell their count
+            response->count = pduIsBitFunction(response->function) ? response->size * 8 : response->size / 2;
+
+            return length == 2u + response->size && response->size > 0 && (pduIsBitFunction(response->function) || response->size % 2 == 0) ? 0 : -1;
+        case PDU_WRITE_SINGLE_COIL:
+        case PDU_WRITE_SINGLE_REGISTER:
+            response->size = 0;
+
+            // Checked before any field is read, so a truncated echo never reads past the frame
+            if (length != 5)
+            {
+                return -1;
+            }
+
+            response->address = pduWord(&pdu[1]);
+            response->count = 1;
+            response->value = pduWord(&pdu[3]);
+
+            return 0;
+        case PDU_WRITE_MULTIPLE_COILS:
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+            response->size = 0;
+
+            if (length != 5)
+            {
+                return -1;
+            }
+
+            response->address = pduWord(&pdu[1]);
+            response->count = pduWord(&pdu[3]);
+
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Whether a response answers a request: the same function, and the same registers read or written.
+ * An exception answers any request with its function
+ * 
+ * @param request 
+ * @param response 
+ * @return true 
+ * @return false 
+ */
+inline bool pduResponseMatches(const ModbusPdu_t* request, const ModbusPdu_t* response)
+{
+    if (request->function != response->function || response->exception != 0)
+    {
+        return request->function == response->function;
+    }
+
+    switch (request->function)
+    {
+        case PDU_READ_COILS:
+        case PDU_READ_DISCRETE_INPUTS:
+            return response->size == pduBitBytes(request->count);
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+            return response->count == request->count;
+        case PDU_WRITE_SINGLE_COIL:
+        case PDU_WRITE_SINGLE_REGISTER:
+            return response->address == request->address && response->value == request->value;
+        case PDU_WRITE_MULTIPLE_COILS:
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+            return response->address == request->address && response->count == request->count;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Frames a PDU built in place at RTU_PDU(adu), adding the slave id in front and the CRC behind
+ * 
+ * @param adu Room for the PDU, the slave id and the CRC
+ * @param slaveId 
+ * @param pduLength 
+ * @return size_t The length of the ADU
+ */
+inline size_t rtuFrame(uint8_t* adu, uint8_t slaveId, size_t pduLength)
+{
+    adu[0] = slaveId;
+
+    return modbusCrcAppend(adu, RTU_PDU_OFFSET + pduLength);
+}
+
+/**
+ * @brief Checks a received ADU and finds the PDU in it
+ * 
+ * @param adu 
+ * @param length 
+ * @param slaveId Populated with the slave id of the frame
+ * @return int The length of the PDU at RTU_PDU(adu), or -1 if the frame is too short, too long or fails its CRC
+ */
+inline int rtuParse(const uint8_t* adu, size_t length, uint8_t* slaveId)
+{
+    if (length < RTU_MIN_LENGTH || length > RTU_MAX_LENGTH || !modbusCrcCheck(adu, length))
+    {
+        return -1;
+    }
+
+    *slaveId = adu[0];
+
+    return length - RTU_PDU_OFFSET - MODBUS_CRC_LENGTH;
+}
+
+/**
+ * @brief The length of a request from its first bytes, so a transport knows a frame is complete as soon
+ * as it has arrived rather than waiting out the silence after it
+ * 
+ * @param adu The bytes received so far
+ * @param received 
+ * @return int The length of the ADU, 0 if more bytes are needed to tell, or -1 for a function the codec does not know
+ */
+inline int rtuRequestLength(const uint8_t* adu, size_t received)
+{
+    if (received < 2)
+    {
+        return 0;
+    }
+
+    switch (adu[1])
+    {
+        case PDU_READ_COILS:
+        case PDU_READ_DISCRETE_INPUTS:
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+        case PDU_WRITE_SINGLE_COIL:
+        case PDU_WRITE_SINGLE_REGISTER:
+            return RTU_PDU_OFFSET + 5 + MODBUS_CRC_LENGTH;
+        case PDU_WRITE_MULTIPLE_COILS:
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+            // The byte count follows the function, address and count
+            return received < RTU_PDU_OFFSET + 6 ? 0 : RTU_PDU_OFFSET + 6 + adu[RTU_PDU_OFFSET + 5] + MODBUS_CRC_LENGTH;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief The length of a response from its first bytes, like rtuRequestLength
+ * 
+ * @param adu The bytes received so far
+ * @param received 
+ * @return int The length of the ADU, 0 if more bytes are needed to tell, or -1 for a function the codec does not know
+ */
+inline int rtuResponseLength(const uint8_t* adu, size_t received)
+{
+    if (received < 2)
+    {
+        return 0;
+    }
+
+    if (adu[1] & PDU_EXCEPTION_FLAG)
+    {
+        return RTU_PDU_OFFSET + 2 + MODBUS_CRC_LENGTH;
+    }
+
+    switch (adu[1])
+    {
+        case PDU_READ_COILS:
+        case PDU_READ_DISCRETE_INPUTS:
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+            return received < RTU_PDU_OFFSET + 2 ? 0 : RTU_PDU_OFFSET + 2 + adu[RTU_PDU_OFFSET + 1] + MODBUS_CRC_LENGTH;
+        case PDU_WRITE_SINGLE_COIL:
+        case PDU_WRITE_SINGLE_REGISTER:
+        case PDU_WRITE_MULTIPLE_COILS:
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+            return RTU_PDU_OFFSET + 5 + MODBUS_CRC_LENGTH;
+        default:
+            return -1;
+    }
+}
+
+#endif /* MODBUSFRAME */
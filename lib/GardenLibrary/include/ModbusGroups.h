@@ -0,0 +1,118 @@
+/*
+ * File: ModbusGroups.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef MODBUSGROUPS
+#define MODBUSGROUPS
+
+#include "ModbusUtils.h"
+
+// A group command is one write of the same block of registers on every device, sent as a broadcast
+// so a scene across many fixtures costs a single frame. Each device holds the groups it is in and only
+// acts on commands for one of them. The sequence changes with every command so a repeat is still seen,
+// and a device copies the sequence of the last command it acted on, so the master can verify it with a read.
+
+// The field devices take 0xFF as a broadcast address as well as the standard 0, as ModbusSerial did, and never reply to it
+#define GROUP_BROADCAST_ID 0xFF
+// The block is at the same address on every device, clear of their own registers
+#define GROUP_REGISTERS_ADDRESS 200
+#define GROUP_REGISTER(field) (GROUP_REGISTERS_ADDRESS + (field))
+#define GROUP_ALL 0xFFFF
+
+enum GROUP_REGISTERS {
+    // Groups the device is in, a bit each. Written to each device on its own, never broadcast
+    GROUP_MEMBERSHIP,
+    // Sequence of the last command the device acted on
+    GROUP_APPLIED,
+    // The broadcast command, starting with the groups it is for
+    GROUP_MASK,
+    GROUP_SEQUENCE,
+    // Light intensity as a percentage, ramp time in LIGHT_RAMP_TIME_UNIT and LightRampCurve
+    GROUP_LEVEL,
+    GROUP_RAMP_TIME,
+    GROUP_RAMP_CURVE,
+    GROUP_REGISTER_COUNT
+};
+
+// Registers written by a broadcast, from GROUP_MASK
+#define GROUP_COMMAND_REGISTERS (GROUP_REGISTER_COUNT - GROUP_MASK)
+
+/**
+ * @brief A light command for every device in any of a set of groups
+ * 
+ */
+typedef struct {
+    uint16_t mask;          // Groups the command is for, a bit each
+    uint16_t sequence;      // Never 0, which devices start with
+    uint16_t level;
+    uint16_t rampTime;
+    uint16_t rampCurve;
+} GroupCommand_t;
+
+/**
+ * @brief Packs a command into the registers of a broadcast
+ * 
+ * @param command 
+ * @param registers Room for GROUP_COMMAND_REGISTERS, written to GROUP_REGISTER(GROUP_MASK)
+ */
+inline void packGroupCommand(const GroupCommand_t* command, uint16_t* registers)
+{
+    registers[GROUP_MASK - GROUP_MASK] = command->mask;
+    registers[GROUP_SEQUENCE - GROUP_MASK] = command->sequence;
+    registers[GROUP_LEVEL - GROUP_MASK] = command->level;
+    registers[GROUP_RAMP_TIME - GROUP_MASK] = command->rampTime;
+    registers[GROUP_RAMP_CURVE - GROUP_MASK] = command->rampCurve;
+}
+
+/**
+ * @brief Whether a device acts on a command
+ * 
+ * @param membership The GROUP_MEMBERSHIP of the device
+ * @param mask The GROUP_MASK of the command
+ */
+inline bool inGroups(uint16_t membership, uint16_t mask)
+{
+    return (membership & mask) != 0;
+}
+
+/**
+ * @brief The sequence of the command after another, skipping 0 so a command is never mistaken for none
+ * 
+ * @param sequence 
+ * @return uint16_t 
+ */
+inline uint16_t nextGroupSequence(uint16_t sequence)
+{
+    return sequence == UINT16_MAX ? 1 : sequence + 1;
+}
+
+#endif /* MODBUSGROUPS */
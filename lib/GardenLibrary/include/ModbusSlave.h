@@ -0,0 +1,227 @@
+/*
+ * File: ModbusSlave.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+#ifndef MODBUSSLAVE
+#define MODBUSSLAVE
+
+#ifndef __AVR__
+#include <cstdint>
+#include <cstddef>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+#include "ModbusFrame.h"
+#include "ModbusGroups.h"
+
+// Blocks of addresses each table may have, such as the registers of the device and the group block
+#define SLAVE_MAX_BLOCKS 2
+// Standard broadcast address. GROUP_BROADCAST_ID is taken as well, which is what ModbusSerial used
+#define SLAVE_BROADCAST_ID 0
+// Silence that ends a frame in microseconds, fixed above 19200 baud by the RTU specification
+#define SLAVE_FAST_FRAME_GAP 1750
+#define SLAVE_FAST_BAUD_RATE 19200
+
+// Tables a slave serves. Coils are not used by any of the field devices
+enum SlaveTable {
+    SLAVE_DISCRETE_INPUTS,
+    SLAVE_INPUT_REGISTERS,
+    SLAVE_HOLDING_REGISTERS,
+    SLAVE_TABLE_COUNT
+};
+
+/**
+ * @brief A run of consecutive addresses in one of the tables, backed by an array of the caller
+ * 
+ */
+typedef struct {
+    uint16_t address;
+    uint16_t count;
+    union {
+        uint16_t* registers;
+        uint8_t* bits;          // Discrete inputs, one a byte
+    };
+} SlaveBlock_t;
+
+/**
+ * @brief A Modbus RTU slave serving registers straight from arrays, sized at compile time from
+ * the register enums of the device. A register is found with at most SLAVE_MAX_BLOCKS compares rather
+ * than walking a list, and a read or write of several registers is served from its block in one go.
+ * Requests are answered in the buffer they were received into, so nothing is allocated.
+ * 
+ */
+class ModbusSlave
+{
+private:
+    uint8_t slaveId;
+    SlaveBlock_t blocks[SLAVE_TABLE_COUNT][SLAVE_MAX_BLOCKS];
+    uint8_t blockCount[SLAVE_TABLE_COUNT];
+#ifdef __AVR__
+    HardwareSerial* port;
+    int txPin;
+    uint16_t frameGap;
+    uint8_t frame[RTU_MAX_LENGTH];
+#endif // __AVR__
+    int addBlock(uint8_t table, uint16_t address, uint16_t count, uint16_t* registers, uint8_t* bits);
+    const SlaveBlock_t* findBlock(uint8_t table, uint16_t address, uint16_t count) const;
+    int respond(const ModbusPdu_t* request, uint8_t* pdu);
+public:
+    ModbusSlave();
+
+    /**
+     * @brief Set the slave id requests are answered for
+     * 
+     * @param slaveId 
+     */
+    void setSlaveId(uint8_t slaveId);
+
+    /**
+     * @brief Get the slave id requests are answered for
+     * 
+     * @return uint8_t 
+     */
+    inline uint8_t getSlaveId() const { return slaveId; }
+
+    /**
+     * @brief Serves input registers from an array. The registers keep the values already in it
+     * 
+     * @param address The address of the first register
+     * @param registers 
+     * @param count 
+     * @return int 0 on success, or -1 if the table has no room for another block or it overlaps one
+     */
+    int addInputRegisters(uint16_t address, uint16_t* registers, uint16_t count);
+
+    /**
+     * @brief Serves holding registers from an array. The registers keep the values already in it
+     * 
+     * @param address The address of the first register
+     * @param registers 
+     * @param count 
+     * @return int 0 on success, or -1 if the table has no room for another block or it overlaps one
+     */
+    int addHoldingRegisters(uint16_t address, uint16_t* registers, uint16_t count);
+
+    /**
+     * @brief Serves discrete inputs from an array, one a byte. The inputs keep the values already in it
+     * 
+     * @param address The address of the first input
+     * @param bits Non-zero for a set input
+     * @param count 
+     * @return int 0 on success, or -1 if the table has no room for another block or it overlaps one
+     */
+    int addDiscreteInputs(uint16_t address, uint8_t* bits, uint16_t count);
+
+    /**
+     * @brief Get an input register
+     * 
+     * @param address 
+     * @return uint16_t The value, or 0 if the register is not served
+     */
+    uint16_t Ireg(uint16_t address) const;
+
+    /**
+     * @brief Set an input register
+     * 
+     * @param address 
+     * @param value 
+     * @return true if the register is served
+     */
+    bool Ireg(uint16_t address, uint16_t value);
+
+    /**
+     * @brief Get a holding register
+     * 
+     * @param address 
+     * @return uint16_t The value, or 0 if the register is not served
+     */
+    uint16_t Hreg(uint16_t address) const;
+
+    /**
+     * @brief Set a holding register
+     * 
+     * @param address 
+     * @param value 
+     * @return true if the register is served
+     */
+    bool Hreg(uint16_t address, uint16_t value);
+
+    /**
+     * @brief Get a discrete input
+     * 
+     * @param address 
+     * @return bool The value, or false if the input is not served
+     */
+    bool Ists(uint16_t address) const;
+
+    /**
+     * @brief Set a discrete input
+     * 
+     * @param address 
+     * @param value 
+     * @return true if the input is served
+     */
+    bool Ists(uint16_t address, bool value);
+
+    /**
+     * @brief Handles a received RTU frame and builds the response in its place
+     * 
+     * @param frame The ADU, with room for RTU_MAX_LENGTH
+     * @param length 
+     * @return size_t The length of the response ADU, or 0 if there is nothing to send: the frame is for
+     * another slave, fails its CRC, or is a broadcast, which is acted on without a reply
+     */
+    size_t process(uint8_t* frame, size_t length);
+
+#ifdef __AVR__
+    /**
+     * @brief Starts the serial port the slave is served on
+     * 
+     * @param port 
+     * @param baud 
+     * @param format Such as SERIAL_8N2
+     * @param txPin Enables the RS485 driver while sending, or -1 if there is none
+     */
+    void config(HardwareSerial* port, uint32_t baud, uint8_t format, int txPin = -1);
+
+    /**
+     * @brief Receives and answers a request if one has started arriving, otherwise returns straight away.
+     * Once a frame starts, it waits for the rest of it, dropping it after a gap of silence
+     * 
+     */
+    void task();
+#endif // __AVR__
+};
+
+#endif /* MODBUSSLAVE */
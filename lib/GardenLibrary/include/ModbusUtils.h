@@ -32,11 +32,83 @@
 #ifndef MODBUSUTILS
 #define MODBUSUTILS
 
+#ifndef __AVR__
+#include <cstdint>
+#include <cstddef>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
 // Utility macros for handling 32 bit values with modbus
 // Splits a single identifier into UPPER and LOWER parts
 #define DOUBLE_REGISTER(register) register##_UPPER, register##_LOWER
 #define DOUBLE_REGISTER_VALUE(register, value) register##_UPPER = value, register##_LOWER
 // Writes a single 32 bit value into two 16 bit modbus registers
-#define WRITE_DOUBLE_REGISTER(func, register, value) func(register##_UPPER, ((value) >> 16) & 0xFFFF); func(register##_UPPER, (value) & 0xFFFF);
+#define WRITE_DOUBLE_REGISTER(func, register, value) func(register##_UPPER, ((value) >> 16) & 0xFFFF); func(register##_LOWER, (value) & 0xFFFF);
+
+// Utility macros for handling strings with modbus, packed two characters a register
+// Registers needed for a string of up to length characters
+#define STRING_REGISTERS(length) (((length) + 1) / 2)
+// Reserves a span of registers from register to register##_END
+#define STRING_REGISTER(register, length) register, register##_END = register + STRING_REGISTERS(length) - 1
+#define STRING_REGISTER_COUNT(register) (register##_END - register + 1)
+// Writes a string across its span of registers, zero padding the rest of the span
+#define WRITE_STRING_REGISTER(func, register, string, length) \
+    for (uint8_t _index = 0; _index < STRING_REGISTER_COUNT(register); _index++) \
+    { \
+        func(register + _index, packStringRegister(string, length, _index)); \
+    }
+
+/**
+ * @brief Packs two characters of a string into a register, the first in the upper byte
+ * 
+ * @param string 
+ * @param length The length of the string
+ * @param index The register of the span to pack
+ * @return uint16_t The packed register, zero past the end of the string
+ */
+inline uint16_t packStringRegister(const char* string, size_t length, uint8_t index)
+{
+    size_t position = (size_t) index * 2;
+    uint8_t upper = position < length ? string[position] : 0;
+    uint8_t lower = position + 1 < length ? string[position + 1] : 0;
+
+    return ((uint16_t) upper << 8) | lower;
+}
+
+/**
+ * @brief Unpacks a span of string registers
+ * 
+ * @param registers The first register of the span
+ * @param count The registers in the span
+ * @param buffer Populated with the null terminated string
+ * @param size The size of the buffer
+ * @return size_t The length of the string, truncated to fit the buffer
+ */
+inline size_t unpackStringRegisters(const uint16_t* registers, uint8_t count, char* buffer, size_t size)
+{
+    size_t length = 0;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    for (size_t position = 0; position < (size_t) count * 2 && length + 1 < size; position++)
+    {
+        char character = (char) (position & 1 ? registers[position / 2] & 0xFF : registers[position / 2] >> 8);
+
+        if (character == '\0')
+        {
+            break;
+        }
+
+        buffer[length++] = character;
+    }
+
+    buffer[length] = '\0';
+
+    return length;
+}
 
 #endif /* MODBUSUTILS */
@@ -1,7 +1,7 @@
 /*
- * File: GardenBedClient.h
+ * File: ProgmemUtils.h
  * Project: gardener
- * Created Date: Thursday October 20th 2022
+ * Created Date: Monday October 19th 2026
  * Author: Kyle Hofer
  * 
  * MIT License
@@ -29,25 +29,26 @@
  * HISTORY:
  */
 
-#ifndef GARDENBED
-#define GARDENBED
 
-#include "ModbusClient.h"
-#include "Executor.h"
+#ifndef PROGMEMUTILS
+#define PROGMEMUTILS
 
-class GardenBedClient : ModbusClient, Executor
-{
-    private:
-    protected:
-        int32_t doExecute();
-    public:
-        GardenBedClient();
-        GardenBedClient(ModbusConnection* connection);
-        using ModbusClient::readRegisters;
-        using ModbusClient::writeRegister;
-        using ModbusClient::writeRegisters;
-        using Executor::execute;
-        using Executor::executeSync;
-};
+// Constant tables shared between the AVR firmware and the hub are placed in flash on AVR.
+// On every other platform the PROGMEM helpers collapse into plain memory accesses.
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <cstdint>
+#include <cstring>
 
-#endif /* GARDENBED */
+#ifndef PROGMEM
+#define PROGMEM
+#endif // PROGMEM
+
+#define pgm_read_byte(address) (*((const uint8_t*) (address)))
+#define pgm_read_word(address) (*((const uint16_t*) (address)))
+#define pgm_read_dword(address) (*((const uint32_t*) (address)))
+#define memcpy_P(destination, source, size) memcpy((destination), (source), (size))
+#endif // __AVR__
+
+#endif /* PROGMEMUTILS */
@@ -0,0 +1,252 @@
+/*
+ * File: Units.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef UNITS
+#define UNITS
+
+#include "ProgmemUtils.h"
+#ifndef __AVR__
+#include <cstdint>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// Engineering units shared by Victron fields and Modbus registers
+enum Unit {
+    UNIT_NONE,
+    UNIT_VOLT,
+    UNIT_AMP,
+    UNIT_WATT,
+    UNIT_VOLT_AMP,
+    UNIT_AMP_HOUR,
+    UNIT_KILOWATT_HOUR,
+    UNIT_PERCENT,
+    UNIT_CELSIUS,
+    UNIT_SECOND,
+    UNIT_MINUTE
+};
+
+/**
+ * @brief 10 to the power of a non negative exponent
+ * 
+ * @param exponent 
+ * @return int32_t 
+ */
+constexpr int32_t powerOfTen(int exponent)
+{
+    return exponent <= 0 ? 1 : 10 * powerOfTen(exponent - 1);
+}
+
+/**
+ * @brief Rescales a fixed point value from one power of ten to another.
+ * Scaling down rounds half away from zero.
+ * 
+ * @param value The raw value
+ * @param from The exponent of the raw value
+ * @param to The exponent to convert to
+ * @return int32_t 
+ */
+constexpr int32_t rescale(int32_t value, int from, int to)
+{
+    return from >= to ? value * powerOfTen(from - to) :
+        (value >= 0 ? value + powerOfTen(to - from) / 2 : value - powerOfTen(to - from) / 2) / powerOfTen(to - from);
+}
+
+/**
+ * @brief A fixed point value of a unit, stored as an integer multiple of 10^Exponent.
+ * Conversions are resolved at compile time and cost at most a single multiply or divide.
+ * 
+ * @tparam U The Unit of the value
+ * @tparam Exponent The power of ten of a single step of the raw value
+ */
+template <uint8_t U, int8_t Exponent> class Quantity
+{
+private:
+    int32_t value;
+public:
+    constexpr Quantity() : value(0) {}
+    constexpr explicit Quantity(int32_t value) : value(value) {}
+
+    /**
+     * @brief Get the raw integer value
+     * 
+     * @return int32_t 
+     */
+    constexpr int32_t raw() const { return value; }
+
+    /**
+     * @brief Convert to another power of ten of the same unit
+     * 
+     * @tparam To The exponent to convert to
+     * @return Quantity<U, To> 
+     */
+    template <int8_t To> constexpr Quantity<U, To> as() const { return Quantity<U, To>(rescale(value, Exponent, To)); }
+
+    constexpr Quantity operator+(Quantity other) const { return Quantity(value + other.value); }
+    constexpr Quantity operator-(Quantity other) const { return Quantity(value - other.value); }
+    constexpr bool operator==(Quantity other) const { return value == other.value; }
+    constexpr bool operator!=(Quantity other) const { return value != other.value; }
+    constexpr bool operator<(Quantity other) const { return value < other.value; }
+    constexpr bool operator>(Quantity other) const { return value > other.value; }
+
+    static constexpr uint8_t unit() { return U; }
+    static constexpr int8_t exponent() { return Exponent; }
+
+#ifndef __AVR__
+    /**
+     * @brief Get the value in the base unit. Only for display, everything else should stay fixed point.
+     * 
+     * @return double 
+     */
+    double toDouble() const
+    {
+        return Exponent >= 0 ? (double) value * powerOfTen(Exponent) : (double) value / powerOfTen(-Exponent);
+    }
+#endif // __AVR__
+};
+
+typedef Quantity<UNIT_VOLT, -3> Millivolts;
+typedef Quantity<UNIT_VOLT, -2> Centivolts;
+typedef Quantity<UNIT_AMP, -3> Milliamps;
+typedef Quantity<UNIT_AMP, -1> Deciamps;
+typedef Quantity<UNIT_WATT, 0> Watts;
+typedef Quantity<UNIT_VOLT_AMP, 0> VoltAmps;
+typedef Quantity<UNIT_AMP_HOUR, -3> MilliampHours;
+typedef Quantity<UNIT_KILOWATT_HOUR, -2> CentiKilowattHours;
+typedef Quantity<UNIT_KILOWATT_HOUR, -3> WattHours;
+typedef Quantity<UNIT_PERCENT, -1> Permille;
+typedef Quantity<UNIT_CELSIUS, 0> Celsius;
+typedef Quantity<UNIT_SECOND, 0> Seconds;
+typedef Quantity<UNIT_MINUTE, 0> Minutes;
+
+/**
+ * @brief A fixed point value whose unit is only known at runtime, such as an entry of a register snapshot
+ * 
+ */
+typedef struct {
+    int32_t value;
+    uint8_t unit;
+    int8_t exponent;
+} Measurement_t;
+
+/**
+ * @brief Get the value of a measurement at a given power of ten
+ * 
+ * @param measurement 
+ * @param exponent 
+ * @return int32_t 
+ */
+inline int32_t measurementAs(const Measurement_t& measurement, int8_t exponent)
+{
+    return rescale(measurement.value, measurement.exponent, exponent);
+}
+
+/**
+ * @brief Get a measurement as a typed quantity, rescaling if needed
+ * 
+ * @tparam Q The Quantity type
+ * @param measurement A measurement of the same unit as Q
+ * @return Q 
+ */
+template <typename Q> inline Q measurementAs(const Measurement_t& measurement)
+{
+    return Q(rescale(measurement.value, measurement.exponent, Q::exponent()));
+}
+
+// How a value is stored across Modbus registers
+enum RegisterFormat {
+    REGISTER_UINT16,
+    REGISTER_INT16,
+    REGISTER_UINT32,    // Upper register first, see DOUBLE_REGISTER
+    REGISTER_INT32      // Upper register first, see DOUBLE_REGISTER
+};
+
+/**
+ * @brief Describes the unit of a value held in one or two Modbus registers
+ * 
+ */
+typedef struct {
+    uint8_t address;    // Offset of the first register in the snapshot
+    uint8_t format;
+    uint8_t unit;
+    int8_t exponent;
+} RegisterUnit_t;
+
+/**
+ * @brief Converts a snapshot of registers into measurements in a single pass
+ * 
+ * @param registers The register snapshot, as read from the device
+ * @param registerCount The number of registers in the snapshot
+ * @param map The units of the values in the snapshot. May be stored in PROGMEM
+ * @param mapCount The number of entries in the map
+ * @param measurements Populated with a measurement per map entry
+ * @return int The number of measurements converted, or -1 if the map addresses past the snapshot
+ */
+inline int convertRegisters(const uint16_t* registers, int registerCount, const RegisterUnit_t* map, int mapCount, Measurement_t* measurements)
+{
+    RegisterUnit_t entry;
+
+    for (int i = 0; i < mapCount; i++)
+    {
+        memcpy_P(&entry, &map[i], sizeof(RegisterUnit_t));
+
+        bool wide = entry.format == REGISTER_UINT32 || entry.format == REGISTER_INT32;
+
+        if (entry.address + (wide ? 2 : 1) > registerCount)
+        {
+            return -1;
+        }
+
+        switch (entry.format)
+        {
+            case REGISTER_UINT16:
+                measurements[i].value = registers[entry.address];
+                break;
+            case REGISTER_INT16:
+                measurements[i].value = (int16_t) registers[entry.address];
+                break;
+            case REGISTER_UINT32:
+            case REGISTER_INT32:
+                measurements[i].value = (int32_t) (((uint32_t) registers[entry.address] << 16) | registers[entry.address + 1]);
+                break;
+            default:
+                break;
+        }
+
+        measurements[i].unit = entry.unit;
+        measurements[i].exponent = entry.exponent;
+    }
+
+    return mapCount;
+}
+
+#endif /* UNITS */
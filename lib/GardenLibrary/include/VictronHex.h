@@ -0,0 +1,170 @@
+/*
+ * File: VictronHex.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef VICTRONHEX
+#define VICTRONHEX
+
+#ifndef __AVR__
+#include <cstdint>
+#include <cstddef>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// Character denoting the start of a HEX frame
+#define VICTRON_HEX_START ':'
+// Character denoting the end of a HEX frame
+#define VICTRON_HEX_END '\n'
+// The sum of every byte in a HEX frame, including the checksum
+#define VICTRON_HEX_CHECKSUM 0x55
+// Number of bytes in front of the value of a get, set or async frame. Address (2) and flags (1)
+#define VICTRON_HEX_REGISTER_HEADER 3
+// Longest HEX frame we encode, ':' + command + header + 4 byte value + checksum + '\n'
+#define VICTRON_HEX_MAX_FRAME_LENGTH 21
+
+// HEX commands sent to a device
+enum VictronHexCommand {
+    VICTRON_HEX_ENTER_BOOT = 0x0,
+    VICTRON_HEX_PING = 0x1,
+    VICTRON_HEX_APP_VERSION = 0x3,
+    VICTRON_HEX_PRODUCT_ID = 0x4,
+    VICTRON_HEX_RESTART = 0x6,
+    VICTRON_HEX_GET = 0x7,
+    VICTRON_HEX_SET = 0x8,
+    VICTRON_HEX_ASYNC = 0xA
+};
+
+// HEX responses sent by a device. Get, set and async responses reuse their command values
+enum VictronHexResponse {
+    VICTRON_HEX_DONE = 0x1,
+    VICTRON_HEX_UNKNOWN = 0x3,
+    VICTRON_HEX_ERROR = 0x4,
+    VICTRON_HEX_PING_RESPONSE = 0x5
+};
+
+// Flags returned with get, set and async responses
+enum VictronHexFlags {
+    VICTRON_HEX_FLAG_UNKNOWN_ID = 0x01,
+    VICTRON_HEX_FLAG_NOT_SUPPORTED = 0x02,
+    VICTRON_HEX_FLAG_PARAMETER_ERROR = 0x04
+};
+
+/**
+ * @brief A decoded HEX frame. The data points into the parser's buffer and is only valid during the callback.
+ * 
+ */
+typedef struct {
+    uint8_t command;
+    uint16_t address;       // Register address, only set for get, set and async frames
+    uint8_t flags;          // Response flags, only set for get, set and async frames
+    const uint8_t* data;    // Register value for get, set and async frames, otherwise the whole payload
+    uint8_t size;
+} VictronHexFrame_t;
+
+/**
+ * @brief Whether a HEX command carries a register address, flags and value
+ * 
+ * @param command 
+ * @return true 
+ * @return false 
+ */
+inline bool victronHexIsRegister(uint8_t command)
+{
+    return command == VICTRON_HEX_GET || command == VICTRON_HEX_SET || command == VICTRON_HEX_ASYNC;
+}
+
+/**
+ * @brief Converts a single hex character into its value
+ * 
+ * @param input 
+ * @return int The value of the character, or -1 if it isn't a hex character
+ */
+inline int victronHexNibble(char input)
+{
+    if (input >= '0' && input <= '9')
+    {
+        return input - '0';
+    }
+    if (input >= 'A' && input <= 'F')
+    {
+        return input - 'A' + 10;
+    }
+    if (input >= 'a' && input <= 'f')
+    {
+        return input - 'a' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Reads a little endian register value of up to 4 bytes from a frame
+ * 
+ * @param frame 
+ * @return uint32_t 
+ */
+uint32_t victronHexValue(const VictronHexFrame_t* frame);
+
+/**
+ * @brief Encodes a HEX frame, including the leading ':', checksum and trailing '\n'
+ * 
+ * @param command The command nibble
+ * @param payload The payload bytes, excluding the checksum
+ * @param size The number of payload bytes
+ * @param buffer The buffer to write the frame into
+ * @param bufferSize The size of the buffer
+ * @return int The number of characters written, or -1 if the buffer is too small
+ */
+int victronHexEncode(uint8_t command, const uint8_t* payload, int size, char* buffer, int bufferSize);
+
+/**
+ * @brief Encodes a get command for a single register
+ * 
+ * @param address The register address
+ * @param buffer The buffer to write the frame into
+ * @param bufferSize The size of the buffer
+ * @return int The number of characters written, or -1 if the buffer is too small
+ */
+int victronHexEncodeGet(uint16_t address, char* buffer, int bufferSize);
+
+/**
+ * @brief Encodes a set command for a single register
+ * 
+ * @param address The register address
+ * @param value The value to set
+ * @param valueSize The size of the register in bytes, from 1 to 4
+ * @param buffer The buffer to write the frame into
+ * @param bufferSize The size of the buffer
+ * @return int The number of characters written, or -1 if the buffer is too small
+ */
+int victronHexEncodeSet(uint16_t address, uint32_t value, int valueSize, char* buffer, int bufferSize);
+
+#endif /* VICTRONHEX */
@@ -0,0 +1,230 @@
+/*
+ * File: VictronLabels.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef VICTRONLABELS
+#define VICTRONLABELS
+
+#include "ProgmemUtils.h"
+#include "Units.h"
+#ifndef __AVR__
+#include <cstdint>
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// Number of slots in the label hash table. Must be a power of two no larger than 256.
+#define VICTRON_HASH_SLOTS 256
+// Hash parameters, chosen so every label in VICTRON_LABELS lands in its own slot.
+// If adding a label trips the static_assert in VictronLabels.cpp, search for a new pair.
+#define VICTRON_HASH_SEED 156
+#define VICTRON_HASH_MULTIPLIER 11
+
+// Types a Victron field value can be decoded into
+enum VictronValueType {
+    VICTRON_INT8,
+    VICTRON_UINT8,      // Codes above 127, such as the charger states
+    VICTRON_INT16,
+    VICTRON_INT32,
+    VICTRON_HEX,        // Hex encoded bitmask, decoded into a uint32_t
+    VICTRON_ON_OFF,     // ON/OFF value, decoded into a bool
+    VICTRON_STRING,     // Null terminated string
+    VICTRON_CHECKSUM    // Block checksum, not a field
+};
+
+// Every label of the VE.Direct text protocol for MPPT, BMV and Phoenix products.
+// ENTRY(id, label, type, unit, scale) where scale is the power of ten applied to the raw value to get the unit.
+// e.g. "V" is sent in mV, so it is UNIT_VOLT with a scale of -3.
+#define VICTRON_LABELS(ENTRY) \
+    ENTRY(VOLTAGE,                      "V",        VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(VOLTAGE_2,                    "V2",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(VOLTAGE_3,                    "V3",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(STARTER_VOLTAGE,              "VS",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(MID_VOLTAGE,                  "VM",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(MID_DEVIATION,                "DM",       VICTRON_INT16,      UNIT_PERCENT,           -1) \
+    ENTRY(PANEL_VOLTAGE,                "VPV",      VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(PANEL_POWER,                  "PPV",      VICTRON_INT16,      UNIT_WATT,              0) \
+    ENTRY(CURRENT,                      "I",        VICTRON_INT32,      UNIT_AMP,               -3) \
+    ENTRY(CURRENT_2,                    "I2",       VICTRON_INT32,      UNIT_AMP,               -3) \
+    ENTRY(CURRENT_3,                    "I3",       VICTRON_INT32,      UNIT_AMP,               -3) \
+    ENTRY(LOAD_CURRENT,                 "IL",       VICTRON_INT32,      UNIT_AMP,               -3) \
+    ENTRY(LOAD,                         "LOAD",     VICTRON_ON_OFF,     UNIT_NONE,              0) \
+    ENTRY(BATTERY_TEMPERATURE,          "T",        VICTRON_INT16,      UNIT_CELSIUS,           0) \
+    ENTRY(INSTANTANEOUS_POWER,          "P",        VICTRON_INT32,      UNIT_WATT,              0) \
+    ENTRY(CONSUMED_AMP_HOURS,           "CE",       VICTRON_INT32,      UNIT_AMP_HOUR,          -3) \
+    ENTRY(STATE_OF_CHARGE,              "SOC",      VICTRON_INT16,      UNIT_PERCENT,           -1) \
+    ENTRY(TIME_TO_GO,                   "TTG",      VICTRON_INT16,      UNIT_MINUTE,            0) \
+    ENTRY(ALARM,                        "Alarm",    VICTRON_ON_OFF,     UNIT_NONE,              0) \
+    ENTRY(RELAY,                        "Relay",    VICTRON_ON_OFF,     UNIT_NONE,              0) \
+    ENTRY(ALARM_REASON,                 "AR",       VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(OFF_REASON,                   "OR",       VICTRON_HEX,        UNIT_NONE,              0) \
+    ENTRY(DEEPEST_DISCHARGE,            "H1",       VICTRON_INT32,      UNIT_AMP_HOUR,          -3) \
+    ENTRY(LAST_DISCHARGE,               "H2",       VICTRON_INT32,      UNIT_AMP_HOUR,          -3) \
+    ENTRY(AVERAGE_DISCHARGE,            "H3",       VICTRON_INT32,      UNIT_AMP_HOUR,          -3) \
+    ENTRY(CHARGE_CYCLES,                "H4",       VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(FULL_DISCHARGES,              "H5",       VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(CUMULATIVE_AMP_HOURS,         "H6",       VICTRON_INT32,      UNIT_AMP_HOUR,          -3) \
+    ENTRY(MIN_VOLTAGE,                  "H7",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(MAX_VOLTAGE,                  "H8",       VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(SINCE_FULL_CHARGE,            "H9",       VICTRON_INT32,      UNIT_SECOND,            0) \
+    ENTRY(AUTOMATIC_SYNCS,              "H10",      VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(LOW_VOLTAGE_ALARMS,           "H11",      VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(HIGH_VOLTAGE_ALARMS,          "H12",      VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(LOW_AUX_VOLTAGE_ALARMS,       "H13",      VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(HIGH_AUX_VOLTAGE_ALARMS,      "H14",      VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(MIN_AUX_VOLTAGE,              "H15",      VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(MAX_AUX_VOLTAGE,              "H16",      VICTRON_INT32,      UNIT_VOLT,              -3) \
+    ENTRY(DISCHARGED_ENERGY,            "H17",      VICTRON_INT32,      UNIT_KILOWATT_HOUR,     -2) \
+    ENTRY(CHARGED_ENERGY,               "H18",      VICTRON_INT32,      UNIT_KILOWATT_HOUR,     -2) \
+    ENTRY(YIELD_TOTAL,                  "H19",      VICTRON_INT32,      UNIT_KILOWATT_HOUR,     -2) \
+    ENTRY(YIELD_TODAY,                  "H20",      VICTRON_INT16,      UNIT_KILOWATT_HOUR,     -2) \
+    ENTRY(MAX_POWER_TODAY,              "H21",      VICTRON_INT16,      UNIT_WATT,              0) \
+    ENTRY(YIELD_YESTERDAY,              "H22",      VICTRON_INT16,      UNIT_KILOWATT_HOUR,     -2) \
+    ENTRY(MAX_POWER_YESTERDAY,          "H23",      VICTRON_INT16,      UNIT_WATT,              0) \
+    ENTRY(ERROR_STATE,                  "ERR",      VICTRON_INT8,       UNIT_NONE,              0) \
+    ENTRY(OPERATION_STATE,              "CS",       VICTRON_UINT8,      UNIT_NONE,              0) \
+    ENTRY(BMV_MODEL,                    "BMV",      VICTRON_STRING,     UNIT_NONE,              0) \
+    ENTRY(FIRMWARE,                     "FW",       VICTRON_STRING,     UNIT_NONE,              0) \
+    ENTRY(FIRMWARE_24,                  "FWE",      VICTRON_STRING,     UNIT_NONE,              0) \
+    ENTRY(PRODUCT_ID,                   "PID",      VICTRON_STRING,     UNIT_NONE,              0) \
+    ENTRY(SERIAL_NUMBER,                "SER#",     VICTRON_STRING,     UNIT_NONE,              0) \
+    ENTRY(DAY_SEQUENCE,                 "HSDS",     VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(DEVICE_MODE,                  "MODE",     VICTRON_INT8,       UNIT_NONE,              0) \
+    ENTRY(AC_OUT_VOLTAGE,               "AC_OUT_V", VICTRON_INT16,      UNIT_VOLT,              -2) \
+    ENTRY(AC_OUT_CURRENT,               "AC_OUT_I", VICTRON_INT16,      UNIT_AMP,               -1) \
+    ENTRY(AC_OUT_APPARENT_POWER,        "AC_OUT_S", VICTRON_INT16,      UNIT_VOLT_AMP,          0) \
+    ENTRY(WARNING_REASON,               "WARN",     VICTRON_INT16,      UNIT_NONE,              0) \
+    ENTRY(TRACKER_OPERATION_MODE,       "MPPT",     VICTRON_INT8,       UNIT_NONE,              0) \
+    ENTRY(DC_MONITOR_MODE,              "MON",      VICTRON_INT8,       UNIT_NONE,              0) \
+    ENTRY(DC_IN_VOLTAGE,                "DC_IN_V",  VICTRON_INT16,      UNIT_VOLT,              -2) \
+    ENTRY(DC_IN_CURRENT,                "DC_IN_I",  VICTRON_INT16,      UNIT_AMP,               -1) \
+    ENTRY(DC_IN_POWER,                  "DC_IN_P",  VICTRON_INT16,      UNIT_WATT,              0) \
+    ENTRY(BLOCK_CHECKSUM,               "Checksum", VICTRON_CHECKSUM,   UNIT_NONE,              0)
+
+// Field Label Identifiers. Each label is identified by its index in VICTRON_LABELS
+#define VICTRON_LABEL_ID(id, label, type, unit, scale) id,
+enum VictronLabelId {
+    VICTRON_LABELS(VICTRON_LABEL_ID)
+    VICTRON_LABEL_COUNT
+};
+#undef VICTRON_LABEL_ID
+
+/**
+ * @brief Description of a single Victron label, stored in flash on AVR.
+ * The label characters are packed little endian into two words, matching LabelToBuffer_u.
+ * 
+ */
+typedef struct {
+    uint32_t lower;
+    uint32_t upper;
+    uint8_t type;
+    uint8_t unit;
+    int8_t scale;
+} VictronLabel_t;
+
+/**
+ * @brief Adds a single label character to a running label hash.
+ * The parser calls this as each label character arrives, so the hash is ready once the label ends.
+ * 
+ * @param hash The running hash, starting at VICTRON_HASH_SEED
+ * @param input The next label character
+ * @return uint16_t 
+ */
+constexpr uint16_t victronHashStep(uint16_t hash, char input)
+{
+    return (uint16_t) (hash * VICTRON_HASH_MULTIPLIER + (uint8_t) input);
+}
+
+/**
+ * @brief Hashes a null terminated label
+ * 
+ * @param label 
+ * @param hash The running hash, starting at VICTRON_HASH_SEED
+ * @return uint16_t 
+ */
+constexpr uint16_t victronLabelHash(const char* label, uint16_t hash = VICTRON_HASH_SEED)
+{
+    return *label ? victronLabelHash(label + 1, victronHashStep(hash, *label)) : hash;
+}
+
+/**
+ * @brief Folds a label hash into a slot of the label hash table
+ * 
+ * @param hash 
+ * @return uint8_t 
+ */
+constexpr uint8_t victronHashSlot(uint16_t hash)
+{
+    return (uint8_t) (((hash >> 8) ^ hash) & (VICTRON_HASH_SLOTS - 1));
+}
+
+/**
+ * @brief Looks up a parsed label in the label hash table.
+ * Costs a single table read and a compare of the packed label, no string comparisons.
+ * 
+ * @param hash The label hash built with victronHashStep
+ * @param lower The first four characters of the label
+ * @param upper The last four characters of the label
+ * @param label Populated with the label description when found
+ * @return int The VictronLabelId of the label, or -1 if the label is unknown
+ */
+int victronFindLabel(uint16_t hash, uint32_t lower, uint32_t upper, VictronLabel_t* label);
+
+/**
+ * @brief Looks up a null terminated label in the label hash table
+ * 
+ * @param label 
+ * @param description Populated with the label description when found
+ * @return int The VictronLabelId of the label, or -1 if the label is unknown
+ */
+int victronFindLabel(const char* label, VictronLabel_t* description);
+
+/**
+ * @brief Get the description of a label by its id
+ * 
+ * @param id The VictronLabelId of the label
+ * @param description Populated with the label description when found
+ * @return int The VictronLabelId of the label, or -1 if the id is out of range
+ */
+int victronGetLabel(uint32_t id, VictronLabel_t* description);
+
+/**
+ * @brief Converts a decoded field, as passed to a VictronFieldHandler, into a measurement
+ * carrying the unit and scale of its label.
+ * 
+ * @param id The VictronLabelId of the field
+ * @param data The decoded field value
+ * @param measurement Populated with the field value, unit and scale
+ * @return int 0 on success, -1 if the field is unknown or not numeric
+ */
+int victronFieldMeasurement(uint32_t id, const void* data, Measurement_t* measurement);
+
+#endif /* VICTRONLABELS */
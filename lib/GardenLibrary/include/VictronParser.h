@@ -32,9 +32,11 @@
 #ifndef VICTRONPARSER
 #define VICTRONPARSER
 
-#include "Fields.h"
+#include "VictronLabels.h"
+#include "VictronHex.h"
 #ifndef __AVR__
 #include <cstdint>
+#include <cstddef>
 #else
 #include <Arduino.h>
 #endif // __AVR__
@@ -43,42 +45,35 @@
 #define MAX_LABEL_LENGTH 8
 // Max length of a Victron Field Value
 #define MAX_FIELD_LENGTH 32
-// Maximum number of fields that in a single block with a checksum
-#define MAX_FIELDS_COUNT 22
 
-// Convert a set of characters into a unique binary ID
-#define BUILD_RAW_ID(...) BUILD_RAW_ID_ARG(__VA_ARGS__, 0, 0, 0, 0)
-#define BUILD_RAW_ID_ARG(_1, _2, _3, _4, ...) ((_1) + ((_2) << 8) + ((unsigned long)(_3) << 16) + ((unsigned long)(_4) << 24))
+// Field values are aligned within the block so handlers can read them in place
+#ifdef __AVR__
+#define VICTRON_RECORD_ALIGNMENT 1
+#define VICTRON_RECORD_HEADER 2
+#else
+#define VICTRON_RECORD_ALIGNMENT 4
+#define VICTRON_RECORD_HEADER 4
+#endif // __AVR__
+
+// Bytes each stream reserves for the fields of a block while waiting for its checksum.
+// A full MPPT block needs ~100 bytes on AVR. Override per firmware to trade RAM for headroom.
+#ifndef VICTRON_BLOCK_SIZE
+#ifdef __AVR__
+#define VICTRON_BLOCK_SIZE 128
+#else
+#define VICTRON_BLOCK_SIZE 240
+#endif // __AVR__
+#endif // VICTRON_BLOCK_SIZE
+
+static_assert(VICTRON_BLOCK_SIZE < 256, "Block offsets are stored in a single byte");
+static_assert(VICTRON_LABEL_COUNT < 128, "Label ids are stored in a single signed byte");
+static_assert(VICTRON_LABEL_COUNT <= 64, "Labels seen in a block are tracked in a 64 bit mask");
 
 // State of the Victron serial
 enum {
     IDLE, LABEL, FIELD, ASYNC, CHECKSUM
 };
 
-// Field Label Identifiers. We convert 
-const uint32_t VOLTAGE = 'V';
-const uint32_t CURRENT = 'I';
-const uint32_t PANEL_VOLTAGE = BUILD_RAW_ID('V', 'P', 'V');
-const uint32_t PANEL_POWER = BUILD_RAW_ID('P', 'P', 'V');
-const uint32_t LOAD_CURRENT = BUILD_RAW_ID('I', 'L');
-const uint32_t OPERATION_STATE = BUILD_RAW_ID('C', 'S');
-const uint32_t ERROR_STATE = BUILD_RAW_ID('E', 'R', 'R');
-const uint32_t LOAD = BUILD_RAW_ID('L', 'O', 'A', 'D');
-const uint32_t YIELD_TOTAL = BUILD_RAW_ID('H', '1', '9');
-const uint32_t YIELD_TODAY = BUILD_RAW_ID('H', '2', '0');
-const uint32_t MAX_POWER_TODAY = BUILD_RAW_ID('H', '2', '1');
-const uint32_t YIELD_YESTERDAY = BUILD_RAW_ID('H', '2', '2');
-const uint32_t MAX_POWER_YESTERDAY = BUILD_RAW_ID('H', '2', '3');
-const uint32_t PRODUCT_ID = BUILD_RAW_ID('P', 'I', 'D');
-const uint32_t FIRMWARE = BUILD_RAW_ID('F', 'W');
-const uint32_t SERIAL_NUMBER = BUILD_RAW_ID('S', 'E', 'R', '#');
-const uint32_t TRACKER_OPERATION_MODE = BUILD_RAW_ID('M', 'P', 'P', 'T');
-const uint32_t OFF_REASON = BUILD_RAW_ID('O', 'R');
-const uint32_t DAY_SEQUENCE = BUILD_RAW_ID('H', 'S', 'D', 'S');
-const uint32_t CHEC = BUILD_RAW_ID('C', 'h', 'e', 'c');
-const uint32_t KSUM = BUILD_RAW_ID('k', 's', 'u', 'm');
-
-
 // Used to convert Field labels to binary values for fast comparisons
 typedef union {
     unsigned char buffer[MAX_LABEL_LENGTH];
@@ -88,30 +83,134 @@ typedef union {
     }; 
 } LabelToBuffer_u;
 
+/**
+ * @brief Memory used by a single parser, which handles a single VE.Direct stream
+ * 
+ */
+typedef struct {
+    size_t total;       // Total bytes of the parser, including the block
+    size_t block;       // Bytes reserved for pending fields
+    size_t blockPeak;   // Most block bytes used by a single block so far
+} VictronFootprint_t;
+
+/**
+ * @brief Health of a single VE.Direct stream. Byte counts convert to time at the stream
+ * baud rate, roughly 1920 bytes a second at 19200.
+ * 
+ */
+typedef struct {
+    uint32_t bytes;             // Bytes parsed
+    uint32_t blocks;            // Valid blocks passed to the handler
+    uint32_t blocksLost;        // Blocks dropped for a bad checksum, a missed boundary or overflowing
+    uint32_t firstBlockBytes;   // Bytes parsed before the first valid block, 0 until there is one
+    uint32_t resyncBytes;       // Bytes from the end of the last lost block to the valid block after it
+    uint32_t blocksOverflowed;  // Lost blocks that had more fields than VICTRON_BLOCK_SIZE holds
+} VictronStatistics_t;
+
+/**
+ * @brief A VICTRON_STRING field value. Strings are decoded in place into the block, which is
+ * prefixed with their size, so a view is just the record with the terminator dropped.
+ * 
+ */
+typedef struct {
+    const char* data;   // Null terminated, points into the parser block
+    uint8_t length;     // Characters, excluding the terminator
+} VictronStringView_t;
+
+/**
+ * @brief Views a VICTRON_STRING field as passed to a field handler.
+ * Like every field, the view is only valid until the handler returns, as the block is reused
+ * for the next one. Copy the characters out to keep them.
+ * 
+ * @param data The field data
+ * @param size The field size, including the null terminator
+ * @return VictronStringView_t 
+ */
+inline VictronStringView_t victronStringView(const void* data, size_t size)
+{
+    return { (const char*) data, (uint8_t) (size > 0 ? size - 1 : 0) };
+}
+
 class VictronFieldHandler
 {
 private:
 protected:
 public:
-    // VictronFieldHandler() {};
-    // virtual ~VictronFieldHandler() {};
+    virtual ~VictronFieldHandler() {};
+
+    /**
+     * @brief Called for every field of a valid block, once its checksum has been checked
+     * 
+     * @param id The VictronLabelId of the field
+     * @param data The decoded value, in place in the parser block. Only valid for the duration of the call
+     * @param size The size of the value, see victronStringView for strings
+     */
     virtual void fieldUpdate(uint32_t id, void* data, size_t size) = 0;
+
+    /**
+     * @brief Called for every valid HEX frame, such as get responses and async notifications
+     * 
+     * @param frame The decoded frame, only valid for the duration of the call
+     */
+    virtual void hexUpdate(VictronHexFrame_t* frame) { };
 };
 
+/**
+ * @brief Parses a single VE.Direct stream.
+ * Field values are decoded as they arrive into a fixed block of records, which is handed to the
+ * handler once the block checksum is valid. Label descriptions are shared constant data, so several
+ * parsers can run side by side, each costing only its state and block.
+ * 
+ */
 class VictronParser
 {
 private:
-    int state;
-    bool initialized;
+    uint8_t state;
+    // The text state a HEX frame interrupted, to return to once it ends
+    uint8_t textState;
     int8_t checksum;
+    int8_t blockHeader;
     LabelToBuffer_u labelData;
-    int labelIndex;
-    char fieldData[MAX_FIELD_LENGTH];
-    int fieldIndex;
-    Field* fields[MAX_FIELDS_COUNT];
+    uint8_t labelIndex;
+    uint16_t labelHash;
+    int8_t labelId;
+    uint8_t labelType;
+    // Characters of the current field
+    uint8_t fieldIndex;
+    uint8_t fieldFlags;
+    uint32_t fieldValue;
+    // Nibbles of the current HEX frame, kept apart so a frame can arrive in the middle of a field
+    uint8_t hexIndex;
+    uint8_t hexFlags;
+    uint8_t hexCommand;
+    uint8_t hexChecksum;
+    // Where the frame bytes are kept in the block
+    uint8_t hexBase;
+    uint8_t blockSize;
+    uint8_t blockPeak;
+    uint8_t blockFlags;
+    // Labels seen in the current block, and labels that have started a valid block
+    uint64_t blockLabels;
+    uint64_t headerLabels;
+    uint32_t lostAt;
+    VictronStatistics_t statistics;
+    alignas(VICTRON_RECORD_ALIGNMENT) uint8_t block[VICTRON_BLOCK_SIZE];
     void (*fieldHandlerFunc)(uint32_t, void*, size_t);
+    void (*hexHandlerFunc)(VictronHexFrame_t*);
     VictronFieldHandler* fieldHandlerClass;
-    int fieldCount;
+
+    /**
+     * @brief Resets the parser to wait for the start of a line
+     * 
+     */
+    void reset();
+
+    /**
+     * @brief Decodes a single character of a field value
+     * 
+     * @param input 
+     */
+    void parseFieldCharacter(char input);
 
     /**
      * @brief Process an single field line containing a Label/Data combo
@@ -119,6 +218,46 @@ private:
      */
     void processEntry();
 
+    /**
+     * @brief Validates the block checksum, processing the queued fields if it's valid
+     * 
+     */
+    void processChecksum();
+
+    /**
+     * @brief Tracks block boundaries from the labels of each line. A label already seen in the
+     * current block, or one that starts blocks, means a boundary was missed. The partial block is
+     * dropped and the checksum restarted from the current line, rather than poisoning this block too.
+     * 
+     */
+    void processLabel();
+
+    /**
+     * @brief Drops the current block and counts it as lost
+     * 
+     */
+    void loseBlock();
+
+    /**
+     * @brief Starts decoding a HEX frame. Frames may interrupt a text line anywhere but its checksum byte,
+     * the line carries on from where it was once the frame ends
+     * 
+     */
+    void beginHexFrame();
+
+    /**
+     * @brief Decodes a single character of a HEX frame
+     * 
+     * @param input 
+     */
+    void parseHexCharacter(char input);
+
+    /**
+     * @brief Validates a completed HEX frame and passes it to the handler
+     * 
+     */
+    void processHexFrame();
+
     /**
      * @brief Processes all fields in the queue
      * 
@@ -126,7 +265,7 @@ private:
     void processFields();
 
     /**
-     * @brief Frees all memory held by the fields queue
+     * @brief Drops all fields in the queue
      * 
      */
     void dumpFields();
@@ -137,7 +276,6 @@ public:
     VictronParser(VictronFieldHandler* dataHandler);
     VictronParser(void (*function)(uint32_t, void*, size_t));
     // void victronDataHandler(uint32_t id, void *data, size_t size)
-    ~VictronParser();
 
     /**
      * @brief Process a buffer read from the victron serial
@@ -146,6 +284,28 @@ public:
      * @param size The number of bytes read
      */
     void parse(const char *buffer, int size);
+
+    /**
+     * @brief Set a function to be called for every valid HEX frame.
+     * Class handlers receive HEX frames through VictronFieldHandler::hexUpdate instead.
+     * 
+     * @param function 
+     */
+    void setHexHandler(void (*function)(VictronHexFrame_t*));
+
+    /**
+     * @brief Get the memory used by this parser
+     * 
+     * @return VictronFootprint_t 
+     */
+    VictronFootprint_t getFootprint();
+
+    /**
+     * @brief Get the health of the stream
+     * 
+     * @return VictronStatistics_t 
+     */
+    VictronStatistics_t getStatistics();
 };
 
 #endif /* VICTRONPARSER */
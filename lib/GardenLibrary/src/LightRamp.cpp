@@ -0,0 +1,125 @@
+/*
+ * File: LightRamp.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "LightRamp.h"
+
+// Ramps longer than this have their progress calculated with reduced precision, to stay within 32 bits
+#define LIGHT_RAMP_PRECISE_DURATION (1UL << (32 - LIGHT_RAMP_FRACTION_BITS))
+
+/**
+ * @brief Integer square root of a 16 bit value
+ * 
+ */
+static uint8_t squareRoot(uint16_t value)
+{
+    uint16_t root = 0;
+
+    for (uint16_t bit = 1 << 7; bit > 0; bit >>= 1)
+    {
+        uint16_t candidate = root | bit;
+
+        if ((uint32_t) candidate * candidate <= value)
+        {
+            root = candidate;
+        }
+    }
+
+    return (uint8_t) root;
+}
+
+LightRamp::LightRamp() : from(0), to(0), duty(0), curve(RAMP_LINEAR), rootFrom(0), rootTo(0), start(0), duration(0), active(false) {}
+
+void LightRamp::begin(uint8_t target, uint32_t duration, uint8_t curve, uint32_t now)
+{
+    from = duty;
+    to = target;
+    this->curve = curve;
+    this->duration = duration;
+    start = now;
+
+    if (duration == 0 || from == to)
+    {
+        duty = to;
+        active = false;
+        return;
+    }
+
+    rootFrom = squareRoot((uint16_t) from << 8);
+    rootTo = squareRoot((uint16_t) to << 8);
+    active = true;
+}
+
+uint8_t LightRamp::update(uint32_t now)
+{
+    if (!active)
+    {
+        return duty;
+    }
+
+    uint32_t elapsed = now - start;
+
+    if (elapsed >= duration)
+    {
+        duty = to;
+        active = false;
+        return duty;
+    }
+
+    uint32_t fraction = duration < LIGHT_RAMP_PRECISE_DURATION ?
+        (elapsed << LIGHT_RAMP_FRACTION_BITS) / duration :
+        elapsed / (duration >> LIGHT_RAMP_FRACTION_BITS);
+
+    switch (curve)
+    {
+        case RAMP_SMOOTH:
+        {
+            // Smoothstep, 3f^2 - 2f^3
+            uint32_t square = (fraction * fraction) >> LIGHT_RAMP_FRACTION_BITS;
+            fraction = (square * (3 * LIGHT_RAMP_FRACTION_ONE - 2 * fraction)) >> LIGHT_RAMP_FRACTION_BITS;
+            break;
+        }
+        case RAMP_PERCEPTUAL:
+        {
+            // Perceived brightness is roughly the square root of the duty, so the roots are interpolated instead
+            int32_t root = rootFrom + ((int32_t) rootTo - rootFrom) * (int32_t) fraction / (int32_t) LIGHT_RAMP_FRACTION_ONE;
+            duty = (uint8_t) (((uint16_t) root * root) >> 8);
+            return duty;
+        }
+        default:
+            break;
+    }
+
+    duty = (uint8_t) (from + ((int32_t) to - from) * (int32_t) fraction / (int32_t) LIGHT_RAMP_FRACTION_ONE);
+
+    return duty;
+}
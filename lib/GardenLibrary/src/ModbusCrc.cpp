@@ -0,0 +1,113 @@
+/*
+ * File: ModbusCrc.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "ModbusCrc.h"
+#include "ProgmemUtils.h"
+
+/**
+ * @brief Shifts a CRC through a number of bits
+ */
+constexpr uint16_t crcBits(uint16_t crc, int bits)
+{
+    return bits == 0 ? crc : crcBits(crc & 1 ? (crc >> 1) ^ MODBUS_CRC_POLYNOMIAL : crc >> 1, bits - 1);
+}
+
+/**
+ * @brief Takes a CRC on through a zero byte
+ */
+constexpr uint16_t crcZero(uint16_t crc)
+{
+    return (crc >> 8) ^ crcBits(crc & 0xFF, 8);
+}
+
+/**
+ * @brief The entry of a slice table: the CRC of a byte followed by slice zero bytes, starting from zero
+ */
+constexpr uint16_t crcEntry(uint16_t byte, int slice)
+{
+    return slice == 0 ? crcBits(byte, 8) : crcZero(crcEntry(byte, slice - 1));
+}
+
+// Expands into the 256 entries of a slice table, built at compile time
+#define CRC_ENTRIES_4(slice, byte) crcEntry(byte, slice), crcEntry(byte + 1, slice), crcEntry(byte + 2, slice), crcEntry(byte + 3, slice)
+#define CRC_ENTRIES_16(slice, byte) CRC_ENTRIES_4(slice, byte), CRC_ENTRIES_4(slice, byte + 4), CRC_ENTRIES_4(slice, byte + 8), CRC_ENTRIES_4(slice, byte + 12)
+#define CRC_ENTRIES_64(slice, byte) CRC_ENTRIES_16(slice, byte), CRC_ENTRIES_16(slice, byte + 16), CRC_ENTRIES_16(slice, byte + 32), CRC_ENTRIES_16(slice, byte + 48)
+#define CRC_ENTRIES(slice) { CRC_ENTRIES_64(slice, 0), CRC_ENTRIES_64(slice, 64), CRC_ENTRIES_64(slice, 128), CRC_ENTRIES_64(slice, 192) }
+
+#ifdef __AVR__
+// Only the byte table fits alongside the firmware
+static const uint16_t crcTables[1][256] PROGMEM = { CRC_ENTRIES(0) };
+#else
+static const uint16_t crcTables[8][256] = {
+    CRC_ENTRIES(0), CRC_ENTRIES(1), CRC_ENTRIES(2), CRC_ENTRIES(3),
+    CRC_ENTRIES(4), CRC_ENTRIES(5), CRC_ENTRIES(6), CRC_ENTRIES(7)
+};
+#endif // __AVR__
+
+uint16_t modbusCrcBitwise(uint16_t crc, const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = crcBits(crc ^ data[i], 8);
+    }
+
+    return crc;
+}
+
+uint16_t modbusCrcTable(uint16_t crc, const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = (crc >> 8) ^ pgm_read_word(&crcTables[0][(crc ^ data[i]) & 0xFF]);
+    }
+
+    return crc;
+}
+
+#ifndef __AVR__
+uint16_t modbusCrcSlicing(uint16_t crc, const uint8_t* data, size_t length)
+{
+    // The CRC only reaches into the first two bytes of each block, the other six are looked up on their own.
+    // Bytes are read one at a time, so the result is the same whatever the alignment and byte order
+    while (length >= 8)
+    {
+        crc = crcTables[7][(crc ^ data[0]) & 0xFF] ^ crcTables[6][((crc >> 8) ^ data[1]) & 0xFF] ^
+            crcTables[5][data[2]] ^ crcTables[4][data[3]] ^ crcTables[3][data[4]] ^
+            crcTables[2][data[5]] ^ crcTables[1][data[6]] ^ crcTables[0][data[7]];
+        data += 8;
+        length -= 8;
+    }
+
+    return modbusCrcTable(crc, data, length);
+}
+#endif // __AVR__
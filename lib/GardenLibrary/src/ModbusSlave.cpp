@@ -0,0 +1,347 @@
+/*
+ * File: ModbusSlave.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+#include "ModbusSlave.h"
+
+ModbusSlave::ModbusSlave() : slaveId(1)
+{
+    for (int i = 0; i < SLAVE_TABLE_COUNT; i++)
+    {
+        blockCount[i] = 0;
+    }
+
+#ifdef __AVR__
+    port = NULL;
+    txPin = -1;
+    frameGap = SLAVE_FAST_FRAME_GAP;
+#endif // __AVR__
+}
+
+void ModbusSlave::setSlaveId(uint8_t slaveId)
+{
+    this->slaveId = slaveId;
+}
+
+int ModbusSlave::addBlock(uint8_t table, uint16_t address, uint16_t count, uint16_t* registers, uint8_t* bits)
+{
+    if (blockCount[table] >= SLAVE_MAX_BLOCKS || count == 0 || (uint32_t) address + count > UINT16_MAX + 1UL)
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < blockCount[table]; i++)
+    {
+        const SlaveBlock_t& block = blocks[table][i];
+
+        if ((uint32_t) address < (uint32_t) block.address + block.count && (uint32_t) block.address < (uint32_t) address + count)
+        {
+            return -1;
+        }
+    }
+
+    SlaveBlock_t& block = blocks[table][blockCount[table]++];
+
+    block.address = address;
+    block.count = count;
+
+    if (table == SLAVE_DISCRETE_INPUTS)
+    {
+        block.bits = bits;
+    }
+    else
+    {
+        block.registers = registers;
+    }
+
+    return 0;
+}
+
+const SlaveBlock_t* ModbusSlave::findBlock(uint8_t table, uint16_t address, uint16_t count) const
+{
+    for (uint8_t i = 0; i < blockCount[table]; i++)
+    {
+        const SlaveBlock_t& block = blocks[table][i];
+        // Addresses below the block wrap around past its end
+        uint16_t offset = address - block.address;
+
+        if (offset < block.count && count <= block.count - offset)
+        {
+            return &block;
+        }
+    }
+
+    return NULL;
+}
+
+int ModbusSlave::addInputRegisters(uint16_t address, uint16_t* registers, uint16_t count)
+{
+    return addBlock(SLAVE_INPUT_REGISTERS, address, count, registers, NULL);
+}
+
+int ModbusSlave::addHoldingRegisters(uint16_t address, uint16_t* registers, uint16_t count)
+{
+    return addBlock(SLAVE_HOLDING_REGISTERS, address, count, registers, NULL);
+}
+
+int ModbusSlave::addDiscreteInputs(uint16_t address, uint8_t* bits, uint16_t count)
+{
+    return addBlock(SLAVE_DISCRETE_INPUTS, address, count, NULL, bits);
+}
+
+uint16_t ModbusSlave::Ireg(uint16_t address) const
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_INPUT_REGISTERS, address, 1);
+
+    return block == NULL ? 0 : block->registers[address - block->address];
+}
+
+bool ModbusSlave::Ireg(uint16_t address, uint16_t value)
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_INPUT_REGISTERS, address, 1);
+
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    block->registers[address - block->address] = value;
+
+    return true;
+}
+
+uint16_t ModbusSlave::Hreg(uint16_t address) const
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_HOLDING_REGISTERS, address, 1);
+
+    return block == NULL ? 0 : block->registers[address - block->address];
+}
+
+bool ModbusSlave::Hreg(uint16_t address, uint16_t value)
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_HOLDING_REGISTERS, address, 1);
+
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    block->registers[address - block->address] = value;
+
+    return true;
+}
+
+bool ModbusSlave::Ists(uint16_t address) const
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_DISCRETE_INPUTS, address, 1);
+
+    return block != NULL && block->bits[address - block->address] != 0;
+}
+
+bool ModbusSlave::Ists(uint16_t address, bool value)
+{
+    const SlaveBlock_t* block = findBlock(SLAVE_DISCRETE_INPUTS, address, 1);
+
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    block->bits[address - block->address] = value;
+
+    return true;
+}
+
+int ModbusSlave::respond(const ModbusPdu_t* request, uint8_t* pdu)
+{
+    const SlaveBlock_t* block;
+    uint16_t offset;
+
+    // A request is served from a single block, so every read and write is one run of an array
+    switch (request->function)
+    {
+        case PDU_READ_DISCRETE_INPUTS:
+            if ((block = findBlock(SLAVE_DISCRETE_INPUTS, request->address, request->count)) == NULL)
+            {
+                break;
+            }
+
+            return pduReadBitsResponse(pdu, request->function, request->count, &block->bits[request->address - block->address]);
+        case PDU_READ_HOLDING_REGISTERS:
+        case PDU_READ_INPUT_REGISTERS:
+            if ((block = findBlock(request->function == PDU_READ_INPUT_REGISTERS ? SLAVE_INPUT_REGISTERS : SLAVE_HOLDING_REGISTERS,
+                request->address, request->count)) == NULL)
+            {
+                break;
+            }
+
+            return pduReadRegistersResponse(pdu, request->function, request->count, &block->registers[request->address - block->address]);
+        case PDU_WRITE_SINGLE_REGISTER:
+            if ((block = findBlock(SLAVE_HOLDING_REGISTERS, request->address, 1)) == NULL)
+            {
+                break;
+            }
+
+            block->registers[request->address - block->address] = request->value;
+
+            // The response echoes the request
+            return pduWriteSingle(pdu, request->function, request->address, request->value);
+        case PDU_WRITE_MULTIPLE_REGISTERS:
+            if ((block = findBlock(SLAVE_HOLDING_REGISTERS, request->address, request->count)) == NULL)
+            {
+                break;
+            }
+
+            // The registers are read from the request before the response is built over it
+            offset = request->address - block->address;
+
+            for (uint16_t i = 0; i < request->count; i++)
+            {
+                block->registers[offset + i] = pduRegister(request, i);
+            }
+
+            return pduWriteMultipleResponse(pdu, request->function, request->address, request->count);
+        default:
+            return pduException(pdu, request->function, PDU_ILLEGAL_FUNCTION);
+    }
+
+    return pduException(pdu, request->function, PDU_ILLEGAL_DATA_ADDRESS);
+}
+
+size_t ModbusSlave::process(uint8_t* frame, size_t length)
+{
+    uint8_t id;
+    ModbusPdu_t request;
+    int pduLength = rtuParse(frame, length, &id);
+
+    if (pduLength < 0)
+    {
+        return 0;
+    }
+
+    bool broadcast = id == SLAVE_BROADCAST_ID || id == GROUP_BROADCAST_ID;
+
+    if (id != slaveId && !broadcast)
+    {
+        return 0;
+    }
+
+    int exception = pduParseRequest(RTU_PDU(frame), pduLength, &request);
+
+    pduLength = exception == 0 ? respond(&request, RTU_PDU(frame)) : pduException(RTU_PDU(frame), request.function, exception);
+
+    // Broadcasts are acted on by every slave at once, so none of them reply
+    return broadcast ? 0 : rtuFrame(frame, slaveId, pduLength);
+}
+
+#ifdef __AVR__
+void ModbusSlave::config(HardwareSerial* port, uint32_t baud, uint8_t format, int txPin)
+{
+    this->port = port;
+    this->txPin = txPin;
+    // 3.5 characters of 11 bits, the longest a character is with parity or a second stop bit
+    frameGap = baud > SLAVE_FAST_BAUD_RATE ? SLAVE_FAST_FRAME_GAP : 38500000UL / baud;
+
+    port->begin(baud, format);
+
+    if (txPin >= 0)
+    {
+        pinMode(txPin, OUTPUT);
+        digitalWrite(txPin, LOW);
+    }
+}
+
+void ModbusSlave::task()
+{
+    size_t length = 0;
+    bool dropped = false;
+    uint32_t last = micros();
+
+    if (port == NULL || port->available() == 0)
+    {
+        return;
+    }
+
+    while ((uint32_t) (micros() - last) < frameGap)
+    {
+        if (port->available() == 0)
+        {
+            continue;
+        }
+
+        uint8_t data = port->read();
+        last = micros();
+
+        // The rest of a dropped frame is read to the gap after it, so it is not taken for the start of the next
+        if (dropped)
+        {
+            continue;
+        }
+
+        frame[length++] = data;
+
+        int expected = rtuRequestLength(frame, length);
+
+        if (expected < 0 || expected > RTU_MAX_LENGTH)
+        {
+            dropped = true;
+        }
+        else if (expected > 0 && length >= (size_t) expected)
+        {
+            // Answered as soon as the request is complete, without waiting out the gap
+            length = process(frame, length);
+
+            if (length == 0)
+            {
+                return;
+            }
+
+            if (txPin >= 0)
+            {
+                digitalWrite(txPin, HIGH);
+            }
+
+            port->write(frame, length);
+            // The driver is only released once the last byte has left
+            port->flush();
+
+            if (txPin >= 0)
+            {
+                digitalWrite(txPin, LOW);
+            }
+
+            return;
+        }
+    }
+}
+#endif // __AVR__
@@ -0,0 +1,110 @@
+/*
+ * File: VictronHex.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "VictronHex.h"
+
+/**
+ * @brief Converts the lower nibble of a value into an uppercase hex character
+ */
+inline char hexCharacter(uint8_t value)
+{
+    value &= 0x0F;
+    return value < 10 ? '0' + value : 'A' + value - 10;
+}
+
+uint32_t victronHexValue(const VictronHexFrame_t* frame)
+{
+    uint32_t value = 0;
+
+    for (int i = (frame->size > 4 ? 4 : frame->size) - 1; i >= 0; i--)
+    {
+        value = (value << 8) | frame->data[i];
+    }
+
+    return value;
+}
+
+int victronHexEncode(uint8_t command, const uint8_t* payload, int size, char* buffer, int bufferSize)
+{
+    // ':' + command + payload + checksum + '\n'
+    int length = 1 + 1 + (size * 2) + 2 + 1;
+
+    if (length > bufferSize || size < 0)
+    {
+        return -1;
+    }
+
+    uint8_t checksum = command & 0x0F;
+    int index = 0;
+
+    buffer[index++] = VICTRON_HEX_START;
+    buffer[index++] = hexCharacter(command);
+
+    for (int i = 0; i < size; i++)
+    {
+        buffer[index++] = hexCharacter(payload[i] >> 4);
+        buffer[index++] = hexCharacter(payload[i]);
+        checksum += payload[i];
+    }
+
+    checksum = VICTRON_HEX_CHECKSUM - checksum;
+
+    buffer[index++] = hexCharacter(checksum >> 4);
+    buffer[index++] = hexCharacter(checksum);
+    buffer[index++] = VICTRON_HEX_END;
+
+    return index;
+}
+
+int victronHexEncodeGet(uint16_t address, char* buffer, int bufferSize)
+{
+    uint8_t payload[VICTRON_HEX_REGISTER_HEADER] = { (uint8_t) (address & 0xFF), (uint8_t) (address >> 8), 0 };
+
+    return victronHexEncode(VICTRON_HEX_GET, payload, VICTRON_HEX_REGISTER_HEADER, buffer, bufferSize);
+}
+
+int victronHexEncodeSet(uint16_t address, uint32_t value, int valueSize, char* buffer, int bufferSize)
+{
+    if (valueSize < 1 || valueSize > 4)
+    {
+        return -1;
+    }
+
+    uint8_t payload[VICTRON_HEX_REGISTER_HEADER + 4] = { (uint8_t) (address & 0xFF), (uint8_t) (address >> 8), 0 };
+
+    for (int i = 0; i < valueSize; i++)
+    {
+        payload[VICTRON_HEX_REGISTER_HEADER + i] = (value >> (8 * i)) & 0xFF;
+    }
+
+    return victronHexEncode(VICTRON_HEX_SET, payload, VICTRON_HEX_REGISTER_HEADER + valueSize, buffer, bufferSize);
+}
@@ -0,0 +1,190 @@
+/*
+ * File: VictronLabels.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "VictronLabels.h"
+
+#ifndef __AVR__
+#include <cstring>
+using namespace std;
+#else
+#include <Arduino.h>
+#endif // __AVR__
+
+// Max length of a Victron Field Label, matches MAX_LABEL_LENGTH in VictronParser.h
+#define LABEL_LENGTH 8
+
+/**
+ * @brief Gets the length of a label at compile time
+ */
+constexpr int labelLength(const char* label)
+{
+    return *label ? 1 + labelLength(label + 1) : 0;
+}
+
+/**
+ * @brief Packs four characters of a label into a little endian word, matching LabelToBuffer_u
+ */
+constexpr uint32_t labelWord(const char* label, int length, int offset, int index = 0)
+{
+    return (index >= 4 || offset + index >= length) ? 0 :
+        ((uint32_t) (uint8_t) label[offset + index] << (8 * index)) | labelWord(label, length, offset, index + 1);
+}
+
+#define LABEL_STRING(id, label, type, unit, scale) label,
+#define LABEL_DESCRIPTION(id, label, type, unit, scale) { labelWord(label, labelLength(label), 0), labelWord(label, labelLength(label), 4), type, unit, scale },
+
+// Label strings are only used to build the tables at compile time
+constexpr const char* labelStrings[] = { VICTRON_LABELS(LABEL_STRING) };
+
+const VictronLabel_t labelDescriptions[VICTRON_LABEL_COUNT] PROGMEM = { VICTRON_LABELS(LABEL_DESCRIPTION) };
+
+/**
+ * @brief Finds the label that hashes into a slot
+ * 
+ * @return uint8_t The VictronLabelId + 1 of the label, or 0 if the slot is empty
+ */
+constexpr uint8_t findSlotLabel(int slot, int id = 0)
+{
+    return id >= VICTRON_LABEL_COUNT ? 0 :
+        victronHashSlot(victronLabelHash(labelStrings[id])) == slot ? id + 1 : findSlotLabel(slot, id + 1);
+}
+
+/**
+ * @brief Checks every label fits within a label buffer and owns its hash slot
+ */
+constexpr bool isPerfectHash(int id = 0)
+{
+    return id >= VICTRON_LABEL_COUNT ||
+        (labelLength(labelStrings[id]) <= LABEL_LENGTH && findSlotLabel(victronHashSlot(victronLabelHash(labelStrings[id]))) == id + 1 && isPerfectHash(id + 1));
+}
+
+static_assert(VICTRON_LABEL_COUNT < 255, "Victron label ids must fit in a hash slot");
+static_assert(isPerfectHash(), "Victron labels collide in the hash table, choose a new VICTRON_HASH_SEED/VICTRON_HASH_MULTIPLIER");
+
+// Generates the hash table slots at compile time
+#define SLOT(n) findSlotLabel(n)
+#define SLOTS_4(n) SLOT(n), SLOT(n + 1), SLOT(n + 2), SLOT(n + 3)
+#define SLOTS_16(n) SLOTS_4(n), SLOTS_4(n + 4), SLOTS_4(n + 8), SLOTS_4(n + 12)
+#define SLOTS_64(n) SLOTS_16(n), SLOTS_16(n + 16), SLOTS_16(n + 32), SLOTS_16(n + 48)
+#define SLOTS_256(n) SLOTS_64(n), SLOTS_64(n + 64), SLOTS_64(n + 128), SLOTS_64(n + 192)
+
+static_assert(VICTRON_HASH_SLOTS == 256, "SLOTS_256 must match VICTRON_HASH_SLOTS");
+
+const uint8_t labelSlots[VICTRON_HASH_SLOTS] PROGMEM = { SLOTS_256(0) };
+
+int victronFindLabel(uint16_t hash, uint32_t lower, uint32_t upper, VictronLabel_t* label)
+{
+    uint8_t slot = pgm_read_byte(&labelSlots[victronHashSlot(hash)]);
+
+    if (slot == 0)
+    {
+        return -1;
+    }
+
+    memcpy_P(label, &labelDescriptions[slot - 1], sizeof(VictronLabel_t));
+
+    if (label->lower != lower || label->upper != upper)
+    {
+        return -1;
+    }
+
+    return slot - 1;
+}
+
+int victronFindLabel(const char* label, VictronLabel_t* description)
+{
+    int length = strlen(label);
+
+    if (length > LABEL_LENGTH)
+    {
+        return -1;
+    }
+
+    union {
+        char buffer[LABEL_LENGTH];
+        uint32_t words[2];
+    } packed;
+
+    memset(packed.buffer, 0, LABEL_LENGTH);
+    memcpy(packed.buffer, label, length);
+
+    return victronFindLabel(victronLabelHash(label), packed.words[0], packed.words[1], description);
+}
+
+int victronGetLabel(uint32_t id, VictronLabel_t* description)
+{
+    if (id >= VICTRON_LABEL_COUNT)
+    {
+        return -1;
+    }
+
+    memcpy_P(description, &labelDescriptions[id], sizeof(VictronLabel_t));
+
+    return id;
+}
+
+int victronFieldMeasurement(uint32_t id, const void* data, Measurement_t* measurement)
+{
+    VictronLabel_t label;
+
+    if (victronGetLabel(id, &label) < 0)
+    {
+        return -1;
+    }
+
+    switch (label.type)
+    {
+        case VICTRON_INT8:
+            measurement->value = *((const int8_t*) data);
+            break;
+        case VICTRON_UINT8:
+            measurement->value = *((const uint8_t*) data);
+            break;
+        case VICTRON_INT16:
+            measurement->value = *((const int16_t*) data);
+            break;
+        case VICTRON_INT32:
+        case VICTRON_HEX:
+            measurement->value = *((const int32_t*) data);
+            break;
+        case VICTRON_ON_OFF:
+            measurement->value = *((const bool*) data) ? 1 : 0;
+            break;
+        default:
+            return -1;
+    }
+
+    measurement->unit = label.unit;
+    measurement->exponent = label.scale;
+
+    return 0;
+}
@@ -31,9 +31,8 @@
 
 #include "VictronParser.h"
 
-#include "Fields.h"
 #ifndef __AVR__
-#include <cstdlib>
+#include <cstring>
 using namespace std;
 #else
 #include <Arduino.h>
@@ -48,24 +47,79 @@ using namespace std;
 // Character denoting an Async message
 #define ASYNC_CHARACTER ':'
 
+// Field flags
+// The value had a leading minus sign
+#define FIELD_NEGATIVE 0x01
+// The value has ended, any remaining characters are ignored like atoi
+#define FIELD_DONE 0x02
+// The HEX frame is invalid and is ignored until it ends
+#define FIELD_INVALID 0x04
 
-VictronParser::VictronParser() : fieldHandlerFunc(NULL), fieldHandlerClass(NULL), fieldCount(0) { }
-VictronParser::VictronParser(VictronFieldHandler* fieldHandlerClass) : fieldHandlerFunc(NULL), fieldHandlerClass(fieldHandlerClass), fieldCount(0) { };
-VictronParser::VictronParser(void (*fieldHandlerFunc)(uint32_t, void*, size_t)) : fieldHandlerFunc(fieldHandlerFunc), fieldHandlerClass(NULL), fieldCount(0) { };
+// Block flags
+// A field didn't fit in the block, so the block can't be trusted
+#define BLOCK_OVERFLOW 0x01
+// The block was restarted at a header label, after missing the end of the previous block
+#define BLOCK_RESTARTED 0x02
 
-VictronParser::~VictronParser()
+// Every VE.Direct product starts its first block with PID, so it marks a block boundary before any are learnt
+#define DEFAULT_HEADER_LABELS ((uint64_t) 1 << PRODUCT_ID)
+
+/**
+ * @brief Gets the number of bytes a decoded value of a type occupies
+ */
+inline uint8_t valueSize(uint8_t type)
 {
-    dumpFields();
+    switch (type)
+    {
+        case VICTRON_INT8:
+            return sizeof(int8_t);
+        case VICTRON_UINT8:
+            return sizeof(uint8_t);
+        case VICTRON_INT16:
+            return sizeof(int16_t);
+        case VICTRON_INT32:
+            return sizeof(int32_t);
+        case VICTRON_HEX:
+            return sizeof(uint32_t);
+        case VICTRON_ON_OFF:
+            return sizeof(bool);
+        default:
+            return 0;
+    }
+}
+
+VictronParser::VictronParser() : fieldHandlerFunc(NULL), hexHandlerFunc(NULL), fieldHandlerClass(NULL) { reset(); }
+VictronParser::VictronParser(VictronFieldHandler* fieldHandlerClass) : fieldHandlerFunc(NULL), hexHandlerFunc(NULL), fieldHandlerClass(fieldHandlerClass) { reset(); };
+VictronParser::VictronParser(void (*fieldHandlerFunc)(uint32_t, void*, size_t)) : fieldHandlerFunc(fieldHandlerFunc), hexHandlerFunc(NULL), fieldHandlerClass(NULL) { reset(); };
+
+void VictronParser::reset()
+{
+    state = IDLE;
+    textState = IDLE;
+    checksum = 0;
+    blockSize = 0;
+    blockPeak = 0;
+    blockFlags = 0;
+    blockLabels = 0;
+    headerLabels = DEFAULT_HEADER_LABELS;
+    blockHeader = -1;
+    lostAt = 0;
+    memset(&statistics, 0, sizeof(statistics));
 }
 
 void VictronParser::dumpFields()
 {
-    for (int i = (fieldCount - 1); i >= 0; i--)
-    {
-        delete fields[i];
-    }
-    
-    fieldCount = 0;
+    blockSize = 0;
+    blockFlags = 0;
+    blockLabels = 0;
+    blockHeader = -1;
+}
+
+void VictronParser::loseBlock()
+{
+    dumpFields();
+    statistics.blocksLost++;
+    lostAt = statistics.bytes;
 }
 
 void VictronParser::processFields()
@@ -75,51 +129,65 @@ void VictronParser::processFields()
         dumpFields();
         return;
     }
-    
-    Field* field;
 
-    if (fieldHandlerClass)
+    // Records are laid out as [id][size][padding][value]
+    for (int index = 0; index < blockSize; )
     {
-        for (int i = (fieldCount - 1); i >= 0; i--)
+        uint8_t id = block[index];
+        uint8_t size = block[index + 1];
+        void* data = &block[index + VICTRON_RECORD_HEADER];
+
+        if (fieldHandlerClass)
         {
-            field = fields[i];
-            fieldHandlerClass->fieldUpdate(field->getId(), field->getData(), field->getSize());
-            delete field;
+            fieldHandlerClass->fieldUpdate(id, data, size);
         }
-    }
-    else
-    {
-        for (int i = (fieldCount - 1); i >= 0; i--)
+        else
         {
-            field = fields[i];
-            fieldHandlerFunc(field->getId(), field->getData(), field->getSize());
-            delete field;
+            fieldHandlerFunc(id, data, size);
         }
+
+        index += (VICTRON_RECORD_HEADER + size + VICTRON_RECORD_ALIGNMENT - 1) & ~(VICTRON_RECORD_ALIGNMENT - 1);
     }
 
-    fieldCount = 0;
+    dumpFields();
 }
 
 void VictronParser::parse(const char *buffer, int size)
 {
     int index = 0;
-    do
+    while (index < size)
     {
         char input = buffer[index++];
+        statistics.bytes++;
         switch (state)
         {
             case LABEL:
                 // cout << "LABEL\n";
                 if (input == SPLIT_CHARACTER)
                 {
-                    state = FIELD;
+                    VictronLabel_t label;
+                    labelId = victronFindLabel(labelHash, labelData.lower, labelData.upper, &label);
+                    // Unknown labels have their value skipped rather than decoded
+                    labelType = (labelId < 0) ? VICTRON_CHECKSUM : label.type;
+                    processLabel();
+                    // The checksum value is a single raw byte that may hold any character
+                    state = (labelId == BLOCK_CHECKSUM) ? CHECKSUM : FIELD;
                     fieldIndex = 0;
-                    memset(fieldData, 0, MAX_FIELD_LENGTH);
+                    fieldFlags = 0;
+                    fieldValue = 0;
                 }
                 else if (input == ASYNC_CHARACTER)
                 {
-                    // Data we don't care about, ignore it
-                    state = ASYNC;
+                    // A HEX frame isn't part of the text checksum, the label carries on after it
+                    beginHexFrame();
+                }
+                else if (input == START_CHARACTER || input == END_CHARACTER)
+                {
+                    // The line was cut short, wait for the next one
+                    state = input == START_CHARACTER ? LABEL : IDLE;
+                    memset(labelData.buffer, 0, MAX_LABEL_LENGTH);
+                    labelIndex = 0;
+                    labelHash = VICTRON_HASH_SEED;
                 }
                 else if (labelIndex >= MAX_LABEL_LENGTH)
                 {
@@ -130,6 +198,7 @@ void VictronParser::parse(const char *buffer, int size)
                 else
                 {
                     labelData.buffer[labelIndex++] = input;
+                    labelHash = victronHashStep(labelHash, input);
                 }
                 break;
             case FIELD:
@@ -139,6 +208,11 @@ void VictronParser::parse(const char *buffer, int size)
                     // Process everything
                     processEntry();
                 }
+                else if (input == ASYNC_CHARACTER)
+                {
+                    // Values never hold the async character, so it starts a frame sent in the middle of the value
+                    beginHexFrame();
+                }
                 else if (fieldIndex >= MAX_FIELD_LENGTH)
                 {
                     // Something went wrong and the label length is too long
@@ -147,18 +221,38 @@ void VictronParser::parse(const char *buffer, int size)
                 }
                 else
                 {
-                    fieldData[fieldIndex++] = input;
+                    parseFieldCharacter(input);
                 }
                 break;
             case IDLE:
-            case ASYNC:
                 if (input == START_CHARACTER)
                 {
                     state = LABEL;
                     memset(labelData.buffer, 0, MAX_LABEL_LENGTH);
                     labelIndex = 0;
+                    labelHash = VICTRON_HASH_SEED;
+                }
+                else if (input == ASYNC_CHARACTER)
+                {
+                    beginHexFrame();
                 }
                 break;
+            case ASYNC:
+                if (input == START_CHARACTER)
+                {
+                    // The end of a HEX frame isn't part of the text checksum either
+                    state = textState;
+                    processHexFrame();
+                    continue;
+                }
+                parseHexCharacter(input);
+                break;
+            case CHECKSUM:
+                // The checksum byte completes the block, so it must be summed before validating
+                checksum += input;
+                state = IDLE;
+                processChecksum();
+                continue;
             default:
                 break;
         }
@@ -167,70 +261,321 @@ void VictronParser::parse(const char *buffer, int size)
             checksum += input;
         }
     }
-    while(index < size);
+}
+
+void VictronParser::parseFieldCharacter(char input)
+{
+    int nibble;
+
+    switch (labelType)
+    {
+        case VICTRON_INT8:
+        case VICTRON_UINT8:
+        case VICTRON_INT16:
+        case VICTRON_INT32:
+            if (input == '-' && fieldIndex == 0)
+            {
+                fieldFlags |= FIELD_NEGATIVE;
+            }
+            else if (input >= '0' && input <= '9' && !(fieldFlags & FIELD_DONE))
+            {
+                fieldValue = fieldValue * 10 + (input - '0');
+            }
+            else
+            {
+                fieldFlags |= FIELD_DONE;
+            }
+            break;
+        case VICTRON_HEX:
+            nibble = victronHexNibble(input);
+            if ((input == 'x' || input == 'X') && fieldIndex == 1 && fieldValue == 0)
+            {
+                // 0x prefix
+            }
+            else if (nibble >= 0 && !(fieldFlags & FIELD_DONE))
+            {
+                fieldValue = (fieldValue << 4) | nibble;
+            }
+            else
+            {
+                fieldFlags |= FIELD_DONE;
+            }
+            break;
+        case VICTRON_ON_OFF:
+            // Keeps the last characters, compared once the field ends
+            fieldValue = (fieldValue << 8) | (uint8_t) input;
+            break;
+        case VICTRON_STRING:
+            // Strings are written straight into their record, leaving room for the null terminator
+            if (blockSize + VICTRON_RECORD_HEADER + fieldIndex + 1 < VICTRON_BLOCK_SIZE)
+            {
+                block[blockSize + VICTRON_RECORD_HEADER + fieldIndex] = input;
+            }
+            break;
+        default:
+            break;
+    }
+
+    fieldIndex++;
+}
+
+void VictronParser::processLabel()
+{
+    if (labelId < 0 || labelId == BLOCK_CHECKSUM)
+    {
+        return;
+    }
+
+    uint64_t label = (uint64_t) 1 << labelId;
+
+    if ((blockLabels & label) || (headerLabels & label))
+    {
+        // Anything before this line, such as the tail of a truncated block or line noise, isn't part of the block.
+        // Every line starts with END_CHARACTER and START_CHARACTER, even if the END_CHARACTER was taken as a checksum.
+        int8_t lineChecksum = END_CHARACTER + START_CHARACTER;
+
+        for (uint8_t i = 0; i < labelIndex; i++)
+        {
+            lineChecksum += labelData.buffer[i];
+        }
+
+        bool restarted = blockLabels || checksum != lineChecksum;
+
+        if (blockLabels)
+        {
+            loseBlock();
+        }
+
+        if (restarted && (headerLabels & label))
+        {
+            blockFlags |= BLOCK_RESTARTED;
+        }
+
+        checksum = lineChecksum;
+    }
+
+    if (!blockLabels)
+    {
+        blockHeader = labelId;
+    }
+
+    blockLabels |= label;
+}
+
+void VictronParser::beginHexFrame()
+{
+    int base = blockSize;
+
+    // Frame bytes are kept in the unused end of the block, after any pending fields and a string being written
+    if (state == FIELD && labelType == VICTRON_STRING)
+    {
+        base += VICTRON_RECORD_HEADER + fieldIndex + 1;
+    }
+
+    textState = state;
+    state = ASYNC;
+    hexBase = base < VICTRON_BLOCK_SIZE ? base : VICTRON_BLOCK_SIZE;
+    hexIndex = 0;
+    hexFlags = 0;
+}
+
+void VictronParser::parseHexCharacter(char input)
+{
+    int nibble = victronHexNibble(input);
+
+    // Invalid frames are ignored until the end of the frame
+    if (hexFlags & FIELD_INVALID)
+    {
+        return;
+    }
+
+    int index = hexBase + ((hexIndex - 1) >> 1);
+
+    if (nibble < 0 || hexIndex == 0xFF || (hexIndex > 0 && index >= VICTRON_BLOCK_SIZE))
+    {
+        hexFlags |= FIELD_INVALID;
+        return;
+    }
+
+    if (hexIndex == 0)
+    {
+        hexCommand = nibble;
+        hexChecksum = nibble;
+    }
+    else if ((hexIndex & 1) == 1)
+    {
+        block[index] = nibble << 4;
+    }
+    else
+    {
+        block[index] |= nibble;
+        hexChecksum += block[index];
+    }
+
+    hexIndex++;
+}
+
+void VictronParser::processHexFrame()
+{
+    // Needs the command, whole bytes and a checksum byte
+    if ((hexFlags & FIELD_INVALID) || hexIndex < 3 || (hexIndex & 1) == 0 || hexChecksum != VICTRON_HEX_CHECKSUM)
+    {
+        return;
+    }
+
+    if (!hexHandlerFunc && !fieldHandlerClass)
+    {
+        return;
+    }
+
+    VictronHexFrame_t frame;
+    const uint8_t* payload = &block[hexBase];
+    // Excluding the checksum
+    int size = ((hexIndex - 1) >> 1) - 1;
+
+    frame.command = hexCommand;
+
+    if (victronHexIsRegister(hexCommand) && size >= VICTRON_HEX_REGISTER_HEADER)
+    {
+        frame.address = payload[0] | (payload[1] << 8);
+        frame.flags = payload[2];
+        frame.data = payload + VICTRON_HEX_REGISTER_HEADER;
+        frame.size = size - VICTRON_HEX_REGISTER_HEADER;
+    }
+    else
+    {
+        frame.address = 0;
+        frame.flags = 0;
+        frame.data = payload;
+        frame.size = size;
+    }
+
+    if (fieldHandlerClass)
+    {
+        fieldHandlerClass->hexUpdate(&frame);
+    }
+    else
+    {
+        hexHandlerFunc(&frame);
+    }
+}
+
+void VictronParser::setHexHandler(void (*hexHandlerFunc)(VictronHexFrame_t*))
+{
+    this->hexHandlerFunc = hexHandlerFunc;
+}
+
+VictronStatistics_t VictronParser::getStatistics()
+{
+    return statistics;
+}
+
+VictronFootprint_t VictronParser::getFootprint()
+{
+    VictronFootprint_t footprint;
+
+    footprint.total = sizeof(VictronParser);
+    footprint.block = VICTRON_BLOCK_SIZE;
+    footprint.blockPeak = blockPeak;
+
+    return footprint;
+}
+
+void VictronParser::processChecksum()
+{
+    if (checksum == 0 && !(blockFlags & BLOCK_OVERFLOW))
+    {
+        if (blockHeader >= 0)
+        {
+            headerLabels |= (uint64_t) 1 << blockHeader;
+        }
+
+        if (statistics.blocks++ == 0)
+        {
+            statistics.firstBlockBytes = statistics.bytes;
+        }
+
+        if (lostAt)
+        {
+            statistics.resyncBytes = statistics.bytes - lostAt;
+            lostAt = 0;
+        }
+
+        processFields();
+    }
+    else
+    {
+        // A corrupted block that passed its checksum could have taught us a false header,
+        // which would split every block after it. Relearn them if a restart didn't help.
+        if (blockFlags & BLOCK_RESTARTED)
+        {
+            headerLabels = DEFAULT_HEADER_LABELS;
+        }
+
+        if (blockFlags & BLOCK_OVERFLOW)
+        {
+            statistics.blocksOverflowed++;
+        }
+
+        loseBlock();
+    }
+    checksum = 0;
 }
 
 void VictronParser::processEntry()
 {
-    // Victron specifies a max number of fields.
-    // If we go over this count we might be overloading a queue.
-    // We should dump our queue as we've got ourselves into a bad state.
-    if (fieldCount >= MAX_FIELDS_COUNT)
+    // Unknown labels are still part of the checksum, but are otherwise ignored
+    if (labelId < 0 || labelType == VICTRON_CHECKSUM)
     {
-        dumpFields();
+        return;
     }
-    
-    switch (labelData.lower)
+
+    uint8_t* record = &block[blockSize];
+    uint8_t size = (labelType == VICTRON_STRING) ? fieldIndex + 1 : valueSize(labelType);
+    int end = blockSize + VICTRON_RECORD_HEADER + size;
+
+    // A block with more fields than we have room for is dropped when it completes
+    if (end > VICTRON_BLOCK_SIZE)
+    {
+        blockFlags |= BLOCK_OVERFLOW;
+        return;
+    }
+
+    int32_t value = (fieldFlags & FIELD_NEGATIVE) ? -((int32_t) fieldValue) : (int32_t) fieldValue;
+    void* data = &record[VICTRON_RECORD_HEADER];
+
+    record[0] = labelId;
+    record[1] = size;
+
+    switch (labelType)
     {
-        case VOLTAGE:
-        case PANEL_VOLTAGE:
-            fields[fieldCount] = new Field(labelData.lower, atol(fieldData));
-            fieldCount++;
+        case VICTRON_INT32:
+        case VICTRON_HEX:
+            memcpy(data, &value, sizeof(int32_t));
             break;
-        case CURRENT:
-        case PANEL_POWER:
-        case LOAD_CURRENT:
-        case YIELD_TOTAL:
-        case YIELD_TODAY:
-        case MAX_POWER_TODAY:
-        case YIELD_YESTERDAY:
-        case MAX_POWER_YESTERDAY:
-        case DAY_SEQUENCE:
-            fields[fieldCount] = new Field(labelData.lower, atoi(fieldData));
-            fieldCount++;
+        case VICTRON_INT16:
+            *((int16_t*) data) = (int16_t) value;
             break;
-        case OPERATION_STATE:
-        case ERROR_STATE:
-        case TRACKER_OPERATION_MODE:
-            fields[fieldCount] = new Field(labelData.lower, (int8_t) atoi(fieldData));
-            fieldCount++;
+        case VICTRON_INT8:
+            *((int8_t*) data) = (int8_t) value;
             break;
-        case PRODUCT_ID:
-        case FIRMWARE:
-        case SERIAL_NUMBER:
-            fields[fieldCount] = new Field(labelData.lower, fieldData, fieldIndex + 1);
-            fieldCount++;
+        case VICTRON_UINT8:
+            *((uint8_t*) data) = (uint8_t) value;
             break;
-        case LOAD: // ON/OFF value
-            fields[fieldCount] = new Field(labelData.lower, (bool) (strcmp(fieldData, "ON") == 0));
-            fieldCount++;
+        case VICTRON_ON_OFF:
+            *((bool*) data) = (fieldIndex == 2 && fieldValue == (('O' << 8) | 'N'));
+            break;
+        case VICTRON_STRING:
+            // Characters were written while parsing
+            record[VICTRON_RECORD_HEADER + fieldIndex] = '\0';
             break;
-        case CHEC:
-            if (labelData.upper == KSUM)
-            {
-                if (checksum == 0)
-                {
-                    processFields();
-                }
-                else
-                {
-                    dumpFields();
-                }
-                checksum = 0;
-            }
-        break; 
-        case OFF_REASON:
         default:
             break;
     }
-}
\ No newline at end of file
+
+    blockSize = (end + VICTRON_RECORD_ALIGNMENT - 1) & ~(VICTRON_RECORD_ALIGNMENT - 1);
+    if (blockSize > blockPeak)
+    {
+        blockPeak = blockSize;
+    }
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include "LightRamp.h"
+
+TEST(LightRamp, TestLevelConversion) {
+    EXPECT_EQ(lightDuty(0), 0);
+    EXPECT_EQ(lightDuty(50), 127);
+    EXPECT_EQ(lightDuty(100), 255);
+    EXPECT_EQ(lightDuty(1000), 255);
+
+    for (uint16_t level = 0; level <= LIGHT_MAX_LEVEL; level++)
+    {
+        EXPECT_EQ(lightLevel(lightDuty(level)), level);
+    }
+}
+
+TEST(LightRamp, TestStep) {
+    LightRamp ramp;
+
+    ramp.begin(200, 0, RAMP_LINEAR, 1000);
+
+    EXPECT_FALSE(ramp.isActive());
+    EXPECT_EQ(ramp.getDuty(), 200);
+    EXPECT_EQ(ramp.update(1000), 200);
+}
+
+TEST(LightRamp, TestLinear) {
+    LightRamp ramp;
+
+    ramp.begin(200, 1000, RAMP_LINEAR, 5000);
+
+    EXPECT_TRUE(ramp.isActive());
+    EXPECT_EQ(ramp.getTarget(), 200);
+    EXPECT_EQ(ramp.update(5000), 0);
+    EXPECT_EQ(ramp.update(5250), 50);
+    EXPECT_EQ(ramp.update(5500), 100);
+    EXPECT_EQ(ramp.update(6000), 200);
+    EXPECT_FALSE(ramp.isActive());
+
+    // Fading down starts from wherever the light is
+    ramp.begin(100, 2000, RAMP_LINEAR, 7000);
+    EXPECT_EQ(ramp.update(8000), 150);
+    EXPECT_EQ(ramp.update(9000), 100);
+}
+
+TEST(LightRamp, TestCurvesAreMonotonic) {
+    for (uint8_t curve = RAMP_LINEAR; curve < RAMP_CURVE_COUNT; curve++)
+    {
+        LightRamp up, down;
+        uint8_t upDuty = 0, downDuty = 255;
+
+        up.begin(255, 60000, curve, 0);
+        down.begin(255, 0, curve, 0);
+        down.begin(0, 60000, curve, 0);
+
+        for (uint32_t now = 0; now <= 60000; now += 100)
+        {
+            uint8_t next = up.update(now);
+            EXPECT_GE(next, upDuty) << "curve " << (int) curve << " at " << now;
+            upDuty = next;
+
+            next = down.update(now);
+            EXPECT_LE(next, downDuty) << "curve " << (int) curve << " at " << now;
+            downDuty = next;
+        }
+
+        EXPECT_EQ(upDuty, 255);
+        EXPECT_EQ(downDuty, 0);
+    }
+}
+
+TEST(LightRamp, TestCurveShapes) {
+    LightRamp smooth, perceptual;
+
+    smooth.begin(255, 1000, RAMP_SMOOTH, 0);
+    perceptual.begin(255, 1000, RAMP_PERCEPTUAL, 0);
+
+    // Smooth ramps are slow at either end and symmetric about the middle
+    EXPECT_LT(smooth.update(100), 255 / 10);
+    EXPECT_NEAR(smooth.update(500), 127, 1);
+    EXPECT_GT(smooth.update(900), 255 - 255 / 10);
+
+    // Perceptual ramps spend longer at low duties
+    EXPECT_NEAR(perceptual.update(500), 63, 1);
+}
+
+TEST(LightRamp, TestClockWrap) {
+    LightRamp ramp;
+
+    ramp.begin(100, 1000, RAMP_LINEAR, UINT32_MAX - 499);
+
+    EXPECT_EQ(ramp.update(0), 50);
+    EXPECT_EQ(ramp.update(500), 100);
+    EXPECT_FALSE(ramp.isActive());
+}
+
+TEST(LightRamp, TestLongRamps) {
+    LightRamp ramp;
+    // The longest ramp a ramp time register can hold
+    uint32_t duration = (uint32_t) UINT16_MAX * LIGHT_RAMP_TIME_UNIT;
+
+    ramp.begin(255, duration, RAMP_LINEAR, 0);
+
+    EXPECT_NEAR(ramp.update(duration / 2), 127, 1);
+    EXPECT_EQ(ramp.update(duration), 255);
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "ModbusCrc.h"
+
+// The check value of CRC-16/MODBUS
+static const uint8_t CHECK_DATA[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+#define CHECK_CRC 0x4B37
+
+// A read of ten holding registers from slave 1, as sent on the bus
+static const uint8_t READ_REQUEST[] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD };
+
+#define TEST_LENGTH 300
+
+static void fillTestData(uint8_t* data, size_t length)
+{
+    uint32_t state = 0x12345678;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = state >> 16;
+    }
+}
+
+TEST(ModbusCrc, TestCheckValue) {
+    EXPECT_EQ(modbusCrcBitwise(MODBUS_CRC_INITIAL, CHECK_DATA, sizeof(CHECK_DATA)), CHECK_CRC);
+    EXPECT_EQ(modbusCrcTable(MODBUS_CRC_INITIAL, CHECK_DATA, sizeof(CHECK_DATA)), CHECK_CRC);
+    EXPECT_EQ(modbusCrcSlicing(MODBUS_CRC_INITIAL, CHECK_DATA, sizeof(CHECK_DATA)), CHECK_CRC);
+    EXPECT_EQ(modbusCrc(CHECK_DATA, sizeof(CHECK_DATA)), CHECK_CRC);
+    EXPECT_EQ(modbusCrc(CHECK_DATA, 0), MODBUS_CRC_INITIAL);
+}
+
+TEST(ModbusCrc, TestFrame) {
+    uint8_t frame[sizeof(READ_REQUEST)];
+
+    EXPECT_TRUE(modbusCrcCheck(READ_REQUEST, sizeof(READ_REQUEST)));
+
+    memcpy(frame, READ_REQUEST, sizeof(frame));
+    memset(&frame[sizeof(frame) - MODBUS_CRC_LENGTH], 0, MODBUS_CRC_LENGTH);
+    EXPECT_EQ(modbusCrcAppend(frame, sizeof(frame) - MODBUS_CRC_LENGTH), sizeof(frame));
+    EXPECT_EQ(memcmp(frame, READ_REQUEST, sizeof(frame)), 0);
+
+    // Any single flipped bit is caught
+    for (size_t bit = 0; bit < sizeof(frame) * 8; bit++)
+    {
+        frame[bit / 8] ^= 1 << (bit % 8);
+        EXPECT_FALSE(modbusCrcCheck(frame, sizeof(frame)));
+        frame[bit / 8] ^= 1 << (bit % 8);
+    }
+
+    EXPECT_FALSE(modbusCrcCheck(frame, 1));
+}
+
+TEST(ModbusCrc, TestVariantsMatch) {
+    uint8_t data[TEST_LENGTH + 8];
+
+    fillTestData(data, sizeof(data));
+
+    // Every length around the block size, from every alignment
+    for (size_t offset = 0; offset < 8; offset++)
+    {
+        for (size_t length = 0; length <= TEST_LENGTH; length++)
+        {
+            uint16_t expected = modbusCrcBitwise(MODBUS_CRC_INITIAL, &data[offset], length);
+
+            ASSERT_EQ(modbusCrcTable(MODBUS_CRC_INITIAL, &data[offset], length), expected);
+            ASSERT_EQ(modbusCrcSlicing(MODBUS_CRC_INITIAL, &data[offset], length), expected);
+        }
+    }
+}
+
+TEST(ModbusCrc, TestIncremental) {
+    uint8_t data[TEST_LENGTH];
+
+    fillTestData(data, sizeof(data));
+
+    uint16_t expected = modbusCrc(data, sizeof(data));
+
+    // Split anywhere, as when a frame arrives over several reads
+    for (size_t split = 0; split <= sizeof(data); split++)
+    {
+        uint16_t crc = modbusCrcUpdate(MODBUS_CRC_INITIAL, data, split);
+
+        ASSERT_EQ(modbusCrcUpdate(crc, &data[split], sizeof(data) - split), expected);
+    }
+
+    // A byte at a time
+    uint16_t crc = MODBUS_CRC_INITIAL;
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        crc = modbusCrcUpdate(crc, &data[i], 1);
+    }
+
+    EXPECT_EQ(crc, expected);
+}
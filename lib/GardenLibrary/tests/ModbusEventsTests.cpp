@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "ModbusEvents.h"
+
+#define TEST_LOG_LENGTH 4
+
+enum TEST_EVENT_REGISTERS {
+    TEST_BEFORE,
+    EVENT_LOG(TEST_EVENTS, TEST_LOG_LENGTH),
+    TEST_AFTER,
+    TOTAL_TEST_EVENT_REGISTERS
+};
+
+static uint16_t eventRegisters[TOTAL_TEST_EVENT_REGISTERS];
+
+static void writeEventRegister(int address, uint16_t value)
+{
+    eventRegisters[address] = value;
+}
+
+static void writeTestEvent(uint16_t sequence, uint16_t type, uint16_t value, uint32_t time)
+{
+    WRITE_EVENT(writeEventRegister, TEST_EVENTS, sequence, type, value, time);
+    WRITE_EVENT_LOG_UPTIME(writeEventRegister, TEST_EVENTS, time);
+}
+
+TEST(ModbusEvents, TestEventLogSpans) {
+    static_assert(EVENT_LOG_REGISTERS(4) == 23, "A sequence and uptime then five registers an event");
+    static_assert(EVENT_LOG_LENGTH(TEST_EVENTS) == TEST_LOG_LENGTH, "Spans hold the whole ring");
+    static_assert(TEST_AFTER == TEST_EVENTS_END + 1, "Registers after a log follow it");
+}
+
+TEST(ModbusEvents, TestReadNewEvents) {
+    ModbusEvent_t events[TEST_LOG_LENGTH];
+    uint16_t sequence = 0;
+    uint32_t uptime = 0;
+
+    memset(eventRegisters, 0, sizeof(eventRegisters));
+
+    // Nothing has happened yet
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 0);
+
+    writeTestEvent(1, 7, 1, 100);
+    writeTestEvent(2, 8, 45, 0x12345);
+
+    EXPECT_EQ(eventRegisters[TEST_BEFORE], 0);
+    EXPECT_EQ(eventRegisters[TEST_AFTER], 0);
+
+    ASSERT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 2);
+    EXPECT_EQ(sequence, 2);
+    EXPECT_EQ(uptime, 0x12345u);
+    EXPECT_EQ(events[0].sequence, 1);
+    EXPECT_EQ(events[0].type, 7);
+    EXPECT_EQ(events[0].value, 1);
+    EXPECT_EQ(events[0].time, 100u);
+    EXPECT_EQ(events[1].type, 8);
+    EXPECT_EQ(events[1].value, 45);
+    EXPECT_EQ(events[1].time, 0x12345u);
+
+    // Only events since the last read are returned
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 0);
+
+    writeTestEvent(3, 7, 0, 0x12346);
+
+    ASSERT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 1);
+    EXPECT_EQ(events[0].sequence, 3);
+}
+
+TEST(ModbusEvents, TestSequenceWraps) {
+    ModbusEvent_t events[TEST_LOG_LENGTH];
+    uint16_t sequence = UINT16_MAX - 1;
+    uint32_t uptime = 0;
+
+    memset(eventRegisters, 0, sizeof(eventRegisters));
+    writeTestEvent(UINT16_MAX, 1, 1, 10);
+    writeTestEvent(0, 1, 2, 11);
+    writeTestEvent(1, 1, 3, 12);
+
+    ASSERT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 3);
+    EXPECT_EQ(events[0].value, 1);
+    EXPECT_EQ(events[1].value, 2);
+    EXPECT_EQ(events[2].value, 3);
+    EXPECT_EQ(sequence, 1);
+}
+
+TEST(ModbusEvents, TestMissedEvents) {
+    ModbusEvent_t events[TEST_LOG_LENGTH];
+    uint16_t sequence = 0;
+    uint32_t uptime = 0;
+
+    memset(eventRegisters, 0, sizeof(eventRegisters));
+
+    for (uint16_t i = 1; i <= TEST_LOG_LENGTH + 1; i++)
+    {
+        writeTestEvent(i, 1, i, 100 + i);
+    }
+
+    // The first event has been overwritten
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), -1);
+    EXPECT_EQ(sequence, TEST_LOG_LENGTH + 1);
+
+    // Following reads pick up from the latest sequence
+    writeTestEvent(TEST_LOG_LENGTH + 2, 1, 0, 200);
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 1);
+}
+
+TEST(ModbusEvents, TestRestart) {
+    ModbusEvent_t events[TEST_LOG_LENGTH];
+    uint16_t sequence = 0;
+    uint32_t uptime = 0;
+
+    memset(eventRegisters, 0, sizeof(eventRegisters));
+    writeTestEvent(1, 1, 1, 500);
+    writeTestEvent(2, 1, 0, 600);
+
+    ASSERT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 2);
+
+    // The device restarts and has the same number of events again by the next read
+    memset(eventRegisters, 0, sizeof(eventRegisters));
+    writeTestEvent(1, 1, 1, 5);
+    writeTestEvent(2, 1, 1, 6);
+
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), -1);
+    EXPECT_EQ(readEventLog(&eventRegisters[TEST_EVENTS], TEST_LOG_LENGTH, &sequence, &uptime, events), 0);
+}
@@ -0,0 +1,256 @@
+/*
+ * File: ModbusFrameTests.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+#include "ModbusFrame.h"
+
+// Examples from the Modbus application protocol specification
+static const uint8_t READ_HOLDING_REQUEST[] = { 0x03, 0x00, 0x6B, 0x00, 0x03 };
+static const uint8_t READ_HOLDING_RESPONSE[] = { 0x03, 0x06, 0x02, 0x2B, 0x00, 0x00, 0x00, 0x64 };
+static const uint8_t READ_COILS_RESPONSE[] = { 0x01, 0x03, 0xCD, 0x6B, 0x05 };
+static const uint8_t WRITE_COIL_REQUEST[] = { 0x05, 0x00, 0xAC, 0xFF, 0x00 };
+static const uint8_t WRITE_COILS_REQUEST[] = { 0x0F, 0x00, 0x13, 0x00, 0x0A, 0x02, 0xCD, 0x01 };
+static const uint8_t WRITE_REGISTERS_REQUEST[] = { 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 0x00, 0x0A, 0x01, 0x02 };
+static const uint8_t WRITE_REGISTERS_RESPONSE[] = { 0x10, 0x00, 0x01, 0x00, 0x02 };
+
+// A read of ten holding registers from slave 1, as sent on the bus
+static const uint8_t READ_ADU[] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A, 0xC5, 0xCD };
+
+TEST(ModbusFrame, TestReadRequest) {
+    uint8_t pdu[PDU_MAX_LENGTH];
+    ModbusPdu_t request;
+
+    ASSERT_EQ(pduReadRequest(pdu, PDU_READ_HOLDING_REGISTERS, 0x6B, 3), (int) sizeof(READ_HOLDING_REQUEST));
+    EXPECT_EQ(memcmp(pdu, READ_HOLDING_REQUEST, sizeof(READ_HOLDING_REQUEST)), 0);
+
+    EXPECT_EQ(pduParseRequest(pdu, sizeof(READ_HOLDING_REQUEST), &request), 0);
+    EXPECT_EQ(request.function, PDU_READ_HOLDING_REGISTERS);
+    EXPECT_EQ(request.address, 0x6B);
+    EXPECT_EQ(request.count, 3);
+
+    EXPECT_EQ(pduReadRequest(pdu, PDU_READ_HOLDING_REGISTERS, 0, 0), -1);
+    EXPECT_EQ(pduReadRequest(pdu, PDU_READ_INPUT_REGISTERS, 0, PDU_MAX_READ_REGISTERS + 1), -1);
+    EXPECT_EQ(pduReadRequest(pdu, PDU_READ_COILS, 0, PDU_MAX_READ_BITS), 5);
+    EXPECT_EQ(pduReadRequest(pdu, PDU_WRITE_SINGLE_REGISTER, 0, 1), -1);
+}
+
+TEST(ModbusFrame, TestReadRegistersResponse) {
+    uint16_t values[] = { 0x022B, 0x0000, 0x0064 };
+    uint8_t pdu[PDU_MAX_LENGTH];
+    ModbusPdu_t request;
+    ModbusPdu_t response;
+
+    ASSERT_EQ(pduReadRegistersResponse(pdu, PDU_READ_HOLDING_REGISTERS, 3, values), (int) sizeof(READ_HOLDING_RESPONSE));
+    EXPECT_EQ(memcmp(pdu, READ_HOLDING_RESPONSE, sizeof(READ_HOLDING_RESPONSE)), 0);
+
+    ASSERT_EQ(pduParseResponse(READ_HOLDING_RESPONSE, sizeof(READ_HOLDING_RESPONSE), &response), 0);
+    EXPECT_EQ(response.exception, 0);
+    EXPECT_EQ(response.count, 3);
+    // Zero copy, the registers are read from the buffer
+    EXPECT_EQ(response.data, &READ_HOLDING_RESPONSE[2]);
+    EXPECT_EQ(pduRegister(&response, 0), 0x022B);
+    EXPECT_EQ(pduRegister(&response, 2), 0x0064);
+
+    pduParseRequest(READ_HOLDING_REQUEST, sizeof(READ_HOLDING_REQUEST), &request);
+    EXPECT_TRUE(pduResponseMatches(&request, &response));
+    request.count = 2;
+    EXPECT_FALSE(pduResponseMatches(&request, &response));
+
+    // A byte count that disagrees with the length
+    EXPECT_EQ(pduParseResponse(READ_HOLDING_RESPONSE, sizeof(READ_HOLDING_RESPONSE) - 1, &response), -1);
+}
+
+TEST(ModbusFrame, TestBits) {
+    // Coils 20 to 38 of the specification example, the first in the lowest bit
+    uint8_t coils[19] = { 1, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 1 };
+    uint8_t written[10] = { 1, 0, 1, 1, 0, 0, 1, 1, 1, 0 };
+    uint8_t pdu[PDU_MAX_LENGTH];
+    ModbusPdu_t frame;
+
+    ASSERT_EQ(pduReadBitsResponse(pdu, PDU_READ_COILS, 19, coils), (int) sizeof(READ_COILS_RESPONSE));
+    EXPECT_EQ(memcmp(pdu, READ_COILS_RESPONSE, sizeof(READ_COILS_RESPONSE)), 0);
+
+    ASSERT_EQ(pduParseResponse(READ_COILS_RESPONSE, sizeof(READ_COILS_RESPONSE), &frame), 0);
+
+    for (uint16_t i = 0; i < 19; i++)
+    {
+        EXPECT_EQ(pduBit(&frame, i), coils[i] != 0);
+    }
+
+    ASSERT_EQ(pduWriteBitsRequest(pdu, 0x13, 10, written), (int) sizeof(WRITE_COILS_REQUEST));
+    EXPECT_EQ(memcmp(pdu, WRITE_COILS_REQUEST, sizeof(WRITE_COILS_REQUEST)), 0);
+
+    ASSERT_EQ(pduParseRequest(WRITE_COILS_REQUEST, sizeof(WRITE_COILS_REQUEST), &frame), 0);
+    EXPECT_EQ(frame.address, 0x13);
+    EXPECT_EQ(frame.count, 10);
+    EXPECT_TRUE(pduBit(&frame, 0));
+    EXPECT_FALSE(pduBit(&frame, 9));
+}
+
+TEST(ModbusFrame, TestSingleWrites) {
+    uint8_t pdu[PDU_MAX_LENGTH];
+    ModbusPdu_t request;
+    ModbusPdu_t response;
+
+    ASSERT_EQ(pduWriteSingle(pdu, PDU_WRITE_SINGLE_COIL, 0xAC, 1), (int) sizeof(WRITE_COIL_REQUEST));
+    EXPECT_EQ(memcmp(pdu, WRITE_COIL_REQUEST, sizeof(WRITE_COIL_REQUEST)), 0);
+
+    // The response echoes the request
+    ASSERT_EQ(pduParseRequest(pdu, 5, &request), 0);
+    ASSERT_EQ(pduParseResponse(pdu, 5, &response), 0);
+    EXPECT_EQ(request.value, PDU_COIL_ON);
+    EXPECT_TRUE(pduResponseMatches(&request, &response));
+
+    // Coils only take on or off
+    pduPutWord(&pdu[3], 0x1234);
+    EXPECT_EQ(pduParseRequest(pdu, 5, &request), PDU_ILLEGAL_DATA_VALUE);
+
+    ASSERT_EQ(pduWriteSingle(pdu, PDU_WRITE_SINGLE_REGISTER, 1, 0x1234), 5);
+    ASSERT_EQ(pduParseRequest(pdu, 5, &request), 0);
+    EXPECT_EQ(request.value, 0x1234);
+    EXPECT_EQ(pduWriteSingle(pdu, PDU_READ_COILS, 1, 0), -1);
+}
+
+TEST(ModbusFrame, TestWriteRegisters) {
+    uint16_t values[] = { 0x000A, 0x0102 };
+    uint8_t pdu[PDU_MAX_LENGTH];
+    ModbusPdu_t request;
+    ModbusPdu_t response;
+
+    ASSERT_EQ(pduWriteRegistersRequest(pdu, 1, 2, values), (int) sizeof(WRITE_REGISTERS_REQUEST));
+    EXPECT_EQ(memcmp(pdu, WRITE_REGISTERS_REQUEST, sizeof(WRITE_REGISTERS_REQUEST)), 0);
+
+    ASSERT_EQ(pduParseRequest(WRITE_REGISTERS_REQUEST, sizeof(WRITE_REGISTERS_REQUEST), &request), 0);
+    EXPECT_EQ(pduRegister(&request, 1), 0x0102);
+
+    ASSERT_EQ(pduWriteMultipleResponse(pdu, request.function, request.address, request.count), (int) sizeof(WRITE_REGISTERS_RESPONSE));
+    EXPECT_EQ(memcmp(pdu, WRITE_REGISTERS_RESPONSE, sizeof(WRITE_REGISTERS_RESPONSE)), 0);
+    ASSERT_EQ(pduParseResponse(pdu, sizeof(WRITE_REGISTERS_RESPONSE), &response), 0);
+    EXPECT_TRUE(pduResponseMatches(&request, &response));
+
+    // A byte count that disagrees with the count, or the length
+    EXPECT_EQ(pduParseRequest(WRITE_REGISTERS_REQUEST, sizeof(WRITE_REGISTERS_REQUEST) - 1, &request), PDU_ILLEGAL_DATA_VALUE);
+    memcpy(pdu, WRITE_REGISTERS_REQUEST, sizeof(WRITE_REGISTERS_REQUEST));
+    pdu[4] = 3;
+    EXPECT_EQ(pduParseRequest(pdu, sizeof(WRITE_REGISTERS_REQUEST), &request), PDU_ILLEGAL_DATA_VALUE);
+    EXPECT_EQ(pduWriteRegistersRequest(pdu, 0, PDU_MAX_WRITE_REGISTERS + 1, values), -1);
+}
+
+TEST(ModbusFrame, TestTruncatedWriteResponses) {
+    const uint8_t functions[] = { PDU_WRITE_SINGLE_COIL, PDU_WRITE_SINGLE_REGISTER, PDU_WRITE_MULTIPLE_COILS, PDU_WRITE_MULTIPLE_REGISTERS };
+    ModbusPdu_t response;
+
+    for (uint8_t function : functions)
+    {
+        for (size_t length = 2; length < 5; length++)
+        {
+            // Sized to the frame, so a read past it is caught by the sanitizers
+            std::vector<uint8_t> pdu(length, 0xFF);
+            pdu[0] = function;
+
+            EXPECT_EQ(pduParseResponse(pdu.data(), length, &response), -1);
+            EXPECT_EQ(response.address, 0);
+            EXPECT_EQ(response.count, 0);
+            EXPECT_EQ(response.value, 0);
+        }
+    }
+}
+
+TEST(ModbusFrame, TestExceptions) {
+    uint8_t pdu[PDU_MAX_LENGTH];
+    uint8_t custom[] = { 0x41, 0x01, 0x02 };
+    ModbusPdu_t request;
+    ModbusPdu_t response;
+
+    ASSERT_EQ(pduException(pdu, PDU_READ_INPUT_REGISTERS, PDU_ILLEGAL_DATA_ADDRESS), 2);
+    EXPECT_EQ(pdu[0], 0x84);
+
+    ASSERT_EQ(pduParseResponse(pdu, 2, &response), 0);
+    EXPECT_EQ(response.function, PDU_READ_INPUT_REGISTERS);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_DATA_ADDRESS);
+
+    pduReadRequest(pdu, PDU_READ_INPUT_REGISTERS, 0, 1);
+    pduParseRequest(pdu, 5, &request);
+    EXPECT_TRUE(pduResponseMatches(&request, &response));
+
+    // Unknown functions are refused by a slave, but their payload is still there for custom handling
+    EXPECT_EQ(pduParseRequest(custom, sizeof(custom), &request), PDU_ILLEGAL_FUNCTION);
+    EXPECT_EQ(request.function, 0x41);
+    EXPECT_EQ(request.data, &custom[1]);
+    EXPECT_EQ(request.size, 2);
+    EXPECT_EQ(pduParseRequest(custom, 0, &request), PDU_ILLEGAL_DATA_VALUE);
+}
+
+TEST(ModbusFrame, TestRtu) {
+    uint8_t adu[RTU_MAX_LENGTH];
+    uint8_t slaveId = 0;
+
+    // Built in place, then framed
+    ASSERT_EQ(pduReadRequest(RTU_PDU(adu), PDU_READ_HOLDING_REGISTERS, 0, 10), 5);
+    ASSERT_EQ(rtuFrame(adu, 1, 5), sizeof(READ_ADU));
+    EXPECT_EQ(memcmp(adu, READ_ADU, sizeof(READ_ADU)), 0);
+
+    EXPECT_EQ(rtuParse(adu, sizeof(READ_ADU), &slaveId), 5);
+    EXPECT_EQ(slaveId, 1);
+
+    adu[3] ^= 0x01;
+    EXPECT_EQ(rtuParse(adu, sizeof(READ_ADU), &slaveId), -1);
+    EXPECT_EQ(rtuParse(adu, RTU_MIN_LENGTH - 1, &slaveId), -1);
+}
+
+TEST(ModbusFrame, TestRtuLengths) {
+    uint8_t adu[RTU_MAX_LENGTH];
+    uint16_t values[10] = { 0 };
+
+    // Every length is known from the first bytes, before the rest arrive
+    size_t length = rtuFrame(adu, 1, pduWriteRegistersRequest(RTU_PDU(adu), 0, 10, values));
+    EXPECT_EQ(rtuRequestLength(adu, 1), 0);
+    EXPECT_EQ(rtuRequestLength(adu, 6), 0);
+    EXPECT_EQ(rtuRequestLength(adu, 7), (int) length);
+    EXPECT_EQ(rtuRequestLength(READ_ADU, 2), (int) sizeof(READ_ADU));
+
+    length = rtuFrame(adu, 1, pduReadRegistersResponse(RTU_PDU(adu), PDU_READ_INPUT_REGISTERS, 10, values));
+    EXPECT_EQ(rtuResponseLength(adu, 2), 0);
+    EXPECT_EQ(rtuResponseLength(adu, 3), (int) length);
+
+    length = rtuFrame(adu, 1, pduException(RTU_PDU(adu), PDU_READ_INPUT_REGISTERS, PDU_SERVER_DEVICE_FAILURE));
+    EXPECT_EQ(rtuResponseLength(adu, 2), (int) length);
+
+    adu[1] = 0x41;
+    EXPECT_EQ(rtuRequestLength(adu, 2), -1);
+    EXPECT_EQ(rtuResponseLength(adu, 2), -1);
+}
@@ -0,0 +1,70 @@
+/*
+ * File: ModbusGroupsTests.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "gtest/gtest.h"
+
+#include "ModbusGroups.h"
+
+TEST(ModbusGroups, TestPackCommand) {
+    GroupCommand_t command = { 0x0005, 42, 75, 50, 2 };
+    uint16_t registers[GROUP_REGISTER_COUNT] = { 0 };
+
+    packGroupCommand(&command, &registers[GROUP_MASK]);
+
+    // Membership and the applied sequence belong to the device, a broadcast never touches them
+    EXPECT_EQ(registers[GROUP_MEMBERSHIP], 0);
+    EXPECT_EQ(registers[GROUP_APPLIED], 0);
+    EXPECT_EQ(registers[GROUP_MASK], 0x0005);
+    EXPECT_EQ(registers[GROUP_SEQUENCE], 42);
+    EXPECT_EQ(registers[GROUP_LEVEL], 75);
+    EXPECT_EQ(registers[GROUP_RAMP_TIME], 50);
+    EXPECT_EQ(registers[GROUP_RAMP_CURVE], 2);
+}
+
+TEST(ModbusGroups, TestBlockLayout) {
+    static_assert(GROUP_COMMAND_REGISTERS == 5, "The mask, sequence, level, ramp time and curve");
+    static_assert(GROUP_REGISTER(GROUP_MASK) + GROUP_COMMAND_REGISTERS == GROUP_REGISTER(GROUP_REGISTER_COUNT), "The command ends the block");
+}
+
+TEST(ModbusGroups, TestMembership) {
+    EXPECT_TRUE(inGroups(0x0001, GROUP_ALL));
+    EXPECT_TRUE(inGroups(0x0006, 0x0004));
+    EXPECT_FALSE(inGroups(0x0006, 0x0001));
+    // A device in no group ignores every command
+    EXPECT_FALSE(inGroups(0, GROUP_ALL));
+}
+
+TEST(ModbusGroups, TestSequenceSkipsZero) {
+    EXPECT_EQ(nextGroupSequence(0), 1);
+    EXPECT_EQ(nextGroupSequence(41), 42);
+    EXPECT_EQ(nextGroupSequence(UINT16_MAX), 1);
+}
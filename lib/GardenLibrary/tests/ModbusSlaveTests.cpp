@@ -0,0 +1,241 @@
+/*
+ * File: ModbusSlaveTests.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "LightRamp.h"
+#include "ModbusSlave.h"
+
+#define TEST_SLAVE_ID 3
+#define TEST_INPUT_REGISTERS 10
+#define TEST_HOLDING_REGISTERS 4
+#define TEST_DISCRETE_INPUTS 2
+
+class ModbusSlaveTest : public ::testing::Test {
+protected:
+    ModbusSlave slave;
+    uint16_t inputRegisters[TEST_INPUT_REGISTERS];
+    uint16_t holdingRegisters[TEST_HOLDING_REGISTERS];
+    uint16_t groupRegisters[GROUP_REGISTER_COUNT];
+    uint8_t discreteInputs[TEST_DISCRETE_INPUTS];
+    uint8_t frame[RTU_MAX_LENGTH];
+
+    void SetUp() override {
+        memset(inputRegisters, 0, sizeof(inputRegisters));
+        memset(holdingRegisters, 0, sizeof(holdingRegisters));
+        memset(groupRegisters, 0, sizeof(groupRegisters));
+        memset(discreteInputs, 0, sizeof(discreteInputs));
+
+        slave.setSlaveId(TEST_SLAVE_ID);
+        ASSERT_EQ(slave.addInputRegisters(0, inputRegisters, TEST_INPUT_REGISTERS), 0);
+        ASSERT_EQ(slave.addHoldingRegisters(0, holdingRegisters, TEST_HOLDING_REGISTERS), 0);
+        ASSERT_EQ(slave.addHoldingRegisters(GROUP_REGISTERS_ADDRESS, groupRegisters, GROUP_REGISTER_COUNT), 0);
+        ASSERT_EQ(slave.addDiscreteInputs(0, discreteInputs, TEST_DISCRETE_INPUTS), 0);
+    }
+
+    // Sends a request PDU built at RTU_PDU(frame), and parses the response into it
+    int request(uint8_t slaveId, int pduLength, ModbusPdu_t* response) {
+        uint8_t id;
+        size_t length = slave.process(frame, rtuFrame(frame, slaveId, pduLength));
+
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        int responseLength = rtuParse(frame, length, &id);
+
+        EXPECT_EQ(id, TEST_SLAVE_ID);
+        EXPECT_EQ(pduParseResponse(RTU_PDU(frame), responseLength, response), 0);
+
+        return length;
+    }
+};
+
+TEST_F(ModbusSlaveTest, TestAccessors) {
+    EXPECT_TRUE(slave.Ireg(5, 1234));
+    EXPECT_EQ(inputRegisters[5], 1234);
+    EXPECT_EQ(slave.Ireg(5), 1234);
+
+    // Writes go straight to the arrays of the device
+    holdingRegisters[2] = 42;
+    EXPECT_EQ(slave.Hreg(2), 42);
+    EXPECT_TRUE(slave.Hreg(GROUP_REGISTER(GROUP_LEVEL), 80));
+    EXPECT_EQ(groupRegisters[GROUP_LEVEL], 80);
+
+    EXPECT_TRUE(slave.Ists(1, true));
+    EXPECT_TRUE(slave.Ists(1));
+    EXPECT_FALSE(slave.Ists(0));
+
+    // Registers that are not served read as 0 and ignore writes, as ModbusSerial did
+    EXPECT_FALSE(slave.Ireg(TEST_INPUT_REGISTERS, 1));
+    EXPECT_EQ(slave.Ireg(TEST_INPUT_REGISTERS), 0);
+    EXPECT_FALSE(slave.Hreg(TEST_HOLDING_REGISTERS, 1));
+    EXPECT_FALSE(slave.Hreg(GROUP_REGISTERS_ADDRESS - 1, 1));
+    EXPECT_FALSE(slave.Hreg(GROUP_REGISTER(GROUP_REGISTER_COUNT), 1));
+    EXPECT_FALSE(slave.Ists(TEST_DISCRETE_INPUTS));
+}
+
+TEST_F(ModbusSlaveTest, TestAddBlock) {
+    uint16_t registers[4];
+
+    // Overlapping blocks, and more than the table has room for
+    EXPECT_EQ(slave.addInputRegisters(TEST_INPUT_REGISTERS - 1, registers, 4), -1);
+    EXPECT_EQ(slave.addHoldingRegisters(300, registers, 4), -1);
+    EXPECT_EQ(slave.addInputRegisters(100, registers, 0), -1);
+    EXPECT_EQ(slave.addInputRegisters(UINT16_MAX, registers, 2), -1);
+    EXPECT_EQ(slave.addInputRegisters(TEST_INPUT_REGISTERS, registers, 4), 0);
+
+    registers[0] = 7;
+    EXPECT_EQ(slave.Ireg(TEST_INPUT_REGISTERS), 7);
+}
+
+TEST_F(ModbusSlaveTest, TestReadRegisters) {
+    ModbusPdu_t response;
+
+    for (int i = 0; i < TEST_INPUT_REGISTERS; i++)
+    {
+        inputRegisters[i] = 0x100 + i;
+    }
+
+    ASSERT_EQ(request(TEST_SLAVE_ID, pduReadRequest(RTU_PDU(frame), PDU_READ_INPUT_REGISTERS, 2, 6), &response), 3 + 2 + 6 * 2);
+    EXPECT_EQ(response.function, PDU_READ_INPUT_REGISTERS);
+    EXPECT_EQ(response.exception, 0);
+    ASSERT_EQ(response.count, 6);
+
+    for (int i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(pduRegister(&response, i), 0x102 + i);
+    }
+
+    holdingRegisters[3] = 0xBEEF;
+    ASSERT_GT(request(TEST_SLAVE_ID, pduReadRequest(RTU_PDU(frame), PDU_READ_HOLDING_REGISTERS, 0, TEST_HOLDING_REGISTERS), &response), 0);
+    ASSERT_EQ(response.count, TEST_HOLDING_REGISTERS);
+    EXPECT_EQ(pduRegister(&response, 3), 0xBEEF);
+}
+
+TEST_F(ModbusSlaveTest, TestReadDiscreteInputs) {
+    ModbusPdu_t response;
+
+    discreteInputs[1] = 1;
+
+    ASSERT_GT(request(TEST_SLAVE_ID, pduReadRequest(RTU_PDU(frame), PDU_READ_DISCRETE_INPUTS, 0, TEST_DISCRETE_INPUTS), &response), 0);
+    EXPECT_EQ(response.exception, 0);
+    EXPECT_FALSE(pduBit(&response, 0));
+    EXPECT_TRUE(pduBit(&response, 1));
+}
+
+TEST_F(ModbusSlaveTest, TestWriteRegisters) {
+    uint16_t values[] = { 50, 20, 1 };
+    ModbusPdu_t response;
+
+    ASSERT_GT(request(TEST_SLAVE_ID, pduWriteSingle(RTU_PDU(frame), PDU_WRITE_SINGLE_REGISTER, 3, 0x1234), &response), 0);
+    EXPECT_EQ(response.exception, 0);
+    EXPECT_EQ(response.address, 3);
+    EXPECT_EQ(response.value, 0x1234);
+    EXPECT_EQ(holdingRegisters[3], 0x1234);
+
+    ASSERT_GT(request(TEST_SLAVE_ID, pduWriteRegistersRequest(RTU_PDU(frame), 0, 3, values), &response), 0);
+    EXPECT_EQ(response.function, PDU_WRITE_MULTIPLE_REGISTERS);
+    EXPECT_EQ(response.address, 0);
+    EXPECT_EQ(response.count, 3);
+    EXPECT_EQ(holdingRegisters[0], 50);
+    EXPECT_EQ(holdingRegisters[1], 20);
+    EXPECT_EQ(holdingRegisters[2], 1);
+    EXPECT_EQ(holdingRegisters[3], 0x1234);
+}
+
+TEST_F(ModbusSlaveTest, TestExceptions) {
+    uint16_t values[2] = { 1, 2 };
+    ModbusPdu_t response;
+
+    // Past the end of a block, and across the gap between two
+    ASSERT_GT(request(TEST_SLAVE_ID, pduReadRequest(RTU_PDU(frame), PDU_READ_INPUT_REGISTERS, 8, 3), &response), 0);
+    EXPECT_EQ(response.function, PDU_READ_INPUT_REGISTERS);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_DATA_ADDRESS);
+
+    ASSERT_GT(request(TEST_SLAVE_ID, pduWriteRegistersRequest(RTU_PDU(frame), GROUP_REGISTERS_ADDRESS - 1, 2, values), &response), 0);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_DATA_ADDRESS);
+    EXPECT_EQ(groupRegisters[0], 0);
+
+    // Input registers cannot be written
+    ASSERT_GT(request(TEST_SLAVE_ID, pduWriteSingle(RTU_PDU(frame), PDU_WRITE_SINGLE_REGISTER, TEST_HOLDING_REGISTERS, 1), &response), 0);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_DATA_ADDRESS);
+
+    ASSERT_GT(request(TEST_SLAVE_ID, pduReadRequest(RTU_PDU(frame), PDU_READ_COILS, 0, 1), &response), 0);
+    EXPECT_EQ(response.function, PDU_READ_COILS);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_FUNCTION);
+
+    RTU_PDU(frame)[0] = 0x2B;
+    ASSERT_GT(request(TEST_SLAVE_ID, 1, &response), 0);
+    EXPECT_EQ(response.exception, PDU_ILLEGAL_FUNCTION);
+}
+
+TEST_F(ModbusSlaveTest, TestIgnoredFrames) {
+    size_t length;
+
+    // Another slave
+    length = rtuFrame(frame, TEST_SLAVE_ID + 1, pduWriteSingle(RTU_PDU(frame), PDU_WRITE_SINGLE_REGISTER, 0, 1));
+    EXPECT_EQ(slave.process(frame, length), 0u);
+    EXPECT_EQ(holdingRegisters[0], 0);
+
+    // A corrupted frame
+    length = rtuFrame(frame, TEST_SLAVE_ID, pduWriteSingle(RTU_PDU(frame), PDU_WRITE_SINGLE_REGISTER, 0, 1));
+    frame[4] ^= 0x01;
+    EXPECT_EQ(slave.process(frame, length), 0u);
+    EXPECT_EQ(holdingRegisters[0], 0);
+
+    EXPECT_EQ(slave.process(frame, 3), 0u);
+}
+
+TEST_F(ModbusSlaveTest, TestBroadcast) {
+    GroupCommand_t command = { 0x0003, 9, 75, 20, RAMP_SMOOTH };
+    uint16_t registers[GROUP_COMMAND_REGISTERS];
+    size_t length;
+
+    packGroupCommand(&command, registers);
+
+    // Acted on without a reply, from the group broadcast id and the standard one
+    length = rtuFrame(frame, GROUP_BROADCAST_ID, pduWriteRegistersRequest(RTU_PDU(frame), GROUP_REGISTER(GROUP_MASK), GROUP_COMMAND_REGISTERS, registers));
+    EXPECT_EQ(slave.process(frame, length), 0u);
+    EXPECT_EQ(slave.Hreg(GROUP_REGISTER(GROUP_SEQUENCE)), 9);
+    EXPECT_EQ(slave.Hreg(GROUP_REGISTER(GROUP_LEVEL)), 75);
+    EXPECT_EQ(slave.Hreg(GROUP_REGISTER(GROUP_RAMP_CURVE)), RAMP_SMOOTH);
+
+    length = rtuFrame(frame, SLAVE_BROADCAST_ID, pduWriteSingle(RTU_PDU(frame), PDU_WRITE_SINGLE_REGISTER, 1, 5));
+    EXPECT_EQ(slave.process(frame, length), 0u);
+    EXPECT_EQ(holdingRegisters[1], 5);
+}
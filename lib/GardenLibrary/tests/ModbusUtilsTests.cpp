@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+#include "ModbusUtils.h"
+
+enum TEST_REGISTERS {
+    TEST_FIRST,
+    STRING_REGISTER(TEST_STRING, 11),
+    TEST_LAST,
+    TOTAL_TEST_REGISTERS
+};
+
+static uint16_t testRegisters[TOTAL_TEST_REGISTERS];
+
+static void writeTestRegister(int address, uint16_t value)
+{
+    testRegisters[address] = value;
+}
+
+TEST(ModbusUtils, TestStringRegisterSpans) {
+    static_assert(STRING_REGISTERS(0) == 0, "Empty strings need no registers");
+    static_assert(STRING_REGISTERS(1) == 1, "Odd lengths round up");
+    static_assert(STRING_REGISTERS(12) == 6, "Two characters a register");
+    static_assert(STRING_REGISTER_COUNT(TEST_STRING) == 6, "Spans cover the whole string");
+    static_assert(TEST_LAST == TEST_STRING_END + 1, "Registers after a span follow it");
+}
+
+TEST(ModbusUtils, TestPackStringRegister) {
+    EXPECT_EQ(packStringRegister("HQ2", 3, 0), ('H' << 8) | 'Q');
+    EXPECT_EQ(packStringRegister("HQ2", 3, 1), '2' << 8);
+    EXPECT_EQ(packStringRegister("HQ2", 3, 2), 0);
+}
+
+TEST(ModbusUtils, TestStringRegisterRoundTrip) {
+    const char* serial = "HQ21094NFGX";
+    char buffer[16];
+
+    memset(testRegisters, 0xFF, sizeof(testRegisters));
+    WRITE_STRING_REGISTER(writeTestRegister, TEST_STRING, serial, strlen(serial));
+
+    // The span is zero padded, and neighbouring registers are untouched
+    EXPECT_EQ(testRegisters[TEST_STRING_END], 'X' << 8);
+    EXPECT_EQ(testRegisters[TEST_FIRST], 0xFFFF);
+    EXPECT_EQ(testRegisters[TEST_LAST], 0xFFFF);
+
+    EXPECT_EQ(unpackStringRegisters(&testRegisters[TEST_STRING], STRING_REGISTER_COUNT(TEST_STRING), buffer, sizeof(buffer)), 11u);
+    EXPECT_STREQ(buffer, serial);
+
+    // Shorter strings clear the rest of the span
+    WRITE_STRING_REGISTER(writeTestRegister, TEST_STRING, "159", 3);
+    EXPECT_EQ(unpackStringRegisters(&testRegisters[TEST_STRING], STRING_REGISTER_COUNT(TEST_STRING), buffer, sizeof(buffer)), 3u);
+    EXPECT_STREQ(buffer, "159");
+}
+
+TEST(ModbusUtils, TestUnpackTruncatesToBuffer) {
+    uint16_t registers[] = { ('0' << 8) | 'x', ('A' << 8) | '0', ('5' << 8) | '3' };
+    char buffer[5];
+
+    EXPECT_EQ(unpackStringRegisters(registers, 3, buffer, sizeof(buffer)), 4u);
+    EXPECT_STREQ(buffer, "0xA0");
+    EXPECT_EQ(unpackStringRegisters(registers, 0, buffer, sizeof(buffer)), 0u);
+    EXPECT_STREQ(buffer, "");
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include "Units.h"
+#include "VictronLabels.h"
+
+// Conversions must resolve at compile time
+static_assert(Millivolts(12850).as<-2>().raw() == 1285, "Millivolts to Centivolts");
+static_assert(Centivolts(1285).as<-3>() == Millivolts(12850), "Centivolts to Millivolts");
+static_assert(CentiKilowattHours(123).as<-3>().raw() == 1230, "CentiKilowattHours to WattHours");
+static_assert(Millivolts(0).unit() == UNIT_VOLT && Millivolts::exponent() == -3, "Millivolts type");
+
+TEST(Units, TestRescaleRounding) {
+    EXPECT_EQ(rescale(12345, -3, -2), 1235);
+    EXPECT_EQ(rescale(12344, -3, -2), 1234);
+    EXPECT_EQ(rescale(-12345, -3, -2), -1235);
+    EXPECT_EQ(rescale(-12344, -3, -2), -1234);
+    EXPECT_EQ(rescale(1500, -3, 0), 2);
+    EXPECT_EQ(rescale(7, 0, -3), 7000);
+    EXPECT_EQ(rescale(7, -1, -1), 7);
+}
+
+TEST(Units, TestQuantityArithmetic) {
+    Milliamps charge(2500);
+    Milliamps load(-750);
+
+    EXPECT_EQ((charge + load).raw(), 1750);
+    EXPECT_EQ((charge - load).raw(), 3250);
+    EXPECT_TRUE(load < charge);
+    EXPECT_EQ(Deciamps(25).as<-3>(), charge);
+    EXPECT_DOUBLE_EQ(charge.toDouble(), 2.5);
+    EXPECT_DOUBLE_EQ(CentiKilowattHours(1234).toDouble(), 12.34);
+}
+
+TEST(Units, TestConvertRegisters) {
+    // A snapshot laid out like the GardenShed input registers
+    const uint16_t registers[] = { 0x0000, 0x3232, 0xFD12, 0x0085, 0x0001, 0x0003 };
+    const RegisterUnit_t map[] PROGMEM = {
+        { 0, REGISTER_INT32, UNIT_VOLT, -3 },
+        { 2, REGISTER_INT16, UNIT_AMP, -3 },
+        { 3, REGISTER_UINT16, UNIT_WATT, 0 },
+        { 5, REGISTER_UINT16, UNIT_KILOWATT_HOUR, -2 }
+    };
+    Measurement_t measurements[4];
+
+    ASSERT_EQ(convertRegisters(registers, 6, map, 4, measurements), 4);
+
+    EXPECT_EQ(measurementAs<Millivolts>(measurements[0]).raw(), 12850);
+    EXPECT_EQ(measurementAs(measurements[0], -2), 1285);
+    EXPECT_EQ(measurementAs<Milliamps>(measurements[1]).raw(), -750);
+    EXPECT_EQ(measurementAs<Watts>(measurements[2]).raw(), 133);
+    EXPECT_EQ(measurements[3].unit, UNIT_KILOWATT_HOUR);
+    EXPECT_EQ(measurementAs<WattHours>(measurements[3]).raw(), 30);
+
+    // The map must not address past the snapshot
+    EXPECT_EQ(convertRegisters(registers, 5, map, 4, measurements), -1);
+}
+
+TEST(Units, TestVictronFieldMeasurement) {
+    Measurement_t measurement;
+    int32_t voltage = 12800;
+    int32_t current = -1500;
+    int16_t yield = 42;
+    uint8_t state = 252;
+    bool load = true;
+
+    ASSERT_EQ(victronFieldMeasurement(VOLTAGE, &voltage, &measurement), 0);
+    EXPECT_EQ(measurementAs<Centivolts>(measurement).raw(), 1280);
+
+    ASSERT_EQ(victronFieldMeasurement(CURRENT, &current, &measurement), 0);
+    EXPECT_EQ(measurementAs<Deciamps>(measurement).raw(), -15);
+
+    ASSERT_EQ(victronFieldMeasurement(YIELD_TODAY, &yield, &measurement), 0);
+    EXPECT_EQ(measurementAs<WattHours>(measurement).raw(), 420);
+
+    ASSERT_EQ(victronFieldMeasurement(OPERATION_STATE, &state, &measurement), 0);
+    EXPECT_EQ(measurement.value, 252);
+
+    ASSERT_EQ(victronFieldMeasurement(LOAD, &load, &measurement), 0);
+    EXPECT_EQ(measurement.value, 1);
+
+    EXPECT_EQ(victronFieldMeasurement(SERIAL_NUMBER, "HQ1234", &measurement), -1);
+    EXPECT_EQ(victronFieldMeasurement(VICTRON_LABEL_COUNT, &voltage, &measurement), -1);
+}
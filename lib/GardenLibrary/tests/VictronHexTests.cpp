@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "VictronTests.h"
+#include "VictronHex.h"
+
+/**
+ * @brief Encodes a frame into a string
+ */
+inline std::string encode(uint8_t command, std::initializer_list<uint8_t> payload)
+{
+    char buffer[64];
+    std::vector<uint8_t> bytes(payload);
+    int length = victronHexEncode(command, bytes.data(), bytes.size(), buffer, sizeof(buffer));
+    EXPECT_GT(length, 0);
+    return std::string(buffer, length);
+}
+
+TEST(VictronHex, TestEncodeKnownFrames) {
+    char buffer[VICTRON_HEX_MAX_FRAME_LENGTH];
+
+    // Examples from the VE.Direct HEX protocol documentation
+    EXPECT_EQ(encode(VICTRON_HEX_PING, {}), ":154\n");
+    EXPECT_EQ(encode(VICTRON_HEX_APP_VERSION, {}), ":352\n");
+
+    int length = victronHexEncodeGet(0xEDF0, buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(buffer, length), ":7F0ED0071\n");
+
+    length = victronHexEncodeSet(0xEDF0, 0x0096, 2, buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(buffer, length), ":8F0ED009600DA\n");
+}
+
+TEST(VictronHex, TestEncodeRejectsSmallBuffers) {
+    char buffer[VICTRON_HEX_MAX_FRAME_LENGTH];
+
+    EXPECT_EQ(victronHexEncodeGet(0xEDF0, buffer, 10), -1);
+    EXPECT_EQ(victronHexEncodeSet(0xEDF0, 1, 5, buffer, sizeof(buffer)), -1);
+    EXPECT_GT(victronHexEncodeSet(0xEDF0, 0xFFFFFFFF, 4, buffer, sizeof(buffer)), 0);
+}
+
+TEST(VictronHex, TestParseGetResponse) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string input = ":7F0ED009600DB\n";
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    ASSERT_EQ(handler.getHexCount(), 1);
+    VictronHexFrame_t frame = handler.getHexFrame();
+    EXPECT_EQ(frame.command, VICTRON_HEX_GET);
+    EXPECT_EQ(frame.address, 0xEDF0);
+    EXPECT_EQ(frame.flags, 0);
+    EXPECT_EQ(frame.size, 2);
+    EXPECT_EQ(victronHexValue(&frame), 0x0096u);
+}
+
+TEST(VictronHex, TestParsePingResponse) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string input = ":51641F9\n";
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    ASSERT_EQ(handler.getHexCount(), 1);
+    VictronHexFrame_t frame = handler.getHexFrame();
+    EXPECT_EQ(frame.command, VICTRON_HEX_PING_RESPONSE);
+    EXPECT_EQ(frame.size, 2);
+    EXPECT_EQ(victronHexValue(&frame), 0x4116u);
+}
+
+TEST(VictronHex, TestRoundTripThroughParser) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    // Async update of the panel power register, lowercase hex is also accepted
+    std::string input = encode(VICTRON_HEX_ASYNC, { 0xbc, 0xed, 0x00, 0x78, 0x56, 0x34, 0x12 });
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    ASSERT_EQ(handler.getHexCount(), 1);
+    VictronHexFrame_t frame = handler.getHexFrame();
+    EXPECT_EQ(frame.command, VICTRON_HEX_ASYNC);
+    EXPECT_EQ(frame.address, 0xEDBC);
+    EXPECT_EQ(victronHexValue(&frame), 0x12345678u);
+}
+
+TEST(VictronHex, TestInvalidFramesAreDropped) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    const char* inputs[] = {
+        ":7F0ED009600DC\n",     // Bad checksum
+        ":7F0ED009600D\n",      // Odd number of nibbles
+        ":7F0ED00G600DB\n",     // Invalid character
+        ":\n",                  // Empty
+    };
+
+    for (const char* input : inputs)
+    {
+        victronSerial.parse(input, strlen(input));
+    }
+
+    EXPECT_EQ(handler.getHexCount(), 0);
+}
+
+TEST(VictronHex, TestFramesInterleavedWithText) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string block = withChecksum("\r\nV\t12800\r\nPPV\t35\r\nChecksum\t");
+    // HEX frames are sent between text blocks and are not part of the text checksum
+    std::string input = ":51641F9\n" + block + ":7F0ED009600DB\n" + block;
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getHexCount(), 2);
+    EXPECT_EQ(handler.getCount(), 4);
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 12800);
+    EXPECT_EQ(handler.get<int16_t>(PANEL_POWER), 35);
+}
+
+TEST(VictronHex, TestFramesInsideText) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string frame = ":7F0ED009600DB\n";
+    std::string block = withChecksum("\r\nV\t12800\r\nSER#\tHQ21094NFGX\r\nPPV\t35\r\nChecksum\t");
+    std::string input = block;
+
+    // Async frames can be sent at any point, including in the middle of a value, a label or a string
+    input.insert(input.find("SER#") + 2, frame);
+    input.insert(input.find("12800") + 3, frame);
+    input.insert(input.find("HQ21") + 4, frame);
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    ASSERT_EQ(handler.getHexCount(), 3);
+    VictronHexFrame_t hex = handler.getHexFrame();
+    EXPECT_EQ(hex.address, 0xEDF0);
+    EXPECT_EQ(victronHexValue(&hex), 0x0096u);
+
+    EXPECT_EQ(handler.getCount(), 3);
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 12800);
+    EXPECT_EQ(handler.getString(SERIAL_NUMBER), "HQ21094NFGX");
+    EXPECT_EQ(handler.get<int16_t>(PANEL_POWER), 35);
+
+    VictronStatistics_t statistics = victronSerial.getStatistics();
+    EXPECT_EQ(statistics.blocks, 1u);
+    EXPECT_EQ(statistics.blocksLost, 0u);
+}
+
+TEST(VictronHex, TestFunctionHandler) {
+    static int frames;
+    VictronParser victronSerial;
+    std::string input = ":154\n:51641F9\n";
+
+    frames = 0;
+    victronSerial.setHexHandler([] (VictronHexFrame_t* frame) { frames++; });
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(frames, 2);
+}
@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #include <sys/types.h>
 #include <signal.h>
@@ -68,10 +69,294 @@ TEST(VictronSerial, TestClassHandlerPayload) {
         .productId = "0xA053",
         .firmware = "159",
         .serial = "HQ21094NFGX",
+        .offReason = 0,
     });
 
     victronSerial.parse(TEST_INPUT_1, sizeof(TEST_INPUT_1));
 
     // Matching the number of fields processed matches
-    EXPECT_EQ(handler->getCount(), 18);
-}
\ No newline at end of file
+    EXPECT_EQ(handler->getCount(), 19);
+
+    delete handler;
+}
+
+TEST(VictronLabels, TestEveryLabelResolves) {
+    const char* labels[] = {
+        "V", "V2", "V3", "VS", "VM", "DM", "VPV", "PPV", "I", "I2", "I3", "IL", "LOAD", "T", "P", "CE", "SOC", "TTG",
+        "Alarm", "Relay", "AR", "OR", "H1", "H2", "H3", "H4", "H5", "H6", "H7", "H8", "H9", "H10", "H11", "H12", "H13",
+        "H14", "H15", "H16", "H17", "H18", "H19", "H20", "H21", "H22", "H23", "ERR", "CS", "BMV", "FW", "FWE", "PID",
+        "SER#", "HSDS", "MODE", "AC_OUT_V", "AC_OUT_I", "AC_OUT_S", "WARN", "MPPT", "MON", "DC_IN_V", "DC_IN_I",
+        "DC_IN_P", "Checksum"
+    };
+    VictronLabel_t label;
+
+    ASSERT_EQ(sizeof(labels) / sizeof(labels[0]), (size_t) VICTRON_LABEL_COUNT);
+
+    for (int id = 0; id < VICTRON_LABEL_COUNT; id++)
+    {
+        EXPECT_EQ(victronFindLabel(labels[id], &label), id) << "Label " << labels[id] << " did not resolve";
+    }
+
+    EXPECT_EQ(victronFindLabel("VPV", &label), PANEL_VOLTAGE);
+    EXPECT_EQ(label.type, VICTRON_INT32);
+    EXPECT_EQ(label.unit, UNIT_VOLT);
+    EXPECT_EQ(label.scale, -3);
+}
+
+TEST(VictronLabels, TestUnknownLabels) {
+    VictronLabel_t label;
+
+    EXPECT_EQ(victronFindLabel("", &label), -1);
+    EXPECT_EQ(victronFindLabel("X", &label), -1);
+    EXPECT_EQ(victronFindLabel("H24", &label), -1);
+    EXPECT_EQ(victronFindLabel("Checksu", &label), -1);
+    EXPECT_EQ(victronFindLabel("AC_OUT_VV", &label), -1);
+    EXPECT_EQ(victronFindLabel("v", &label), -1);
+}
+
+TEST(VictronSerial, TestBatteryMonitorPayload) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string input = withChecksum(TEST_BMV_BLOCK);
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getCount(), 16);
+    EXPECT_EQ(handler.getString(PRODUCT_ID), "0x203");
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 26201);
+    EXPECT_EQ(handler.get<int32_t>(STARTER_VOLTAGE), 13104);
+    EXPECT_EQ(handler.get<int32_t>(CURRENT), -3480);
+    EXPECT_EQ(handler.get<int32_t>(INSTANTANEOUS_POWER), -91);
+    EXPECT_EQ(handler.get<int32_t>(CONSUMED_AMP_HOURS), -7200);
+    EXPECT_EQ(handler.get<int16_t>(STATE_OF_CHARGE), 876);
+    EXPECT_EQ(handler.get<int16_t>(TIME_TO_GO), 1230);
+    EXPECT_EQ(handler.get<bool>(ALARM), false);
+    EXPECT_EQ(handler.get<bool>(RELAY), true);
+    EXPECT_EQ(handler.get<int16_t>(ALARM_REASON), 0);
+    EXPECT_EQ(handler.getString(BMV_MODEL), "700");
+    EXPECT_EQ(handler.getString(FIRMWARE), "0308");
+    EXPECT_EQ(handler.get<int32_t>(DEEPEST_DISCHARGE), -102345);
+    EXPECT_EQ(handler.get<int32_t>(SINCE_FULL_CHARGE), 86400);
+    EXPECT_EQ(handler.get<int32_t>(DISCHARGED_ENERGY), 4567);
+}
+
+TEST(VictronSerial, TestInverterPayload) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string input = withChecksum(TEST_PHOENIX_BLOCK);
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getCount(), 11);
+    EXPECT_EQ(handler.get<int8_t>(DEVICE_MODE), 2);
+    EXPECT_EQ(handler.get<uint8_t>(OPERATION_STATE), 9);
+    EXPECT_EQ(handler.get<int16_t>(AC_OUT_VOLTAGE), 23002);
+    EXPECT_EQ(handler.get<int16_t>(AC_OUT_CURRENT), 14);
+    EXPECT_EQ(handler.get<int16_t>(AC_OUT_APPARENT_POWER), 322);
+    EXPECT_EQ(handler.get<int16_t>(WARNING_REASON), 0);
+    EXPECT_EQ(handler.get<uint32_t>(OFF_REASON), 4u);
+}
+
+TEST(VictronSerial, TestWideValues) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    // Currents past 32.767 A, a lifetime yield past 327.67 kWh and a charger state above 127
+    std::string input = withChecksum("\r\nPID\t0xA057\r\nI\t-45000\r\nIL\t45000\r\nH19\t40000\r\nCS\t252\r\nChecksum\t");
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getCount(), 5);
+    EXPECT_EQ(handler.get<int32_t>(CURRENT), -45000);
+    EXPECT_EQ(handler.get<int32_t>(LOAD_CURRENT), 45000);
+    EXPECT_EQ(handler.get<int32_t>(YIELD_TOTAL), 40000);
+    EXPECT_EQ(handler.get<uint8_t>(OPERATION_STATE), 252);
+}
+
+TEST(VictronSerial, TestChecksumByteMatchesControlCharacter) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    // Pad an unknown field so the checksum byte becomes a carriage return
+    std::string block = "\r\nV\t12000\r\nXX\t";
+    std::string tail = "\r\nChecksum\t";
+    char pad = withChecksum(block + tail).back() - '\r';
+    std::string input = withChecksum(block + pad + tail);
+    ASSERT_EQ(input.back(), '\r');
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getCount(), 1);
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 12000);
+}
+
+TEST(VictronSerial, TestInterleavedStreams) {
+    RecordingHandler chargerHandler, monitorHandler, inverterHandler;
+    VictronParser charger((VictronFieldHandler *) &chargerHandler);
+    VictronParser monitor((VictronFieldHandler *) &monitorHandler);
+    VictronParser inverter((VictronFieldHandler *) &inverterHandler);
+    std::string chargerInput = std::string(TEST_INPUT_1, sizeof(TEST_INPUT_1) - 1);
+    std::string monitorInput = withChecksum(TEST_BMV_BLOCK);
+    std::string inverterInput = withChecksum(TEST_PHOENIX_BLOCK);
+
+    // Feed each stream a few bytes at a time, so blocks are always split between calls
+    for (size_t index = 0; index < 512; index += 7)
+    {
+        if (index < chargerInput.size())
+        {
+            charger.parse(chargerInput.c_str() + index, std::min((size_t) 7, chargerInput.size() - index));
+        }
+        if (index < monitorInput.size())
+        {
+            monitor.parse(monitorInput.c_str() + index, std::min((size_t) 7, monitorInput.size() - index));
+        }
+        if (index < inverterInput.size())
+        {
+            inverter.parse(inverterInput.c_str() + index, std::min((size_t) 7, inverterInput.size() - index));
+        }
+    }
+
+    EXPECT_EQ(chargerHandler.getCount(), 19);
+    EXPECT_EQ(monitorHandler.getCount(), 16);
+    EXPECT_EQ(inverterHandler.getCount(), 11);
+    EXPECT_EQ(chargerHandler.get<int32_t>(VOLTAGE), 22930);
+    EXPECT_EQ(monitorHandler.get<int32_t>(VOLTAGE), 26201);
+    EXPECT_EQ(inverterHandler.get<int32_t>(VOLTAGE), 12840);
+    EXPECT_EQ(chargerHandler.getString(SERIAL_NUMBER), "HQ21094NFGX");
+}
+
+TEST(VictronSerial, TestFootprint) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string input = std::string(TEST_INPUT_1, sizeof(TEST_INPUT_1) - 1) + withChecksum(TEST_BMV_BLOCK);
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    VictronFootprint_t footprint = victronSerial.getFootprint();
+
+    EXPECT_EQ(footprint.total, sizeof(VictronParser));
+    EXPECT_EQ(footprint.block, (size_t) VICTRON_BLOCK_SIZE);
+    EXPECT_GT(footprint.blockPeak, (size_t) 0);
+    EXPECT_LE(footprint.blockPeak, footprint.block);
+    // Everything outside of the block is parser state, stream statistics and handler pointers
+    EXPECT_LE(footprint.total - footprint.block, (size_t) 104);
+
+    RecordProperty("ParserBytes", footprint.total);
+    RecordProperty("BlockPeakBytes", footprint.blockPeak);
+}
+
+TEST(VictronSerial, TestBlockOverflowIsDropped) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    // The longest value a field can have, longer ones are dropped before they reach the block
+    std::string value(MAX_FIELD_LENGTH, 'X');
+    // Distinct labels, so nothing in the block is taken as the start of another one
+    std::string block = "\r\nPID\t" + value + "\r\nFW\t" + value + "\r\nSER#\t" + value + "\r\nBMV\t" + value + "\r\nFWE\t" + value;
+    const char* numbers[] = { "VPV", "PPV", "I", "IL", "H19", "H20", "H21", "H22", "H23", "T", "P", "CE" };
+    size_t recordBytes = 5 * (VICTRON_RECORD_HEADER + value.size() + 1);
+
+    for (const char* label : numbers)
+    {
+        block += std::string("\r\n") + label + "\t1000";
+        // At least, before alignment and wider types
+        recordBytes += VICTRON_RECORD_HEADER + sizeof(int16_t);
+    }
+    std::string input = withChecksum(block + "\r\nV\t12000\r\nChecksum\t") + withChecksum(TEST_PHOENIX_BLOCK);
+
+    ASSERT_GT(recordBytes, (size_t) VICTRON_BLOCK_SIZE);
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    VictronStatistics_t statistics = victronSerial.getStatistics();
+    EXPECT_EQ(statistics.blocksOverflowed, 1u);
+    EXPECT_EQ(statistics.blocksLost, 1u);
+    EXPECT_EQ(statistics.blocks, 1u);
+
+    // Only the following block gets through
+    EXPECT_EQ(handler.getCount(), 11);
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 12840);
+}
+
+TEST(VictronSerial, TestEmptyReadsAndUnknownLabels) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    // Unknown labels with long string values are skipped, but still count towards the checksum
+    std::string input = withChecksum(std::string("\r\nXYZ\tHQ21094NFGXHQ21094NFGXHQ21094\r\nV\t12000\r\nChecksum\t"));
+
+    // An empty read must not consume anything
+    victronSerial.parse("\r", 0);
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_EQ(handler.getCount(), 1);
+    EXPECT_EQ(handler.get<int32_t>(VOLTAGE), 12000);
+}
+
+TEST(VictronSerial, TestTruncatedBlockDoesNotPoisonTheNext) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string phoenix = withChecksum(TEST_PHOENIX_BLOCK);
+    std::string bmv = withChecksum(TEST_BMV_BLOCK);
+
+    // Learn the block header from a clean block
+    victronSerial.parse(phoenix.c_str(), phoenix.size());
+    EXPECT_EQ(handler.getCount(), 11);
+
+    // Dropouts cutting a block mid field, mid label and before its checksum byte
+    std::string input = phoenix.substr(0, 40) + bmv + phoenix.substr(0, 52) + bmv + phoenix.substr(0, phoenix.size() - 1) + bmv;
+    victronSerial.parse(input.c_str(), input.size());
+
+    VictronStatistics_t statistics = victronSerial.getStatistics();
+    EXPECT_EQ(statistics.blocks, 4);
+    EXPECT_EQ(statistics.blocksLost, 3);
+    EXPECT_EQ(statistics.bytes, phoenix.size() + input.size());
+    // The last lost block took the first byte of the next block as its checksum
+    EXPECT_EQ(statistics.resyncBytes, bmv.size() - 1);
+    EXPECT_EQ(handler.get<int16_t>(STATE_OF_CHARGE), 876);
+}
+
+TEST(VictronSerial, TestResyncAfterNoiseBetweenBlocks) {
+    RecordingHandler handler;
+    VictronParser victronSerial((VictronFieldHandler *) &handler);
+    std::string phoenix = withChecksum(TEST_PHOENIX_BLOCK);
+    // Starting mid block, with line noise before the next block
+    std::string input = phoenix.substr(30) + "\x13\xf7 garbage\t" + phoenix + "#$%" + phoenix;
+
+    victronSerial.parse(input.c_str(), input.size());
+
+    VictronStatistics_t statistics = victronSerial.getStatistics();
+    EXPECT_EQ(statistics.blocks, 2);
+    EXPECT_EQ(statistics.blocksLost, 1);
+    EXPECT_EQ(statistics.firstBlockBytes, input.size() - phoenix.size() - 3);
+}
+
+TEST(VictronSerial, TestStringViewsPointIntoTheBlock) {
+    static VictronParser* parser;
+    static std::map<uint32_t, std::string> strings;
+    static bool inBlock;
+    std::string input = withChecksum("\r\nPID\t0xA053\r\nFW\t159\r\nSER#\tHQ21094NFGX\r\nV\t12800\r\nChecksum\t");
+    VictronParser victronSerial([] (uint32_t id, void* data, size_t size) {
+        VictronLabel_t label;
+
+        if (victronGetLabel(id, &label) < 0 || label.type != VICTRON_STRING)
+        {
+            return;
+        }
+
+        VictronStringView_t view = victronStringView(data, size);
+
+        // Strings are handed over in place, not copied out of the parser
+        inBlock &= (const uint8_t*) view.data >= (const uint8_t*) parser
+            && (const uint8_t*) view.data + view.length < (const uint8_t*) parser + sizeof(VictronParser);
+        EXPECT_EQ(view.data[view.length], '\0');
+        strings[id] = std::string(view.data, view.length);
+    });
+
+    parser = &victronSerial;
+    strings.clear();
+    inBlock = true;
+    victronSerial.parse(input.c_str(), input.size());
+
+    EXPECT_TRUE(inBlock);
+    ASSERT_EQ(strings.size(), 3u);
+    EXPECT_EQ(strings[PRODUCT_ID], "0xA053");
+    EXPECT_EQ(strings[FIRMWARE], "159");
+    EXPECT_EQ(strings[SERIAL_NUMBER], "HQ21094NFGX");
+}
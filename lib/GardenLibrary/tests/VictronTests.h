@@ -4,12 +4,34 @@
 #define VICTRON
 
 #include <string>
+#include <map>
+#include <cstring>
 #include "gtest/gtest.h"
 #include "VictronParser.h"
 
 // Test value
 const char TEST_INPUT_1[] = "\r\nPID	0xA053\r\nFW	159\r\nSER#	HQ21094NFGX\r\nV	22930\r\nI	-50\r\nVPV	41200\r\nPPV	8\r\nCS	3\r\nMPPT	2\r\nOR	0x00000000\r\nERR	0\r\nLOAD	ON\r\nIL	400\r\nH19	2679\r\nH20	1\r\nH21	14\r\nH22	18\r\nH23	79\r\nHSDS	297\r\nChecksum		\r\n";
 
+// BMV and Phoenix blocks without their checksum byte, see withChecksum
+const char TEST_BMV_BLOCK[] = "\r\nPID\t0x203\r\nV\t26201\r\nVS\t13104\r\nI\t-3480\r\nP\t-91\r\nCE\t-7200\r\nSOC\t876\r\nTTG\t1230\r\nAlarm\tOFF\r\nRelay\tON\r\nAR\t0\r\nBMV\t700\r\nFW\t0308\r\nH1\t-102345\r\nH9\t86400\r\nH17\t4567\r\nChecksum\t";
+const char TEST_PHOENIX_BLOCK[] = "\r\nPID\t0xA231\r\nFW\t0114\r\nMODE\t2\r\nCS\t9\r\nAC_OUT_V\t23002\r\nAC_OUT_I\t14\r\nAC_OUT_S\t322\r\nV\t12840\r\nAR\t0\r\nWARN\t0\r\nOR\t0x00000004\r\nChecksum\t";
+
+/**
+ * @brief Appends the checksum byte that completes a Victron block
+ * 
+ * @param block A block ending with the Checksum label and split character
+ * @return std::string 
+ */
+inline std::string withChecksum(const std::string& block)
+{
+    char checksum = 0;
+    for (char input : block)
+    {
+        checksum -= input;
+    }
+    return block + checksum;
+}
+
 /**
  * @brief Struct for holding test values
  * 
@@ -18,22 +40,23 @@ typedef struct _ExpectedValues
 {
     int32_t voltage;
     int32_t panelVoltage;
-    int16_t current;
+    int32_t current;
     int16_t panelPower;
-    int16_t loadCurrent;
-    int16_t yieldTotal;
+    int32_t loadCurrent;
+    int32_t yieldTotal;
     int16_t yieldToday;
     int16_t maxPowerToday;
     int16_t yieldYesterday;
     int16_t maxPowerYesterday;
     int16_t daySequence;
-    int8_t operationState;
+    uint8_t operationState;
     int8_t errorState;
     int8_t trackerOperationMode;
     int8_t load;
     const char* productId;
     const char* firmware;
     const char* serial;
+    uint32_t offReason;
 } ExpectedValues;
 
 /**
@@ -83,16 +106,16 @@ public:
                 EXPECT_EQ(*((int32_t*) data), expectedValues.panelVoltage);
                 break;
             case CURRENT:
-                EXPECT_EQ(*((int16_t*) data), expectedValues.current);
+                EXPECT_EQ(*((int32_t*) data), expectedValues.current);
                 break;
             case PANEL_POWER:
                 EXPECT_EQ(*((int16_t*) data), expectedValues.panelPower);
                 break;
             case LOAD_CURRENT:
-                EXPECT_EQ(*((int16_t*) data), expectedValues.loadCurrent);
+                EXPECT_EQ(*((int32_t*) data), expectedValues.loadCurrent);
                 break;
             case YIELD_TOTAL:
-                EXPECT_EQ(*((int16_t*) data), expectedValues.yieldTotal);
+                EXPECT_EQ(*((int32_t*) data), expectedValues.yieldTotal);
                 break;
             case YIELD_TODAY:
                 EXPECT_EQ(*((int16_t*) data), expectedValues.yieldToday);
@@ -110,7 +133,7 @@ public:
                 EXPECT_EQ(*((int16_t*) data), expectedValues.daySequence);
                 break;
             case OPERATION_STATE:
-                EXPECT_EQ(*((int8_t*) data), expectedValues.operationState);
+                EXPECT_EQ(*((uint8_t*) data), expectedValues.operationState);
                 break;
             case ERROR_STATE:
                 EXPECT_EQ(*((int8_t*) data), expectedValues.errorState);
@@ -131,12 +154,80 @@ public:
                 EXPECT_EQ(*((bool*) data), expectedValues.load);
                 break;
             case OFF_REASON:
+                EXPECT_EQ(*((uint32_t*) data), expectedValues.offReason);
+                break;
             default:
                 break;
         }
     }
 };
 
+/**
+ * @brief Test handler that records the last raw value of every field
+ * 
+ */
+class RecordingHandler : public VictronFieldHandler
+{
+private:
+    std::map<uint32_t, std::string> values;
+    int count;
+    int hexCount;
+    VictronHexFrame_t hexFrame;
+    std::string hexData;
+protected:
+public:
+    RecordingHandler() : count(0), hexCount(0) {};
+    ~RecordingHandler() {};
+
+    int getCount() { return count; }
+    bool has(uint32_t id) { return values.count(id) > 0; }
+
+    /**
+     * @brief Get the recorded value of a field
+     * 
+     * @tparam T The type the field was decoded into
+     * @param id The id of the field
+     * @return T 
+     */
+    template <typename T> T get(uint32_t id)
+    {
+        T value;
+        std::string& data = values.at(id);
+        EXPECT_EQ(data.size(), sizeof(T));
+        memcpy(&value, data.data(), sizeof(T));
+        return value;
+    }
+
+    std::string getString(uint32_t id) { return std::string(values.at(id).c_str()); }
+
+    int getHexCount() { return hexCount; }
+
+    /**
+     * @brief Get the last HEX frame received, with its data copied out of the parser
+     * 
+     * @return VictronHexFrame_t 
+     */
+    VictronHexFrame_t getHexFrame()
+    {
+        VictronHexFrame_t frame = hexFrame;
+        frame.data = (const uint8_t*) hexData.data();
+        return frame;
+    }
+
+    void fieldUpdate(uint32_t id, void* data, size_t size)
+    {
+        count++;
+        values[id] = std::string((char*) data, size);
+    }
+
+    void hexUpdate(VictronHexFrame_t* frame)
+    {
+        hexCount++;
+        hexFrame = *frame;
+        hexData = std::string((const char*) frame->data, frame->size);
+    }
+};
+
 // /**
 //  * @brief Mock Serial to force executions for tests
 //  */
@@ -0,0 +1,224 @@
+/*
+ * File: FakeSlave.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef FAKESLAVE
+#define FAKESLAVE
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include "ModbusFrame.h"
+
+#define FAKE_SLAVE_ID 3
+#define FAKE_SLAVE_REGISTERS 125
+#define FAKE_SLAVE_POLL_TIMEOUT 100
+
+using namespace std;
+
+/**
+ * @brief Answers register reads and writes on the master side of a pseudo terminal.
+ * The hub opens the slave side by name, like any serial port.
+ * 
+ */
+class FakeSlave
+{
+private:
+    int master;
+    int slave;
+    char name[64];
+    atomic<bool> running;
+    thread worker;
+    uint16_t registers[FAKE_SLAVE_REGISTERS];
+
+    void respond(const uint8_t* frame, size_t frameLength)
+    {
+        uint8_t response[RTU_MAX_LENGTH];
+        uint8_t* pdu = RTU_PDU(response);
+        uint8_t slaveId;
+        ModbusPdu_t request;
+        int length = rtuParse(frame, frameLength, &slaveId);
+        int exception;
+
+        if (length < 0 || slaveId != FAKE_SLAVE_ID)
+        {
+            return;
+        }
+
+        exception = pduParseRequest(RTU_PDU(frame), length, &request);
+
+        if (exception == 0 && request.address + request.count > FAKE_SLAVE_REGISTERS)
+        {
+            exception = PDU_ILLEGAL_DATA_ADDRESS;
+        }
+
+        if (exception == 0)
+        {
+            switch (request.function)
+            {
+                case PDU_READ_HOLDING_REGISTERS:
+                case PDU_READ_INPUT_REGISTERS:
+                    length = pduReadRegistersResponse(pdu, request.function, request.count, &registers[request.address]);
+                    break;
+                case PDU_WRITE_SINGLE_REGISTER:
+                    registers[request.address] = request.value;
+                    // The response echoes the request
+                    length = pduWriteSingle(pdu, request.function, request.address, request.value);
+                    break;
+                case PDU_WRITE_MULTIPLE_REGISTERS:
+                    for (uint16_t i = 0; i < request.count; i++)
+                    {
+                        registers[request.address + i] = pduRegister(&request, i);
+                    }
+
+                    length = pduWriteMultipleResponse(pdu, request.function, request.address, request.count);
+                    break;
+                default:
+                    exception = PDU_ILLEGAL_FUNCTION;
+                    break;
+            }
+        }
+
+        if (exception != 0)
+        {
+            length = pduException(pdu, request.function, exception);
+        }
+
+        length = rtuFrame(response, FAKE_SLAVE_ID, length);
+
+        if (write(master, response, length) != (ssize_t) length)
+        {
+            fprintf(stderr, "Fake slave: short write\n");
+        }
+    }
+
+    void run()
+    {
+        uint8_t frame[RTU_MAX_LENGTH];
+        size_t length = 0;
+        pollfd descriptor = { master, POLLIN, 0 };
+
+        while (running)
+        {
+            if (poll(&descriptor, 1, FAKE_SLAVE_POLL_TIMEOUT) <= 0)
+            {
+                // A gap between characters ends a frame, so a partial request is dropped
+                length = 0;
+                continue;
+            }
+
+            // A byte at a time past the header, so the end of a request is never read into the next
+            int expected = rtuRequestLength(frame, length);
+            ssize_t result = read(master, &frame[length], expected > (int) length ? expected - length : 1);
+
+            if (result <= 0)
+            {
+                continue;
+            }
+
+            length += result;
+            expected = rtuRequestLength(frame, length);
+
+            // Unknown functions and frames too long to be requests are dropped, like line noise
+            if (expected < 0 || expected > RTU_MAX_LENGTH)
+            {
+                length = 0;
+            }
+            else if (expected > 0 && length >= (size_t) expected)
+            {
+                respond(frame, length);
+                length = 0;
+            }
+        }
+    }
+
+public:
+    FakeSlave() : master(-1), slave(-1), running(false)
+    {
+        for (int i = 0; i < FAKE_SLAVE_REGISTERS; i++)
+        {
+            registers[i] = i;
+        }
+    }
+
+    ~FakeSlave()
+    {
+        stop();
+    }
+
+    int start()
+    {
+        termios attributes;
+
+        if (openpty(&master, &slave, name, NULL, NULL) != 0)
+        {
+            return -1;
+        }
+
+        // Raw before the hub opens it, so nothing is echoed back to the master
+        tcgetattr(slave, &attributes);
+        cfmakeraw(&attributes);
+        tcsetattr(slave, TCSANOW, &attributes);
+
+        running = true;
+        worker = thread(&FakeSlave::run, this);
+
+        return 0;
+    }
+
+    void stop()
+    {
+        running = false;
+
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+
+        if (master >= 0)
+        {
+            close(master);
+            close(slave);
+            master = slave = -1;
+        }
+    }
+
+    const char* getName() { return name; }
+    uint16_t getRegister(int address) { return registers[address]; }
+};
+
+#endif /* FAKESLAVE */
@@ -0,0 +1,215 @@
+/*
+ * File: GatewayBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+/**
+ * Load test of the Modbus TCP gateway. Many local clients read the same registers at once through
+ * the gateway, which passes them on to a fake RTU slave on a pseudo terminal. Reads waiting at the
+ * same time share a bus request, so the bus transactions per round should stay near one however many
+ * clients there are.
+ * 
+ * Usage: GatewayBenchmark [Google Benchmark flags]
+ */
+
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "ModbusConnection.h"
+#include "ModbusGateway.h"
+#include "FakeSlave.h"
+
+#define BENCHMARK_BAUD 38400
+#define BENCHMARK_ADDRESS "127.0.0.1"
+#define BENCHMARK_PORT 15020
+#define BENCHMARK_MAX_CLIENTS 50
+#define BENCHMARK_REGISTERS 10
+// Header, function code, byte count and the registers
+#define RESPONSE_LENGTH (MBAP_HEADER_LENGTH + 2 + BENCHMARK_REGISTERS * 2)
+
+static FakeSlave fakeSlave;
+// Never destroyed, the gateway threads run until the process exits
+static ModbusConnection* connection;
+static ModbusGateway* gateway;
+
+static int connectClient()
+{
+    sockaddr_in remote;
+    int noDelay = 1;
+    int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(BENCHMARK_PORT);
+    inet_pton(AF_INET, BENCHMARK_ADDRESS, &remote.sin_addr);
+
+    if (descriptor < 0 || ::connect(descriptor, (sockaddr*) &remote, sizeof(remote)) != 0)
+    {
+        return -1;
+    }
+
+    setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    return descriptor;
+}
+
+static bool receiveAll(int descriptor, uint8_t* data, size_t length)
+{
+    size_t received = 0;
+
+    while (received < length)
+    {
+        ssize_t result = recv(descriptor, &data[received], length - received, 0);
+
+        if (result <= 0)
+        {
+            return false;
+        }
+
+        received += result;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Every client sends the same read of holding registers, then every response is collected.
+ * Each client uses its own transaction id, so a response fanned out to the wrong client is caught.
+ */
+static void BM_GatewaySharedReads(benchmark::State& state)
+{
+    int count = state.range(0);
+    int clients[BENCHMARK_MAX_CLIENTS];
+    uint16_t round = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if ((clients[i] = connectClient()) < 0)
+        {
+            state.SkipWithError("Unable to connect to the gateway");
+
+            while (i-- > 0)
+            {
+                close(clients[i]);
+            }
+            return;
+        }
+    }
+
+    GatewayStatistics_t before = gateway->getStatistics();
+
+    for (auto _ : state)
+    {
+        round++;
+
+        for (int i = 0; i < count; i++)
+        {
+            uint16_t transaction = round * BENCHMARK_MAX_CLIENTS + i;
+            uint8_t request[] = {
+                (uint8_t) (transaction >> 8), (uint8_t) (transaction & 0xFF), 0, 0, 0, 6,
+                FAKE_SLAVE_ID, PDU_READ_HOLDING_REGISTERS, 0, 0, 0, BENCHMARK_REGISTERS
+            };
+
+            if (send(clients[i], request, sizeof(request), MSG_NOSIGNAL) != sizeof(request))
+            {
+                state.SkipWithError("Unable to send a request");
+                break;
+            }
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            uint8_t response[RESPONSE_LENGTH];
+            uint16_t transaction = round * BENCHMARK_MAX_CLIENTS + i;
+
+            if (!receiveAll(clients[i], response, sizeof(response)) || ((response[0] << 8) | response[1]) != transaction ||
+                response[MBAP_HEADER_LENGTH] != PDU_READ_HOLDING_REGISTERS || response[RESPONSE_LENGTH - 1] != BENCHMARK_REGISTERS - 1)
+            {
+                state.SkipWithError("Wrong response from the gateway");
+                break;
+            }
+        }
+    }
+
+    GatewayStatistics_t after = gateway->getStatistics();
+
+    state.SetItemsProcessed(after.requests - before.requests);
+    state.counters["transactions"] = benchmark::Counter(after.transactions - before.transactions, benchmark::Counter::kAvgIterations);
+
+    for (int i = 0; i < count; i++)
+    {
+        close(clients[i]);
+    }
+}
+BENCHMARK(BM_GatewaySharedReads)->Arg(1)->Arg(10)->Arg(BENCHMARK_MAX_CLIENTS)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void gatewayRunner()
+{
+    for(;;) { gateway->executeSync(); }
+}
+
+static void gatewayBusRunner()
+{
+    for(;;) { gateway->forward(); }
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (fakeSlave.start() != 0)
+    {
+        perror("Unable to open a pseudo terminal");
+        return 1;
+    }
+
+    connection = new ModbusConnection();
+    gateway = new ModbusGateway(connection);
+
+    if (connection->configure(fakeSlave.getName(), BENCHMARK_BAUD, 'N', 8, 2) != 0 || connection->connect() != 0 ||
+        gateway->listen(BENCHMARK_ADDRESS, BENCHMARK_PORT) != 0)
+    {
+        return 1;
+    }
+
+    thread(gatewayRunner).detach();
+    thread(gatewayBusRunner).detach();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    fakeSlave.stop();
+
+    return 0;
+}
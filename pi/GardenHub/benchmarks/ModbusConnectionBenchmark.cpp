@@ -0,0 +1,114 @@
+/*
+ * File: ModbusConnectionBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+/**
+ * Measures ModbusConnection request latency against a fake RTU slave on a pseudo terminal,
+ * so the cost of the connection itself (locking, libmodbus framing and the serial round trip)
+ * is measured without a bus or a slave's processing time.
+ * 
+ * Usage: ModbusConnectionBenchmark [Google Benchmark flags]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "ModbusConnection.h"
+#include "FakeSlave.h"
+
+#define BENCHMARK_SLAVE_ID FAKE_SLAVE_ID
+#define BENCHMARK_BAUD 38400
+
+static FakeSlave fakeSlave;
+static ModbusConnection connection;
+
+/**
+ * @brief A single read of the given number of input registers. The shed polls ~35, 125 is the protocol limit
+ */
+static void BM_ReadInputRegisters(benchmark::State& state)
+{
+    int count = state.range(0);
+    uint16_t data[FAKE_SLAVE_REGISTERS];
+
+    for (auto _ : state)
+    {
+        data[count - 1] = 0;
+        connection.readInputRegisters(BENCHMARK_SLAVE_ID, 0, count, data);
+
+        if (data[count - 1] != count - 1)
+        {
+            state.SkipWithError("Read returned the wrong registers");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ReadInputRegisters)->Arg(1)->Arg(35)->Arg(125)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_WriteRegister(benchmark::State& state)
+{
+    uint16_t value = 0;
+
+    for (auto _ : state)
+    {
+        connection.writeRegister(BENCHMARK_SLAVE_ID, 0, ++value);
+    }
+
+    if (fakeSlave.getRegister(0) != value)
+    {
+        state.SkipWithError("Write did not reach the slave");
+    }
+}
+BENCHMARK(BM_WriteRegister)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (fakeSlave.start() != 0)
+    {
+        perror("Unable to open a pseudo terminal");
+        return 1;
+    }
+
+    if (connection.configure(fakeSlave.getName(), BENCHMARK_BAUD, 'N', 8, 2) != 0 || connection.connect() != 0)
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    connection.disconnect();
+    fakeSlave.stop();
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * File: RecoveryBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+/**
+ * Fault injection test of bus recovery. The fake slave's pseudo terminal is closed under the hub, as
+ * when a USB adapter is unplugged, then a new one is opened after a while and the port's name is
+ * pointed at it, as when the adapter comes back. The time reported is from the port coming back to the
+ * first successful read, which the reconnect backoff bounds however long the port was gone.
+ * 
+ * Usage: RecoveryBenchmark [Google Benchmark flags]
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/stat.h>
+
+#include "ModbusConnection.h"
+#include "FakeSlave.h"
+
+#define BENCHMARK_BAUD 38400
+#define BENCHMARK_REGISTERS 10
+// The hub opens this link rather than the pseudo terminal, the way it would a /dev/serial/by-id name
+#define PORT_NAME_FORMAT "/tmp/gardenhub-recovery-%d"
+// Retries while the port is down fail straight away, so they are spaced out to keep the loop off the CPU
+#define RETRY_DELAY 1
+
+static FakeSlave fakeSlave;
+static ModbusConnection connection;
+static char portName[64];
+
+static int plug()
+{
+    char temporary[sizeof(portName) + 4];
+
+    if (fakeSlave.start() != 0)
+    {
+        return -1;
+    }
+
+    // Renamed over the old link, so the port's name never points at nothing while it is replaced
+    snprintf(temporary, sizeof(temporary), "%s.new", portName);
+    unlink(temporary);
+
+    if (symlink(fakeSlave.getName(), temporary) != 0 || rename(temporary, portName) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int32_t millisecondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Unplugs the port, waits for the hub to notice, leaves it down for the given time, then plugs it back in.
+ * Only the time from plugging it back in to the first good read is measured.
+ */
+static void BM_Recovery(benchmark::State& state)
+{
+    int32_t downtime = state.range(0);
+    uint16_t data[BENCHMARK_REGISTERS];
+    int32_t detection = 0;
+    ModbusStatistics_t before = connection.getStatistics();
+
+    for (auto _ : state)
+    {
+        if (connection.readRegisters(FAKE_SLAVE_ID, 0, BENCHMARK_REGISTERS, data) != BENCHMARK_REGISTERS)
+        {
+            state.SkipWithError("The port was not working before it was unplugged");
+            break;
+        }
+
+        fakeSlave.stop();
+
+        chrono::steady_clock::time_point unplugged = chrono::steady_clock::now();
+
+        while (connection.isConnected())
+        {
+            connection.readRegisters(FAKE_SLAVE_ID, 0, BENCHMARK_REGISTERS, data);
+        }
+
+        detection += millisecondsSince(unplugged);
+
+        // Requests keep coming while the port is down, as they would from the hub's clients
+        while (millisecondsSince(unplugged) < downtime)
+        {
+            connection.readRegisters(FAKE_SLAVE_ID, 0, BENCHMARK_REGISTERS, data);
+            this_thread::sleep_for(chrono::milliseconds(RETRY_DELAY));
+        }
+
+        if (plug() != 0)
+        {
+            state.SkipWithError("Unable to plug the port back in");
+            break;
+        }
+
+        chrono::steady_clock::time_point plugged = chrono::steady_clock::now();
+
+        while (connection.readRegisters(FAKE_SLAVE_ID, 0, BENCHMARK_REGISTERS, data) != BENCHMARK_REGISTERS ||
+            data[BENCHMARK_REGISTERS - 1] != BENCHMARK_REGISTERS - 1)
+        {
+            this_thread::sleep_for(chrono::milliseconds(RETRY_DELAY));
+        }
+
+        state.SetIterationTime(chrono::duration<double>(chrono::steady_clock::now() - plugged).count());
+    }
+
+    ModbusStatistics_t after = connection.getStatistics();
+
+    state.counters["detection_ms"] = benchmark::Counter(detection, benchmark::Counter::kAvgIterations);
+    state.counters["reconnects"] = after.reconnects - before.reconnects;
+    state.counters["failures"] = benchmark::Counter(after.failures - before.failures, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Recovery)->Arg(0)->Arg(500)->Arg(2000)->Arg(10000)->Iterations(5)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    snprintf(portName, sizeof(portName), PORT_NAME_FORMAT, getpid());
+
+    if (plug() != 0)
+    {
+        perror("Unable to open a pseudo terminal");
+        return 1;
+    }
+
+    if (connection.configure(portName, BENCHMARK_BAUD, 'N', 8, 2) != 0 || connection.connect() != 0)
+    {
+        unlink(portName);
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    fakeSlave.stop();
+    unlink(portName);
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * File: SparkplugBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+/**
+ * Measures Sparkplug publishing against a live broker, such as mosquitto on localhost.
+ * 
+ * Usage: SparkplugBenchmark [host] [port] [payloads] [metrics per payload]
+ * 
+ * Reports the cost of encoding a payload, the round trip latency of a single NDATA
+ * through the broker, and the throughput of back to back NDATA payloads.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "MqttConnection.h"
+#include "SparkplugNode.h"
+#include "SparkplugPayload.h"
+
+#define BENCHMARK_GROUP "Benchmark"
+#define BENCHMARK_NODE "SparkplugBenchmark"
+#define BENCHMARK_DATA_TOPIC SPARKPLUG_NAMESPACE "/" BENCHMARK_GROUP "/NDATA/" BENCHMARK_NODE
+#define BENCHMARK_METRICS 32
+#define ENCODE_ITERATIONS 100000
+#define CONNECT_TIMEOUT 5000
+#define RECEIVE_TIMEOUT 5000
+
+using namespace std;
+
+static const char* const METRIC_NAMES[BENCHMARK_METRICS] = {
+    "Benchmark/Metric 0", "Benchmark/Metric 1", "Benchmark/Metric 2", "Benchmark/Metric 3",
+    "Benchmark/Metric 4", "Benchmark/Metric 5", "Benchmark/Metric 6", "Benchmark/Metric 7",
+    "Benchmark/Metric 8", "Benchmark/Metric 9", "Benchmark/Metric 10", "Benchmark/Metric 11",
+    "Benchmark/Metric 12", "Benchmark/Metric 13", "Benchmark/Metric 14", "Benchmark/Metric 15",
+    "Benchmark/Metric 16", "Benchmark/Metric 17", "Benchmark/Metric 18", "Benchmark/Metric 19",
+    "Benchmark/Metric 20", "Benchmark/Metric 21", "Benchmark/Metric 22", "Benchmark/Metric 23",
+    "Benchmark/Metric 24", "Benchmark/Metric 25", "Benchmark/Metric 26", "Benchmark/Metric 27",
+    "Benchmark/Metric 28", "Benchmark/Metric 29", "Benchmark/Metric 30", "Benchmark/Metric 31"
+};
+
+static atomic<uint32_t> received(0);
+
+static void onData(const char* topic, const void* payload, int length, void* context)
+{
+    received++;
+}
+
+static uint64_t nanoseconds()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool waitFor(MqttConnection* connection)
+{
+    for (int i = 0; i < CONNECT_TIMEOUT && !connection->isConnected(); i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    return connection->isConnected();
+}
+
+static bool waitForReceived(uint32_t count)
+{
+    uint64_t deadline = nanoseconds() + (uint64_t) RECEIVE_TIMEOUT * 1000000;
+
+    while (received < count)
+    {
+        if (nanoseconds() > deadline)
+        {
+            return false;
+        }
+
+        this_thread::yield();
+    }
+
+    return true;
+}
+
+static void benchmarkEncoding(int metricsPerPayload)
+{
+    uint8_t buffer[SPARKPLUG_BUFFER_SIZE];
+    SparkplugPayload payload(buffer, sizeof(buffer));
+    SparkplugMetric_t metrics[BENCHMARK_METRICS];
+    int length = 0;
+
+    for (int i = 0; i < BENCHMARK_METRICS; i++)
+    {
+        metrics[i] = { METRIC_NAMES[i], 1700000000000ULL, 12850 + i, (uint16_t) i, SPARKPLUG_FLOAT, -3 };
+    }
+
+    uint64_t start = nanoseconds();
+
+    for (int i = 0; i < ENCODE_ITERATIONS; i++)
+    {
+        payload.begin(1700000000000ULL + i);
+
+        for (int j = 0; j < metricsPerPayload; j++)
+        {
+            metrics[j].value++;
+            payload.addMetric(&metrics[j], false);
+        }
+
+        length = payload.finish(i & 0xFF);
+    }
+
+    double elapsed = (double) (nanoseconds() - start) / ENCODE_ITERATIONS;
+
+    printf("Encode: %d metrics, %d bytes, %.0f ns per payload\n", metricsPerPayload, length, elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+    const char* host = argc > 1 ? argv[1] : "localhost";
+    int port = argc > 2 ? atoi(argv[2]) : 1883;
+    int payloads = argc > 3 ? atoi(argv[3]) : 10000;
+    int metricsPerPayload = min(argc > 4 ? atoi(argv[4]) : 8, BENCHMARK_METRICS);
+
+    benchmarkEncoding(metricsPerPayload);
+
+    MqttConnection publisher;
+    MqttConnection subscriber;
+    SparkplugNode node(&publisher, BENCHMARK_GROUP, BENCHMARK_NODE);
+    int aliases[BENCHMARK_METRICS];
+
+    for (int i = 0; i < BENCHMARK_METRICS; i++)
+    {
+        aliases[i] = node.addMetric(METRIC_NAMES[i], SPARKPLUG_FLOAT, -3);
+    }
+
+    subscriber.setMessageHandler(onData, NULL);
+
+    if (publisher.configure(host, port, BENCHMARK_NODE) != 0 || subscriber.configure(host, port, BENCHMARK_NODE "Subscriber") != 0 ||
+        node.connect(NULL) != 0 || subscriber.connect() != 0 || !waitFor(&publisher) || !waitFor(&subscriber))
+    {
+        printf("Unable to connect to the broker %s:%d\n", host, port);
+        return EXIT_FAILURE;
+    }
+
+    subscriber.subscribe(BENCHMARK_DATA_TOPIC, SPARKPLUG_QOS);
+    this_thread::sleep_for(chrono::milliseconds(100));
+
+    // The first publish is the NBIRTH
+    node.publish();
+
+    int64_t value = 0;
+    vector<uint64_t> latencies;
+    latencies.reserve(payloads);
+
+    for (int i = 0; i < payloads; i++)
+    {
+        uint32_t expected = received + 1;
+        value++;
+
+        for (int j = 0; j < metricsPerPayload; j++)
+        {
+            node.update(aliases[j], value);
+        }
+
+        uint64_t start = nanoseconds();
+
+        if (node.publish() != 0 || !waitForReceived(expected))
+        {
+            printf("Lost an NDATA after %d payloads\n", i);
+            return EXIT_FAILURE;
+        }
+
+        latencies.push_back(nanoseconds() - start);
+    }
+
+    sort(latencies.begin(), latencies.end());
+
+    printf("Latency: %d payloads, p50 %.1f us, p99 %.1f us, max %.1f us\n", payloads,
+        latencies[latencies.size() / 2] / 1000.0, latencies[latencies.size() * 99 / 100] / 1000.0, latencies.back() / 1000.0);
+
+    uint32_t expected = received + payloads;
+    uint64_t start = nanoseconds();
+
+    for (int i = 0; i < payloads; i++)
+    {
+        value++;
+
+        for (int j = 0; j < metricsPerPayload; j++)
+        {
+            node.update(aliases[j], value);
+        }
+
+        node.publish();
+    }
+
+    bool complete = waitForReceived(expected);
+    double elapsed = (double) (nanoseconds() - start) / 1000000000.0;
+    uint32_t delivered = payloads - (expected - min(expected, (uint32_t) received));
+
+    printf("Throughput: %u of %d payloads in %.3f s, %.0f payloads/s, %.0f metrics/s%s\n", delivered, payloads, elapsed,
+        delivered / elapsed, delivered * metricsPerPayload / elapsed, complete ? "" : " (timed out)");
+
+    SparkplugStatistics_t statistics = node.getStatistics();
+
+    printf("Published: %llu births, %llu payloads, %llu metrics, %llu bytes, %llu failures\n",
+        (unsigned long long) statistics.births, (unsigned long long) statistics.payloads, (unsigned long long) statistics.metrics,
+        (unsigned long long) statistics.bytes, (unsigned long long) statistics.failures);
+
+    subscriber.disconnect();
+    publisher.disconnect();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/*
+ * File: StatusBenchmark.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+
+
+/**
+ * Load test of the status server. Local clients request the status as fast as they can while a
+ * client polls a fake slave on a pseudo terminal. The status is served from the copies the client
+ * stages, so the poll latency should be the same with and without the requests.
+ * 
+ * Usage: StatusBenchmark [Google Benchmark flags]
+ */
+
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ModbusConnection.h"
+#include "ProfiledModbusClient.h"
+#include "StatusServer.h"
+#include "FakeSlave.h"
+
+#define BENCHMARK_BAUD 38400
+#define BENCHMARK_ADDRESS "127.0.0.1"
+#define BENCHMARK_PORT 18080
+#define BENCHMARK_REGISTERS 20
+#define BENCHMARK_RESPONSE_LENGTH 16384
+
+static const ProfileGroup_t BENCHMARK_GROUPS[] = {
+    // Due on every execute, as a read of the pseudo terminal takes longer than the period
+    { TABLE_INPUT_REGISTERS, 0, BENCHMARK_REGISTERS, 1 }
+};
+
+static const ProfileMetric_t BENCHMARK_METRICS[] = {
+    { "Benchmark/Voltage",      TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { 1,     REGISTER_UINT16,    UNIT_VOLT,      -2 }, 0 },
+    { "Benchmark/Current",      TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { 2,     REGISTER_INT16,     UNIT_AMP,       -1 }, 0 },
+    { "Benchmark/Power",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { 3,     REGISTER_UINT16,    UNIT_WATT,      0 }, 0 },
+    { "Benchmark/Yield",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { 4,     REGISTER_UINT32,    UNIT_KILOWATT_HOUR, -2 }, 0 },
+    { "Benchmark/Door Open",    TABLE_INPUT_REGISTERS, METRIC_BOOLEAN, { 6,     REGISTER_UINT16,    UNIT_NONE,      0 }, 0 }
+};
+
+// Takes the settings of the bed, which default to enabled
+static const DeviceProfile_t BENCHMARK_PROFILE = {
+    "Benchmark", FAKE_SLAVE_ID,
+    PROFILE_ENTRIES(BENCHMARK_GROUPS),
+    PROFILE_ENTRIES(BENCHMARK_METRICS),
+    NULL, 0,
+    NO_EVENT_LOG, 0, NULL, 0,
+    NO_GROUP_REGISTERS
+};
+
+static FakeSlave fakeSlave;
+// Never destroyed, the server thread runs until the process exits
+static ModbusConnection* connection;
+static ProfiledModbusClient* client;
+static StatusServer* server;
+
+/**
+ * @brief Requests the status and reads the response until the server closes the connection
+ * 
+ * @return int The length of the response, or -1 if it was not a success
+ */
+static int requestStatus(char* response, size_t size)
+{
+    static const char request[] = "GET /status HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    sockaddr_in remote;
+    size_t length = 0;
+    ssize_t result;
+    int descriptor = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(BENCHMARK_PORT);
+    inet_pton(AF_INET, BENCHMARK_ADDRESS, &remote.sin_addr);
+
+    if (descriptor < 0 || ::connect(descriptor, (sockaddr*) &remote, sizeof(remote)) != 0 ||
+        send(descriptor, request, sizeof(request) - 1, MSG_NOSIGNAL) != sizeof(request) - 1)
+    {
+        if (descriptor >= 0)
+        {
+            close(descriptor);
+        }
+        return -1;
+    }
+
+    while (length < size - 1 && (result = recv(descriptor, &response[length], size - 1 - length, 0)) > 0)
+    {
+        length += result;
+    }
+
+    close(descriptor);
+    response[length] = '\0';
+
+    return strncmp(response, "HTTP/1.1 200 OK", 15) == 0 ? length : -1;
+}
+
+/**
+ * @brief Each thread requests the status one after another, so the rate is what the server sustains
+ * for that many local clients
+ */
+static void BM_StatusRequests(benchmark::State& state)
+{
+    char response[BENCHMARK_RESPONSE_LENGTH];
+    int length = 0;
+
+    for (auto _ : state)
+    {
+        if ((length = requestStatus(response, sizeof(response))) < 0 || strstr(response, "\"Voltage\"") == NULL)
+        {
+            state.SkipWithError("Wrong response from the status server");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_StatusRequests)->Threads(1)->Threads(8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+static atomic<bool> hammering(false);
+static atomic<uint32_t> hammered(0);
+
+static void hammer()
+{
+    char response[BENCHMARK_RESPONSE_LENGTH];
+
+    while (hammering)
+    {
+        if (requestStatus(response, sizeof(response)) >= 0)
+        {
+            hammered++;
+        }
+    }
+}
+
+/**
+ * @brief Times a poll of the fake slave, alone and with a client requesting the status the whole time
+ */
+static void BM_PollLatency(benchmark::State& state)
+{
+    thread requester;
+    uint32_t before = hammered;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    if (state.range(0) != 0)
+    {
+        hammering = true;
+        requester = thread(hammer);
+    }
+
+    for (auto _ : state)
+    {
+        client->execute();
+    }
+
+    if (state.range(0) != 0)
+    {
+        hammering = false;
+        requester.join();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    state.counters["status_per_second"] = (hammered - before) / seconds;
+    state.counters["failures"] = connection->getStatistics().failures;
+}
+BENCHMARK(BM_PollLatency)->Arg(0)->Arg(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void statusRunner()
+{
+    for(;;) { server->executeSync(); }
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+
+    if (fakeSlave.start() != 0)
+    {
+        perror("Unable to open a pseudo terminal");
+        return 1;
+    }
+
+    connection = new ModbusConnection();
+    client = new ProfiledModbusClient(connection, NULL, NULL);
+    server = new StatusServer();
+
+    if (connection->configure(fakeSlave.getName(), BENCHMARK_BAUD, 'N', 8, 2) != 0 || connection->connect() != 0 ||
+        client->addDevice(&BENCHMARK_PROFILE, "bed") < 0 || server->addClient(client) != 0 ||
+        server->listen(BENCHMARK_ADDRESS, BENCHMARK_PORT) != 0)
+    {
+        return 1;
+    }
+
+    // The first execute reads the device and stages its state, so the status has values from the start
+    client->execute();
+
+    thread(statusRunner).detach();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    fakeSlave.stop();
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * File: CheckpointStore.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef CHECKPOINTSTORE
+#define CHECKPOINTSTORE
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "Executor.h"
+#include "HubConfig.h"
+#include "ProfiledModbusClient.h"
+using namespace std;
+
+#define CHECKPOINT_MAGIC 0x4B434847     // "GHCK"
+// Raised whenever a profile moves its registers, so registers saved under the old layout are not published
+#define CHECKPOINT_VERSION 2
+// Older checkpoints are ignored, the devices have likely changed too much for them to be any use
+#define CHECKPOINT_MAX_AGE (24 * 60 * 60)
+
+/**
+ * @brief Start of a checkpoint file. The sizes of the records are kept so a file from a build with a
+ * different layout is ignored, rather than read into the wrong fields.
+ * 
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t clientCount;
+    uint32_t clientSize;        // Size of a ClientCheckpoint_t up to its devices
+    uint32_t deviceSize;        // Size of a DeviceCheckpoint_t
+    int64_t savedAt;            // Wall clock seconds
+    uint32_t length;            // Bytes after the header
+    uint32_t crc;               // CRC-32 of the bytes after the header
+} CheckpointHeader_t;
+
+/**
+ * @brief Keeps the state of every client in a file, so a restarted hub starts from what it last knew.
+ * Each client is stored as its bus index followed by its state, with only the devices it has.
+ * The file is written to a temporary name, synced and then renamed over the old one, so a crash or
+ * power cut while saving leaves the previous checkpoint in place.
+ * 
+ */
+class CheckpointStore : Executor
+{
+private:
+    string path;
+    int32_t period;
+    ProfiledModbusClient* clients[HUB_MAX_BUSES];
+    uint8_t clientCount;
+    ClientCheckpoint_t* checkpoints;    // Too large for the stack, so the copies taken from the clients live here
+    // A save at shutdown can overlap the periodic one
+    mutex saveLock;
+    uint32_t savedCrc;
+    uint32_t savedLength;
+protected:
+    int32_t doExecute();
+public:
+    /**
+     * @brief Construct a new store
+     * 
+     * @param path The checkpoint file
+     * @param period Milliseconds between saves
+     */
+    CheckpointStore(const char* path, int32_t period);
+    ~CheckpointStore();
+
+    /**
+     * @brief Adds a client to save and restore, all clients must be added before restoring
+     * 
+     * @param client 
+     * @return int non-zero if there is no room for the client
+     */
+    int addClient(ProfiledModbusClient* client);
+
+    /**
+     * @brief Restores every client from the file, if there is a valid one that is recent enough
+     * 
+     * @return int The number of devices restored, or -1 if the file could not be used
+     */
+    int restore();
+
+    /**
+     * @brief Writes the latest state of every client. Skipped when nothing changed since the last save
+     * 
+     * @return int 0 on success, -1 on failure
+     */
+    int save();
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* CHECKPOINTSTORE */
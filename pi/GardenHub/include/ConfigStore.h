@@ -0,0 +1,110 @@
+/*
+ * File: ConfigStore.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef CONFIGSTORE
+#define CONFIGSTORE
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "Executor.h"
+#include "HubConfig.h"
+using namespace std;
+
+// Longest wait for a change before the watcher checks in, so it can be stopped
+#define CONFIG_WATCH_TIMEOUT 1000
+// Editors often write a file in several steps, so changes are only loaded once they settle
+#define CONFIG_SETTLE_TIME 100
+
+/**
+ * @brief Holds the current configuration snapshot and reloads it when the file changes.
+ * Readers take a reference to a snapshot, which stays valid while they hold it, so a reload
+ * never blocks or changes a poll that is already running.
+ * 
+ */
+class ConfigStore : Executor
+{
+private:
+    string path;
+    string directory;
+    string fileName;
+    int inotifyDescriptor;
+    shared_ptr<const HubConfig_t> current;
+    atomic<uint32_t> version;
+    int reload();
+protected:
+    int32_t doExecute();
+public:
+    ConfigStore(const char* path);
+    ~ConfigStore();
+
+    /**
+     * @brief Loads the initial configuration. A missing file falls back to the defaults.
+     * 
+     * @return int non-zero return if the file exists but is invalid
+     */
+    int load();
+
+    /**
+     * @brief Starts watching the configuration file for changes. The directory is watched rather
+     * than the file, so editors that replace the file on save are still seen.
+     * 
+     * @return int non-zero return if the watch could not be started
+     */
+    int watch();
+
+    /**
+     * @brief Get the current configuration snapshot
+     * 
+     * @return shared_ptr<const HubConfig_t> 
+     */
+    shared_ptr<const HubConfig_t> get() const;
+
+    /**
+     * @brief Get the number of times the configuration has been replaced
+     * 
+     * @return uint32_t 
+     */
+    uint32_t getVersion() const;
+
+    /**
+     * @brief A snapshot of the default configuration, for clients created without a store
+     * 
+     * @return shared_ptr<const HubConfig_t> 
+     */
+    static shared_ptr<const HubConfig_t> defaults();
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* CONFIGSTORE */
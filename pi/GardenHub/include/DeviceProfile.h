@@ -0,0 +1,166 @@
+/*
+ * File: DeviceProfile.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef DEVICEPROFILE
+#define DEVICEPROFILE
+
+#include <cstdint>
+#include <cstddef>
+#include "Units.h"
+using namespace std;
+
+// Registers of each table mirrored by the hub for every device
+#define PROFILE_TABLE_SIZE 256
+#define PROFILE_MAX_GROUPS 8
+#define PROFILE_MAX_METRICS 32
+#define PROFILE_MAX_WRITES 4
+// Group periods taken from the settings of the device instead of fixed by the profile
+#define PERIOD_POLL 0           // DeviceConfig_t pollTime
+#define PERIOD_TELEMETRY -1     // DeviceConfig_t telemetryTime
+// Profiles without an event log
+#define NO_EVENT_LOG -1
+// Profiles that do not take group commands
+#define NO_GROUP_REGISTERS -1
+
+// Counts the entries of a profile table, for the count that follows it
+#define PROFILE_ENTRIES(table) table, sizeof(table) / sizeof(table[0])
+
+// Register tables of a device
+enum ProfileTable
+{
+    TABLE_HOLDING_REGISTERS,
+    TABLE_INPUT_REGISTERS,
+    PROFILE_TABLE_COUNT
+};
+
+// How a metric is read from the registers
+enum ProfileMetricType
+{
+    METRIC_NUMBER,          // A value of value.format, published as a float if it has a unit
+    METRIC_BOOLEAN,         // Non-zero register
+    METRIC_STRING,          // Span of length string registers
+    METRIC_UPTIME           // 32 bit device uptime in seconds, published as a wall clock time in milliseconds
+};
+
+// How a write is decided
+enum ProfileWritePolicy
+{
+    WRITE_SCHEDULE,         // Level of the light schedule, ramp time and curve in one request whenever the level differs
+    WRITE_CONSTANT,         // value, whenever the register differs, such as after the device restarts
+    WRITE_GROUPS            // Groups of the device settings, whenever the register differs
+};
+
+/**
+ * @brief A block of registers read in a single request, at its own rate
+ * 
+ */
+typedef struct {
+    uint8_t table;          // A ProfileTable
+    uint16_t address;
+    uint16_t count;
+    int32_t period;         // Milliseconds between reads, or PERIOD_POLL / PERIOD_TELEMETRY
+} ProfileGroup_t;
+
+/**
+ * @brief A Sparkplug metric published whenever the group holding its registers is read
+ * 
+ */
+typedef struct {
+    const char* name;
+    uint8_t table;          // A ProfileTable
+    uint8_t type;           // A ProfileMetricType
+    RegisterUnit_t value;   // Address and format of the value, and its unit for METRIC_NUMBER
+    uint8_t length;         // Registers of a METRIC_STRING
+} ProfileMetric_t;
+
+/**
+ * @brief A holding register the hub keeps in the desired state
+ * 
+ */
+typedef struct {
+    uint16_t address;
+    uint8_t policy;         // A ProfileWritePolicy
+    uint16_t value;         // For WRITE_CONSTANT
+} ProfileWrite_t;
+
+/**
+ * @brief Describes a model of device, so any number of them can be polled by a ProfiledModbusClient
+ * 
+ */
+typedef struct {
+    const char* name;       // Used in logs
+    int slaveId;            // Default slave id
+    const ProfileGroup_t* groups;
+    uint8_t groupCount;
+    const ProfileMetric_t* metrics;
+    uint8_t metricCount;
+    const ProfileWrite_t* writes;
+    uint8_t writeCount;
+    int32_t eventLog;       // First input register of a ModbusEvents log, or NO_EVENT_LOG
+    uint8_t eventLogLength;
+    const char* const* eventNames;  // Names of the event types, indexed by type
+    uint8_t eventNameCount;
+    int32_t groupRegisters; // First holding register of a ModbusGroups block, or NO_GROUP_REGISTERS
+} DeviceProfile_t;
+
+/**
+ * @brief Registers a metric takes up
+ * 
+ */
+inline uint16_t metricRegisters(const ProfileMetric_t& metric)
+{
+    switch (metric.type)
+    {
+        case METRIC_STRING:
+            return metric.length;
+        case METRIC_UPTIME:
+            return 2;
+        default:
+            return metric.value.format == REGISTER_UINT32 || metric.value.format == REGISTER_INT32 ? 2 : 1;
+    }
+}
+
+/**
+ * @brief Whether a group holds every register of a metric, so the metric is only taken from a read that has all of them
+ * 
+ */
+inline bool metricInGroup(const ProfileMetric_t& metric, const ProfileGroup_t& group)
+{
+    return metric.table == group.table && metric.value.address >= group.address &&
+        metric.value.address + metricRegisters(metric) <= group.address + group.count;
+}
+
+extern const DeviceProfile_t GARDEN_BED_PROFILE;
+extern const DeviceProfile_t GARDEN_SHED_PROFILE;
+
+#endif /* DEVICEPROFILE */
@@ -0,0 +1,214 @@
+/*
+ * File: HubConfig.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef HUBCONFIG
+#define HUBCONFIG
+
+#include <cstdint>
+#include <cstddef>
+#include "Schedule.h"
+using namespace std;
+
+#define CONFIG_STRING_LENGTH 64
+#define CONFIG_LINE_LENGTH 256
+#define CONFIG_DEFAULT_PATH "/etc/gardener/gardenhub.conf"
+// Serial ports with their own bus. The first is the [modbus] section, the rest [modbus1] and up
+#define HUB_MAX_BUSES 4
+// Devices the configuration can name, each in its own [device.<name>] section
+#define HUB_MAX_DEVICES 16
+
+/**
+ * @brief Settings of a single Modbus RTU bus. Buses without a port are not opened
+ * 
+ */
+typedef struct {
+    char port[CONFIG_STRING_LENGTH];
+    int32_t baud;
+    char parity;
+    int32_t dataBits;
+    int32_t stopBits;
+} SerialConfig_t;
+
+typedef struct {
+    char host[CONFIG_STRING_LENGTH];
+    int32_t port;
+    char group[CONFIG_STRING_LENGTH];
+    char node[CONFIG_STRING_LENGTH];
+    char sequencePath[CONFIG_STRING_LENGTH];    // Where the last bdSeq is kept, empty to start from 0 on every start
+} MqttConfig_t;
+
+/**
+ * @brief A Modbus TCP server that passes requests from other masters on to one of the buses
+ * 
+ */
+typedef struct {
+    bool enabled;
+    char address[CONFIG_STRING_LENGTH];     // Address to listen on, loopback keeps it to local clients
+    int32_t port;
+    int32_t bus;
+} GatewayConfig_t;
+
+/**
+ * @brief A HTTP server with the status of the buses and devices as JSON
+ * 
+ */
+typedef struct {
+    bool enabled;
+    char address[CONFIG_STRING_LENGTH];     // Address to listen on, loopback keeps it to local clients
+    int32_t port;
+} StatusConfig_t;
+
+/**
+ * @brief Where the state of the devices is kept across restarts
+ * 
+ */
+typedef struct {
+    char path[CONFIG_STRING_LENGTH];        // Empty to not keep the state
+    int32_t period;                         // Seconds between saves
+} CheckpointConfig_t;
+
+/**
+ * @brief What the hub writes to its output
+ * 
+ */
+typedef struct {
+    int32_t level;          // Lowest LogLevel written, from 0 for debug to 3 for errors only
+} LogConfig_t;
+
+/**
+ * @brief Settings of a single device on the bus
+ * 
+ */
+typedef struct {
+    char name[CONFIG_STRING_LENGTH];        // Name of the section, [device.<name>]
+    char profile[CONFIG_STRING_LENGTH];     // Profile the device is polled with, such as bed or shed
+    bool enabled;
+    int32_t bus;            // Index of the bus the device is wired to
+    int32_t slaveId;        // Slave id of the device, 0 for the default of its profile
+    int32_t pollTime;       // Milliseconds between polls
+    int32_t telemetryTime;  // Milliseconds between reads of every register, polls in between only read what changed
+    int32_t lightHigh;      // Light intensity when on, as a percentage
+    int32_t lightOn;        // Minutes past midnight the light turns on
+    int32_t lightOff;       // Minutes past midnight the light turns off
+    ScheduleProgram_t program;  // Replaces the light window when it has events
+    int32_t rampCurve;      // LightRampCurve the device fades along
+    int32_t groups;         // Groups of scenes the device is in, a bit each
+} DeviceConfig_t;
+
+/**
+ * @brief A light level for every device in a set of groups, sent as a single broadcast whenever it changes.
+ * The devices hold it until their own schedules next change.
+ * 
+ */
+typedef struct {
+    bool enabled;
+    int32_t groups;         // Groups the scene is for, a bit each
+    int32_t level;          // Light intensity as a percentage
+    int32_t rampTime;       // Seconds to fade to the level
+    int32_t rampCurve;      // LightRampCurve of the fade
+} SceneConfig_t;
+
+/**
+ * @brief Where the garden is, for sunrise and sunset
+ * 
+ */
+typedef struct {
+    double latitude;        // Degrees, north positive
+    double longitude;       // Degrees, east positive
+} LocationConfig_t;
+
+/**
+ * @brief A complete hub configuration. Snapshots are never modified once loaded, a changed
+ * file produces a new snapshot instead.
+ * Serial, MQTT, gateway, status and checkpoint settings, and which devices there are with their profile, bus and slave id,
+ * are only read at startup.
+ * Everything else is applied on the next poll.
+ * 
+ */
+typedef struct {
+    SerialConfig_t modbus[HUB_MAX_BUSES];
+    MqttConfig_t mqtt;
+    GatewayConfig_t gateway;
+    StatusConfig_t status;
+    LogConfig_t log;
+    CheckpointConfig_t checkpoint;
+    LocationConfig_t location;
+    DeviceConfig_t devices[HUB_MAX_DEVICES];   // In the order of their sections, after the default bed and shed
+    int32_t deviceCount;
+    SceneConfig_t scene;
+} HubConfig_t;
+
+/**
+ * @brief Populates a configuration with the defaults, matching the original hardcoded settings
+ * 
+ * @param config 
+ */
+void defaultHubConfig(HubConfig_t* config);
+
+/**
+ * @brief Parses an INI style configuration on top of the values already in config.
+ * Lines are `key = value` under `[section]` headers, `#` and `;` start comments.
+ * 
+ * @param text The null terminated configuration
+ * @param config Updated with every value in the text
+ * @return int 0 on success, or the line number of the first invalid line
+ */
+int parseHubConfig(const char* text, HubConfig_t* config);
+
+/**
+ * @brief Loads a configuration file on top of the defaults
+ * 
+ * @param path 
+ * @param config 
+ * @return int 0 on success, -1 if the file could not be read, or the line number of the first invalid line
+ */
+int loadHubConfig(const char* path, HubConfig_t* config);
+
+/**
+ * @brief Finds the settings of a device by the name of its section
+ * 
+ * @param config 
+ * @param name 
+ * @return const DeviceConfig_t* NULL if there is no device with the name
+ */
+const DeviceConfig_t* findDeviceConfig(const HubConfig_t* config, const char* name);
+
+/**
+ * @brief Get the program of a device. Devices without one follow their light window,
+ * at lightHigh between lightOn and lightOff, or at lightHigh all day if the two are equal.
+ * 
+ * @param device 
+ * @param program Populated with the program
+ */
+void deviceProgram(const DeviceConfig_t* device, ScheduleProgram_t* program);
+
+#endif /* HUBCONFIG */
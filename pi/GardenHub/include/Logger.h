@@ -0,0 +1,125 @@
+/*
+ * File: Logger.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef LOGGER
+#define LOGGER
+
+#include <atomic>
+#include <cstdint>
+#include "Executor.h"
+using namespace std;
+
+// Messages waiting to be written, a power of two. Messages logged while it is full are dropped and counted
+#define LOG_SLOTS 256
+#define LOG_MESSAGE_LENGTH 160
+// Messages a call site can log in a row, after that it logs once per period with the count it held back
+#define LOG_BURST 5
+#define LOG_LIMIT_PERIOD 10000
+// Milliseconds between writing out the waiting messages
+#define LOG_FLUSH_TIME 50
+
+enum LogLevel
+{
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_COUNT
+};
+
+/**
+ * @brief Rate limit of a single call site. Zero initialised, so a function static needs no setup
+ * 
+ */
+typedef struct {
+    atomic<uint32_t> start;         // Millisecond the current period started
+    atomic<uint32_t> count;         // Messages logged in the current period
+    atomic<uint32_t> suppressed;    // Messages held back since the last one logged
+} LogLimit_t;
+
+/**
+ * @brief Logs a printf style message at a level, rate limited per call site
+ * 
+ */
+#define HUB_LOG(level, ...) do { static LogLimit_t logLimit; Logger::log(level, &logLimit, __VA_ARGS__); } while (0)
+
+/**
+ * @brief Logging that never waits on the output. Messages are formatted straight into a preallocated
+ * ring, claimed without a lock, and written out by the thread running the logger. Messages below the
+ * level, held back by the rate limit, or arriving while the ring is full are never formatted at all.
+ * Info and debug go to stdout, warnings and errors to stderr.
+ * 
+ */
+class Logger : Executor
+{
+private:
+protected:
+    int32_t doExecute();
+public:
+    Logger() {};
+
+    /**
+     * @brief Queues a message to be written. Safe from any thread, and never blocks
+     * 
+     * @param level 
+     * @param limit Rate limit of the call site, or NULL for none
+     * @param format printf style format, without a trailing newline
+     */
+    static void log(int level, LogLimit_t* limit, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    /**
+     * @brief Sets the lowest level that is logged, LOG_LEVEL_INFO until it is set
+     * 
+     * @param level 
+     */
+    static void setLevel(int level);
+
+    /**
+     * @brief Writes out every waiting message, and a note of any that were dropped
+     * 
+     * @return int The number of messages written
+     */
+    static int flush();
+
+    /**
+     * @brief Gets the number of messages dropped because the ring was full
+     * 
+     * @return uint32_t 
+     */
+    static uint32_t getDropped();
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* LOGGER */
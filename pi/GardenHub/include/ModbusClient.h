@@ -55,6 +55,7 @@ protected:
     int writeBits(int address, int size, uint8_t* values);
     int writeRegister(int address, uint16_t value);
     int writeRegisters(int address, int size, uint16_t* values);
+    int broadcastRegisters(int broadcastId, int address, int size, uint16_t* values);
 public:
     ModbusClient();
     ModbusClient(ModbusConnection* connection, int slaveId);
@@ -36,23 +36,55 @@
 #include <mutex>
 #include <chrono>
 #include <thread>
+#include <atomic>
 using namespace std;
 
 /**
- * @brief 
+ * @brief Request counts of a connection since it was created
+ * 
+ */
+typedef struct {
+    uint32_t requests;
+    uint32_t failures;
+    // Times the port was opened again after it was lost, and how long it was down for the last time
+    uint32_t reconnects;
+    uint32_t outage;
+} ModbusStatistics_t;
+
+/**
+ * @brief A single serial bus. Requests on one connection are serialised by its lock, separate
+ * connections can be used from separate threads at the same time.
+ * 
+ * A port that fails with an I/O error, such as a USB adapter being unplugged, is closed and reopened
+ * by later requests with a backoff. Requests fail straight away while it is down.
  * 
  */
 class ModbusConnection
 {
 private:
     int slaveId;
-    bool connected;
+    atomic<bool> connected;
     modbus_t *modbusContext;
     const char *port;
     mutex connectionLock;
+    // When the port was lost, and when it may next be tried again
+    chrono::steady_clock::time_point lostTime;
+    chrono::steady_clock::time_point retryTime;
+    int32_t backoff;
+    // Counted under the lock, atomic so they can be read without waiting for the bus
+    atomic<uint32_t> requests;
+    atomic<uint32_t> failures;
+    atomic<uint32_t> reconnects;
+    atomic<uint32_t> outage;
     int setSlaveId(int slaveId);
     void lock();
     void unlock();
+    int ready();
+    int begin(int slaveId);
+    void count(int result);
+    bool isLinkError(int error);
+    void lost(int error);
+    int reconnect();
 protected:
 
 public:
@@ -72,7 +104,7 @@ public:
     int configure(const char *device, int baud, char parity, int data_bit, int stop_bit);
 
     /**
-     * @brief Attempt to connect using the configured settings
+     * @brief Attempt to connect using the configured settings. If it fails, requests keep trying the port
      * 
      * @return int non-zero return if the it failed to connect  
      */
@@ -84,6 +116,25 @@ public:
      */
     void disconnect();
 
+    /**
+     * @brief Whether the port is currently open
+     * 
+     */
+    bool isConnected();
+
+    /**
+     * @brief Gets the serial port the connection was configured with, or NULL if it was not
+     * 
+     */
+    const char* getPort();
+
+    /**
+     * @brief Gets the number of requests made on the connection, how many of them failed and how often the port was lost
+     * 
+     * @return ModbusStatistics_t 
+     */
+    ModbusStatistics_t getStatistics();
+
     int request(int slaveId, uint8_t* modbusRequest);
 
     int reply(int slaveId, uint8_t* modbusRequest, int modbusRequestResult, modbus_mapping_t* mapping);
@@ -96,6 +147,29 @@ public:
     int writeBits(int slaveId, int address, int size, uint8_t* values);
     int writeRegister(int slaveId, int address, uint16_t value);
     int writeRegisters(int slaveId, int address, int size, uint16_t* values);
+
+    /**
+     * @brief Writes the same registers on every slave in a single frame. Slaves never reply to a broadcast,
+     * so it costs no response wait, and the delay before the next request gives them time to act on it
+     * 
+     * @param broadcastId The broadcast address the slaves take, 0 in the standard
+     * @param address 
+     * @param size 
+     * @param values 
+     * @return int The number of registers sent, or -1 if the frame could not be sent
+     */
+    int broadcastRegisters(int broadcastId, int address, int size, uint16_t* values);
+
+    /**
+     * @brief Sends a request PDU as is and receives the response, for requests from other masters
+     * 
+     * @param slaveId 
+     * @param request The request PDU, starting with the function code
+     * @param length Length of the request PDU
+     * @param response Receives the response PDU, which may be an exception. At least MODBUS_MAX_PDU_LENGTH long
+     * @return int The length of the response PDU, or -1 if there was no valid response
+     */
+    int forward(int slaveId, const uint8_t* request, int length, uint8_t* response);
 };
 
 #endif /* MODBUSCONNECTION */
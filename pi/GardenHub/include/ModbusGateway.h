@@ -0,0 +1,173 @@
+/*
+ * File: ModbusGateway.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef MODBUSGATEWAY
+#define MODBUSGATEWAY
+
+#include <modbus.h>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "Executor.h"
+#include "ModbusConnection.h"
+using namespace std;
+
+#define GATEWAY_MAX_CLIENTS 64
+// Distinct requests waiting for the bus at once, identical reads share one
+#define GATEWAY_MAX_FLIGHTS 32
+#define GATEWAY_MAX_WAITERS 64
+#define GATEWAY_POLL_TIMEOUT 1000
+#define GATEWAY_BACKLOG 16
+// Highest unit id passed on to the bus, the same as the highest slave id
+#define GATEWAY_MAX_UNIT 247
+// Transaction id, protocol id, length and unit id
+#define MBAP_HEADER_LENGTH 7
+
+#define GATEWAY_EXCEPTION_SERVER_BUSY 0x06
+#define GATEWAY_EXCEPTION_PATH_UNAVAILABLE 0x0A
+#define GATEWAY_EXCEPTION_TARGET_FAILED 0x0B
+
+/**
+ * @brief A connected Modbus TCP client. The generation changes whenever the slot is reused,
+ * so a response is never sent to a client that connected after the request was made.
+ * 
+ */
+typedef struct {
+    int socket;
+    uint32_t generation;
+    uint8_t buffer[MODBUS_TCP_MAX_ADU_LENGTH];
+    uint16_t length;
+} GatewayClient_t;
+
+/**
+ * @brief A client request waiting on a flight
+ * 
+ */
+typedef struct {
+    uint8_t client;
+    uint32_t generation;
+    uint16_t transaction;
+} GatewayWaiter_t;
+
+enum GatewayFlightState
+{
+    FLIGHT_FREE, FLIGHT_QUEUED, FLIGHT_RUNNING, FLIGHT_DONE
+};
+
+/**
+ * @brief A single request on the bus and every client waiting for its response
+ * 
+ */
+typedef struct {
+    GatewayFlightState state;
+    uint32_t order;                     // Flights are sent in the order they were queued
+    uint8_t unit;
+    uint8_t request[MODBUS_MAX_PDU_LENGTH];
+    uint16_t requestLength;
+    uint8_t response[MODBUS_MAX_PDU_LENGTH];
+    int16_t responseLength;             // -1 if the device did not respond
+    GatewayWaiter_t waiters[GATEWAY_MAX_WAITERS];
+    uint8_t waiterCount;
+} GatewayFlight_t;
+
+/**
+ * @brief Request counts of a gateway since it started
+ * 
+ */
+typedef struct {
+    uint32_t requests;                  // Requests from clients
+    uint32_t transactions;              // Requests sent on the bus
+} GatewayStatistics_t;
+
+/**
+ * @brief Accepts Modbus TCP clients and passes their requests on to a bus through its ModbusConnection,
+ * so they are queued with the hub's own requests rather than colliding with them.
+ * A read that is identical to one already waiting or on the bus joins it, and the single response
+ * is sent to every client that asked for it.
+ * 
+ * Clients are served by execute, and requests are sent on the bus by forward from a second thread,
+ * so clients are still accepted and read while the bus is busy.
+ * 
+ */
+class ModbusGateway : Executor
+{
+private:
+    ModbusConnection* connection;
+    int listener;
+    int wake[2];                        // Signals the client thread when a flight is done
+    GatewayClient_t clients[GATEWAY_MAX_CLIENTS];
+    GatewayFlight_t flights[GATEWAY_MAX_FLIGHTS];
+    uint32_t order;
+    mutex flightLock;
+    condition_variable queued;
+    atomic<uint32_t> requests;
+    atomic<uint32_t> transactions;
+    void accept();
+    void receive(uint8_t client);
+    void submit(uint8_t client, const uint8_t* frame, uint16_t length);
+    void reply(uint8_t client, uint16_t transaction, uint8_t unit, const uint8_t* pdu, uint16_t length);
+    void exception(uint8_t client, uint16_t transaction, uint8_t unit, uint8_t function, uint8_t code);
+    void complete();
+    void drop(uint8_t client);
+protected:
+    int32_t doExecute();
+public:
+    ModbusGateway(ModbusConnection* connection);
+    ~ModbusGateway();
+
+    /**
+     * @brief Starts listening for clients
+     * 
+     * @param address IPv4 address to listen on
+     * @param port 
+     * @return int non-zero return if the socket could not be opened
+     */
+    int listen(const char* address, int port);
+
+    /**
+     * @brief Waits for a queued request and sends it on the bus. Called in a loop from its own thread
+     * 
+     */
+    void forward();
+
+    /**
+     * @brief Gets the number of client requests and how many requests were sent on the bus for them
+     * 
+     * @return GatewayStatistics_t 
+     */
+    GatewayStatistics_t getStatistics();
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* MODBUSGATEWAY */
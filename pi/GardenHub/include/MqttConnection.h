@@ -0,0 +1,172 @@
+/*
+ * File: MqttConnection.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef MQTTCONNECTION
+#define MQTTCONNECTION
+
+#include <mosquitto.h>
+#include <atomic>
+#include <cstdint>
+using namespace std;
+
+#define MQTT_KEEP_ALIVE 30
+#define MQTT_RECONNECT_DELAY 1
+#define MQTT_RECONNECT_DELAY_MAX 30
+
+/**
+ * @brief Handler for messages received on subscribed topics. Called from the network thread.
+ * 
+ */
+typedef void (*MqttMessageHandler)(const char* topic, const void* payload, int length, void* context);
+
+/**
+ * @brief Handler for a lost connection, called from the network thread before the connection is retried.
+ * 
+ */
+typedef void (*MqttDisconnectHandler)(void* context);
+
+/**
+ * @brief Connection to an MQTT broker. Network traffic and reconnects are handled on
+ * a background thread owned by libmosquitto.
+ * 
+ */
+class MqttConnection
+{
+private:
+    struct mosquitto* mosquittoContext;
+    const char* host;
+    int port;
+    atomic<bool> connected;
+    atomic<uint32_t> session;
+    MqttMessageHandler messageHandler;
+    void* messageContext;
+    MqttDisconnectHandler disconnectHandler;
+    void* disconnectContext;
+    static void onConnect(struct mosquitto* mosquittoContext, void* object, int result);
+    static void onDisconnect(struct mosquitto* mosquittoContext, void* object, int result);
+    static void onMessage(struct mosquitto* mosquittoContext, void* object, const struct mosquitto_message* message);
+protected:
+
+public:
+    MqttConnection();
+    ~MqttConnection();
+
+    /**
+     * @brief Configures the broker to connect to
+     * 
+     * @param host 
+     * @param port 
+     * @param clientId 
+     * @return int non-zero return if the connection failed to configure
+     */
+    int configure(const char* host, int port, const char* clientId);
+
+    /**
+     * @brief Sets the message the broker publishes if the connection is lost. Applies from the next connection to the broker,
+     * so it can be replaced from the disconnect handler before a reconnect.
+     * 
+     * @param topic 
+     * @param payload 
+     * @param length 
+     * @param qos 
+     * @param retain 
+     * @return int non-zero return if the will could not be set
+     */
+    int setWill(const char* topic, const void* payload, int length, int qos, bool retain);
+
+    /**
+     * @brief Sets the handler for messages on subscribed topics
+     * 
+     * @param handler 
+     * @param context Passed to the handler
+     */
+    void setMessageHandler(MqttMessageHandler handler, void* context);
+
+    /**
+     * @brief Sets the handler for lost connections
+     * 
+     * @param handler 
+     * @param context Passed to the handler
+     */
+    void setDisconnectHandler(MqttDisconnectHandler handler, void* context);
+
+    /**
+     * @brief Starts connecting to the broker in the background. Lost connections are retried automatically.
+     * 
+     * @return int non-zero return if the connection could not be started
+     */
+    int connect();
+
+    /**
+     * @brief Disconnect from the broker
+     * 
+     */
+    void disconnect();
+
+    /**
+     * @brief Check if the broker connection is currently up
+     * 
+     * @return bool 
+     */
+    bool isConnected();
+
+    /**
+     * @brief Get the session counter, incremented on every successful connection to the broker.
+     * Lets publishers notice a reconnect and restate anything the broker has lost.
+     * 
+     * @return uint32_t 
+     */
+    uint32_t getSession();
+
+    /**
+     * @brief Queue a message for publishing. The payload is copied before returning.
+     * 
+     * @param topic 
+     * @param payload 
+     * @param length 
+     * @param qos 
+     * @param retain 
+     * @return int non-zero return if the message could not be queued
+     */
+    int publish(const char* topic, const void* payload, int length, int qos, bool retain);
+
+    /**
+     * @brief Subscribe to a topic. Subscriptions are not restored after a reconnect.
+     * 
+     * @param topic 
+     * @param qos 
+     * @return int non-zero return if the subscription failed
+     */
+    int subscribe(const char* topic, int qos);
+};
+
+#endif /* MQTTCONNECTION */
@@ -0,0 +1,256 @@
+/*
+ * File: ProfiledModbusClient.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef PROFILEDMODBUSCLIENT
+#define PROFILEDMODBUSCLIENT
+
+#include <chrono>
+#include <mutex>
+#include "Executor.h"
+#include "ModbusConnection.h"
+#include "SparkplugNode.h"
+#include "ConfigStore.h"
+#include "Schedule.h"
+#include "DeviceProfile.h"
+#include "ModbusGroups.h"
+
+#define PROFILE_MAX_DEVICES 32
+// Longest wait between executions, so disabled devices and settings changes are picked up
+#define PROFILE_MAX_WAIT 1000
+// Time devices are given to act on a broadcast before it is verified, the shed only serves the bus every 500ms
+#define GROUP_VERIFY_DELAY 1000
+#define SCENE_NOT_HELD -1
+// Shortest time between copies of the state for a checkpoint
+#define CHECKPOINT_STAGE_TIME 1000
+#define CHECKPOINT_PROFILE_LENGTH 32
+// Failed reads in a row before a device is reported offline
+#define PROFILE_OFFLINE_FAILURES 3
+// Longest published metric name, with the label of the device
+#define PROFILE_METRIC_NAME_LENGTH 128
+
+/**
+ * @brief How well a device has been answering
+ * 
+ */
+typedef struct {
+    bool enabled;
+    bool online;                            // Answered at least one of its last PROFILE_OFFLINE_FAILURES reads
+    uint32_t reads;                         // Reads of a group that succeeded
+    uint32_t failures;                      // Reads of a group that failed
+    uint32_t consecutiveFailures;           // Failed reads since the last good one
+    int64_t lastRead;                       // Wall clock milliseconds of the last good read, 0 if never
+} DeviceHealth_t;
+
+/**
+ * @brief The state of a single device polled by a ProfiledModbusClient
+ * 
+ */
+typedef struct {
+    const DeviceProfile_t* profile;
+    int slaveId;
+    char name[CONFIG_STRING_LENGTH];        // Section of the hub configuration with the settings of the device
+    char metricNames[PROFILE_MAX_METRICS][PROFILE_METRIC_NAME_LENGTH];
+    uint16_t registers[PROFILE_TABLE_COUNT][PROFILE_TABLE_SIZE];
+    chrono::steady_clock::time_point deadlines[PROFILE_MAX_GROUPS];
+    uint8_t validGroups;                    // Groups read since the hub started or restored from a checkpoint, a bit each
+    uint8_t readGroups;                     // Groups read since the hub started
+    int aliases[PROFILE_MAX_METRICS];
+    uint32_t uptimes[PROFILE_MAX_METRICS];  // Last raw value of each METRIC_UPTIME
+    uint16_t eventSequence;
+    uint32_t eventUptime;
+    bool synced;                            // Whether the event log has been read since the device was last read in full
+    Schedule schedule;
+    uint32_t configVersion;
+    bool scheduled;
+    uint16_t groupPending;                  // Sequence of a group command not verified yet, 0 if none
+    int32_t heldTarget;                     // Schedule level a scene replaced, held until the schedule moves on, or SCENE_NOT_HELD
+    DeviceHealth_t health;
+} ProfiledDevice_t;
+
+/**
+ * @brief The state of a device kept across restarts. Settings and schedules come from the configuration
+ * and the clock, so only what was learned from the device and what is still owed to it is kept.
+ * 
+ */
+typedef struct {
+    char profile[CHECKPOINT_PROFILE_LENGTH];    // With the slave id, identifies the device on the bus
+    int32_t slaveId;
+    uint8_t validGroups;
+    uint16_t registers[PROFILE_TABLE_COUNT][PROFILE_TABLE_SIZE];
+    uint16_t eventSequence;
+    uint32_t eventUptime;
+    bool synced;
+    uint16_t groupPending;
+    int32_t heldTarget;
+} DeviceCheckpoint_t;
+
+/**
+ * @brief The state of every device on a bus and the last scene sent to them
+ * 
+ */
+typedef struct {
+    uint8_t deviceCount;
+    SceneConfig_t scene;
+    GroupCommand_t groupCommand;
+    uint16_t groupSequence;
+    DeviceCheckpoint_t devices[PROFILE_MAX_DEVICES];
+} ClientCheckpoint_t;
+
+/**
+ * @brief Polls any number of devices on a connection from their profiles. Every group of registers is read
+ * at its own rate, metrics are published as their groups are read, and writes follow the policies of the profile.
+ * A single client and thread serves each bus, so buses are polled in parallel.
+ * Scenes are broadcast to every device on the bus in one frame, then verified with the next read of each device.
+ * 
+ */
+class ProfiledModbusClient : Executor
+{
+private:
+    ModbusConnection* connection;
+    SparkplugNode* node;
+    ConfigStore* configStore;
+    int bus;
+    // Statistics of the bus, published under its own names so every bus can be told apart
+    char requestsName[SPARKPLUG_STRING_LENGTH];
+    char failuresName[SPARKPLUG_STRING_LENGTH];
+    char reconnectsName[SPARKPLUG_STRING_LENGTH];
+    int requestsAlias;
+    int failuresAlias;
+    int reconnectsAlias;
+    uint32_t reconnects;                    // Reconnects of the bus already caught up on
+    ProfiledDevice_t devices[PROFILE_MAX_DEVICES];
+    uint8_t deviceCount;
+    SceneConfig_t scene;                    // The last scene sent
+    GroupCommand_t groupCommand;            // The command of that scene, written to devices that missed it
+    uint16_t groupSequence;
+    // Copy of the state taken by the polling thread, so a checkpoint can be written and the status served from others
+    mutex checkpointLock;
+    ClientCheckpoint_t checkpoint;
+    DeviceHealth_t health[PROFILE_MAX_DEVICES];
+    int64_t stagedAt;                       // Wall clock milliseconds of the copy
+    bool checkpointStaged;
+    chrono::steady_clock::time_point stageTime;
+    chrono::steady_clock::time_point startTime;
+    bool polled;                            // Whether every enabled device has been read in full since the start
+    int readGroup(ProfiledDevice_t& device, const ProfileGroup_t& group);
+    void publishGroup(ProfiledDevice_t& device, const ProfileGroup_t& group, bool cached = false);
+    void readEvents(ProfiledDevice_t& device);
+    void writeDevice(ProfiledDevice_t& device, const HubConfig_t& config, uint32_t version, chrono::steady_clock::time_point now);
+    void writeScene(const HubConfig_t& config, chrono::steady_clock::time_point now);
+    void verifyScene(ProfiledDevice_t& device, const ProfileGroup_t& group);
+    void stageCheckpoint(chrono::steady_clock::time_point now);
+protected:
+    int32_t doExecute();
+public:
+    /**
+     * @brief Construct a new client for a single bus
+     * 
+     * @param connection The connection of the bus
+     * @param node Node the metrics are published to, or NULL to only poll
+     * @param configStore Settings of the devices, or NULL for the defaults
+     * @param bus Index of the bus, used to name its statistics
+     */
+    ProfiledModbusClient(ModbusConnection* connection, SparkplugNode* node, ConfigStore* configStore, int bus = 0);
+
+    /**
+     * @brief Adds a device to poll. Its metrics are added to the node straight away
+     * 
+     * @param profile The profile of the device, must outlive the client
+     * @param name The name of the device section in the hub configuration
+     * @param slaveId The slave id of the device, or -1 for the default of the profile
+     * @param label Added after the profile name of every metric, so devices of the same profile publish apart.
+     * NULL publishes the metric names of the profile
+     * @return int The index of the device, or -1 if the profile does not fit
+     */
+    int addDevice(const DeviceProfile_t* profile, const char* name, int slaveId = -1, const char* label = NULL);
+
+    /**
+     * @brief Gets the index of the bus the client serves
+     * 
+     */
+    int getBus();
+
+    /**
+     * @brief Copies the latest state of the devices. Safe to call while the client is running
+     * 
+     * @param checkpoint 
+     * @return int 0 on success, or -1 if the client has not taken one yet
+     */
+    int getCheckpoint(ClientCheckpoint_t* checkpoint);
+
+    /**
+     * @brief Copies the health of the devices, taken along with the latest checkpoint. Safe to call while the client is running
+     * 
+     * @param health At least PROFILE_MAX_DEVICES long
+     * @param stagedAt Populated with the wall clock milliseconds the copy was taken
+     * @return int The number of devices, or -1 if the client has not taken a copy yet
+     */
+    int getHealth(DeviceHealth_t* health, int64_t* stagedAt);
+
+    /**
+     * @brief Gets the profile of a device
+     * 
+     * @param index 
+     * @return const DeviceProfile_t* The profile, or NULL if there is no such device
+     */
+    const DeviceProfile_t* getProfile(int index);
+
+    /**
+     * @brief Gets the name of the device section of a device, such as bed2 for [device.bed2]
+     * 
+     * @param index 
+     * @return const char* The name, or NULL if there is no such device
+     */
+    const char* getName(int index);
+
+    /**
+     * @brief Gets the connection of the bus the client serves
+     * 
+     */
+    ModbusConnection* getConnection();
+
+    /**
+     * @brief Picks up the state saved before a restart, and publishes the metrics it holds straight away.
+     * Devices are matched by profile and slave id, and every group is still read on the first execute.
+     * Must be called after the devices are added and before the client runs.
+     * 
+     * @param checkpoint 
+     * @return int The number of devices restored
+     */
+    int restore(const ClientCheckpoint_t& checkpoint);
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* PROFILEDMODBUSCLIENT */
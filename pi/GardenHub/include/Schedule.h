@@ -0,0 +1,187 @@
+/*
+ * File: Schedule.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef SCHEDULE
+#define SCHEDULE
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+using namespace std;
+
+#define SCHEDULE_MAX_EVENTS 8
+// Deadlines are never further out than this, so a wall clock step (such as the first NTP sync
+// on a board without an RTC) is corrected within this many seconds
+#define SCHEDULE_MAX_DEADLINE 900
+// Shortest step between levels while ramping, in seconds
+#define SCHEDULE_RAMP_STEP 1
+// Levels are light intensities as a percentage
+#define SCHEDULE_MAX_LEVEL 100
+
+// What the time of an event is relative to
+enum ScheduleAnchor
+{
+    ANCHOR_MIDNIGHT,
+    ANCHOR_SUNRISE,
+    ANCHOR_SUNSET
+};
+
+/**
+ * @brief A single transition of a program, repeated daily
+ * 
+ */
+typedef struct {
+    uint8_t anchor;         // A ScheduleAnchor
+    int32_t offset;         // Minutes after the anchor, may be negative
+    int32_t level;          // Level once the event has completed
+    int32_t ramp;           // Seconds to ramp from the previous level, 0 to step
+} ScheduleEvent_t;
+
+/**
+ * @brief The daily program of a single device
+ * 
+ */
+typedef struct {
+    ScheduleEvent_t events[SCHEDULE_MAX_EVENTS];
+    uint8_t count;
+} ScheduleProgram_t;
+
+/**
+ * @brief Parses a program of comma separated events, each `<time> <level> [ramp seconds]`.
+ * Times are HH:MM, or sunrise/sunset with an optional minute offset such as sunset-30.
+ * Levels are 0 to SCHEDULE_MAX_LEVEL. e.g. "sunset-15 45 600, 22:00 0 300"
+ * 
+ * @param text 
+ * @param program 
+ * @return int 0 on success, -1 if the program is invalid
+ */
+int parseScheduleProgram(const char* text, ScheduleProgram_t* program);
+
+/**
+ * @brief Calculates sunrise and sunset for a day, accurate to a few minutes away from the poles
+ * 
+ * @param year 
+ * @param month 1 to 12
+ * @param day 
+ * @param latitude Degrees, north positive
+ * @param longitude Degrees, east positive
+ * @param sunrise Populated with the sunrise
+ * @param sunset Populated with the sunset
+ * @return int 0 on success, -1 if the sun does not rise or set that day
+ */
+int sunTimes(int year, int month, int day, double latitude, double longitude, time_t* sunrise, time_t* sunset);
+
+/**
+ * @brief Evaluates a program. The level and the instant it next changes are only calculated at
+ * transitions, so checking a schedule costs a single comparison against a monotonic deadline.
+ * Ramps are either stepped by the schedule, or handed to a device that fades by itself.
+ * 
+ */
+class Schedule
+{
+private:
+    ScheduleProgram_t program;
+    double latitude;
+    double longitude;
+    int32_t level;
+    int32_t target;
+    chrono::steady_clock::time_point deadline;
+    chrono::steady_clock::time_point rampEnd;
+    bool valid;
+    bool deviceRamps;
+    int eventTimes(const struct tm* date, time_t* times);
+public:
+    /**
+     * @brief Construct a new Schedule
+     * 
+     * @param deviceRamps true if the device ramps to the target itself, so there are no deadlines part way through a ramp
+     */
+    Schedule(bool deviceRamps = false);
+
+    /**
+     * @brief Sets the program to follow, which is evaluated on the next update
+     * 
+     * @param program 
+     * @param latitude Degrees, north positive
+     * @param longitude Degrees, east positive
+     */
+    void setProgram(const ScheduleProgram_t& program, double latitude, double longitude);
+
+    /**
+     * @brief Check if the level may have changed since the last update
+     * 
+     * @param now 
+     * @return true if update needs to be called
+     */
+    inline bool due(chrono::steady_clock::time_point now) const { return !valid || now >= deadline; }
+
+    /**
+     * @brief Evaluates the program at the current time, and calculates the next deadline
+     * 
+     * @param wallNow The current wall clock time
+     * @param now The current monotonic time
+     * @return int32_t The level at the current time
+     */
+    int32_t update(time_t wallNow, chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Get the level from the last update
+     * 
+     * @return int32_t 
+     */
+    inline int32_t getLevel() const { return level; }
+
+    /**
+     * @brief Get the level the current ramp ends at, the level itself when not ramping
+     * 
+     * @return int32_t 
+     */
+    inline int32_t getTarget() const { return target; }
+
+    /**
+     * @brief Get the milliseconds left of the current ramp
+     * 
+     * @param now 
+     * @return int32_t 0 when not ramping
+     */
+    int32_t untilRampEnd(chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief Get the milliseconds until the next deadline
+     * 
+     * @param now 
+     * @return int32_t 0 if already due
+     */
+    int32_t untilDeadline(chrono::steady_clock::time_point now) const;
+};
+
+#endif /* SCHEDULE */
@@ -0,0 +1,168 @@
+/*
+ * File: SparkplugNode.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef SPARKPLUGNODE
+#define SPARKPLUGNODE
+
+#include <mutex>
+#include <string>
+#include "Executor.h"
+#include "MqttConnection.h"
+#include "SparkplugPayload.h"
+#include "Units.h"
+
+#define SPARKPLUG_NAMESPACE "spBv1.0"
+#define SPARKPLUG_TOPIC_LENGTH 128
+#define SPARKPLUG_MAX_METRICS 64
+#define SPARKPLUG_BUFFER_SIZE 8192
+// Longest value of a SPARKPLUG_STRING metric, including the terminator
+#define SPARKPLUG_STRING_LENGTH 32
+#define SPARKPLUG_QOS 0
+// Delay between NDATA payloads. Every change within this window is batched into a single payload
+#define SPARKPLUG_PUBLISH_TIME 1000
+// Delay between checks while the broker is unreachable
+#define SPARKPLUG_RETRY_TIME 1000
+// bdSeq wraps after 255, so every connection of every start has a different one from the last
+#define SPARKPLUG_BIRTH_SEQUENCE_MAX 255
+
+#define SPARKPLUG_BIRTH_SEQUENCE_NAME "bdSeq"
+#define SPARKPLUG_REBIRTH_NAME "Node Control/Rebirth"
+
+typedef struct {
+    uint64_t payloads;      // NDATA payloads published
+    uint64_t metrics;       // Metrics published in NDATA payloads
+    uint64_t bytes;         // Bytes of NDATA payloads published
+    uint64_t births;        // NBIRTH payloads published
+    uint64_t failures;      // Payloads that failed to encode or publish
+} SparkplugStatistics_t;
+
+/**
+ * @brief A Sparkplug B edge node. Metrics are only published when they change (report by exception),
+ * and every change since the last publish is batched into a single NDATA payload.
+ * The payload buffer is owned by the node and reused for every message.
+ * 
+ */
+class SparkplugNode : Executor
+{
+private:
+    MqttConnection* connection;
+    char birthTopic[SPARKPLUG_TOPIC_LENGTH];
+    char dataTopic[SPARKPLUG_TOPIC_LENGTH];
+    char deathTopic[SPARKPLUG_TOPIC_LENGTH];
+    char commandTopic[SPARKPLUG_TOPIC_LENGTH];
+    SparkplugMetric_t metrics[SPARKPLUG_MAX_METRICS];
+    int64_t deadbands[SPARKPLUG_MAX_METRICS];
+    bool changed[SPARKPLUG_MAX_METRICS];
+    char strings[SPARKPLUG_MAX_METRICS][SPARKPLUG_STRING_LENGTH];
+    uint16_t metricCount;
+    uint16_t changedCount;
+    uint8_t sequence;
+    uint32_t birthSession;
+    bool rebirth;
+    string sequencePath;
+    uint8_t buffer[SPARKPLUG_BUFFER_SIZE];
+    SparkplugPayload payload;
+    SparkplugStatistics_t statistics;
+    mutex metricsLock;
+    int publishBirth(uint64_t timestamp);
+    int publishData(uint64_t timestamp);
+    int setWill();
+    static void onCommand(const char* topic, const void* payload, int length, void* context);
+    static void onDisconnect(void* context);
+protected:
+    int32_t doExecute();
+public:
+    SparkplugNode(MqttConnection* connection, const char* group, const char* node);
+
+    /**
+     * @brief Sets the NDEATH will and starts connecting to the broker.
+     * Every connection, including each reconnect, publishes its NBIRTH and NDEATH with the next bdSeq.
+     * 
+     * @param sequencePath File the last bdSeq is kept in, so it keeps counting across restarts. NULL or empty to start from 0
+     * @return int non-zero return if the connection could not be started
+     */
+    int connect(const char* sequencePath);
+
+    /**
+     * @brief Adds a metric to the node. Adding a metric after the node has been born triggers a rebirth.
+     * 
+     * @param name Name of the metric, must outlive the node
+     * @param datatype A SparkplugDataType
+     * @param exponent Power of ten of the values, for SPARKPLUG_FLOAT metrics
+     * @param deadband Changes smaller than this, in raw values, are not published
+     * @return int The alias of the metric, or -1 if there is no room for it
+     */
+    int addMetric(const char* name, uint8_t datatype, int8_t exponent = 0, int64_t deadband = 0);
+
+    /**
+     * @brief Updates the value of a metric. It is published in the next payload if it changed.
+     * 
+     * @param alias 
+     * @param value 
+     */
+    void update(int alias, int64_t value);
+
+    /**
+     * @brief Updates the value of a metric from a measurement, rescaled to the exponent of the metric
+     * 
+     * @param alias 
+     * @param measurement 
+     */
+    void update(int alias, const Measurement_t& measurement);
+
+    /**
+     * @brief Updates the value of a SPARKPLUG_STRING metric. The string is copied, truncated to SPARKPLUG_STRING_LENGTH
+     * 
+     * @param alias 
+     * @param value 
+     */
+    void update(int alias, const char* value);
+
+    /**
+     * @brief Publishes an NBIRTH if the node has not been born this session, otherwise an NDATA of every changed metric
+     * 
+     * @return int non-zero return if publishing failed
+     */
+    int publish();
+
+    /**
+     * @brief Get the publishing statistics
+     * 
+     * @return SparkplugStatistics_t 
+     */
+    SparkplugStatistics_t getStatistics();
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* SPARKPLUGNODE */
@@ -0,0 +1,145 @@
+/*
+ * File: SparkplugPayload.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#ifndef SPARKPLUGPAYLOAD
+#define SPARKPLUGPAYLOAD
+
+#include <cstdint>
+#include <cstddef>
+
+// Sparkplug B metric datatypes used by the hub
+enum SparkplugDataType
+{
+    SPARKPLUG_INT32 = 3,
+    SPARKPLUG_UINT64 = 8,
+    SPARKPLUG_FLOAT = 9,
+    SPARKPLUG_BOOLEAN = 11,
+    SPARKPLUG_STRING = 12
+};
+
+/**
+ * @brief A single Sparkplug metric. Fixed point values are stored with their power of ten
+ * and only converted to a float when the metric is encoded.
+ * 
+ */
+typedef struct {
+    const char* name;       // Must outlive the metric, only sent in births
+    uint64_t timestamp;     // Milliseconds since the epoch of the last change
+    int64_t value;
+    uint16_t alias;
+    uint8_t datatype;
+    int8_t exponent;        // Power of ten of value, for SPARKPLUG_FLOAT metrics
+    const char* string;     // Null terminated value of SPARKPLUG_STRING metrics
+} SparkplugMetric_t;
+
+/**
+ * @brief Encodes a Sparkplug B protobuf payload directly into a caller owned buffer.
+ * Nothing is allocated, so the same buffer can be reused for every message.
+ * 
+ */
+class SparkplugPayload
+{
+private:
+    uint8_t* buffer;
+    size_t size;
+    size_t length;
+    bool overflow;
+    void writeByte(uint8_t value);
+    void writeVarint(uint64_t value);
+    void writeFixed32(uint32_t value);
+    void writeBytes(const void* data, size_t size);
+public:
+    SparkplugPayload(uint8_t* buffer, size_t size);
+
+    /**
+     * @brief Starts a new payload, discarding anything previously encoded
+     * 
+     * @param timestamp Milliseconds since the epoch
+     */
+    void begin(uint64_t timestamp);
+
+    /**
+     * @brief Adds a metric to the payload.
+     * Births carry the name, alias and datatype of a metric, while data messages only carry the alias.
+     * 
+     * @param metric 
+     * @param birth 
+     */
+    void addMetric(const SparkplugMetric_t* metric, bool birth);
+
+    /**
+     * @brief Completes the payload
+     * 
+     * @param sequence The payload sequence number, or -1 for payloads without one such as NDEATH
+     * @return int The length of the payload, or -1 if it did not fit in the buffer
+     */
+    int finish(int sequence);
+};
+
+/**
+ * @brief A metric decoded from a received payload, such as an NCMD. Only the fields the hub acts on are kept.
+ * 
+ */
+typedef struct {
+    const char* name;       // Points into the payload and is not null terminated. NULL if the metric was sent by alias
+    size_t nameLength;
+    bool hasAlias;
+    uint64_t alias;
+    uint32_t datatype;      // A SparkplugDataType, 0 if it was not sent
+    bool hasBoolean;
+    bool boolean;           // The boolean value, if hasBoolean
+} SparkplugReceivedMetric_t;
+
+/**
+ * @brief Decodes the metrics of a received Sparkplug B protobuf payload in place, one at a time.
+ * Fields the hub does not use are skipped.
+ * 
+ */
+class SparkplugPayloadReader
+{
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t position;
+public:
+    SparkplugPayloadReader(const void* data, size_t length);
+
+    /**
+     * @brief Decodes the next metric of the payload
+     * 
+     * @param metric Populated with the metric
+     * @return int 1 if a metric was decoded, 0 at the end of the payload, or -1 if the payload is malformed
+     */
+    int nextMetric(SparkplugReceivedMetric_t* metric);
+};
+
+#endif /* SPARKPLUGPAYLOAD */
@@ -0,0 +1,126 @@
+/*
+ * File: StatusServer.h
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#ifndef STATUSSERVER
+#define STATUSSERVER
+
+#include <chrono>
+#include "Executor.h"
+#include "ProfiledModbusClient.h"
+#include "HubConfig.h"
+using namespace std;
+
+#define STATUS_MAX_CLIENTS 16
+#define STATUS_POLL_TIMEOUT 1000
+#define STATUS_BACKLOG 16
+#define STATUS_REQUEST_LENGTH 1024
+// Large enough for every metric of PROFILE_MAX_DEVICES devices on each bus
+#define STATUS_RESPONSE_LENGTH 262144
+// Shortest time between serialising the status again, requests in between are sent the same response
+#define STATUS_CACHE_TIME 250
+// Longest a client may take to send its request or take the response
+#define STATUS_CLIENT_TIMEOUT 2000
+
+/**
+ * @brief A connected HTTP client, dropped once it has been answered
+ * 
+ */
+typedef struct {
+    int socket;
+    char request[STATUS_REQUEST_LENGTH];
+    uint16_t length;
+    chrono::steady_clock::time_point accepted;
+} StatusClient_t;
+
+/**
+ * @brief Serves the current values, health and bus statistics of every device as JSON over HTTP.
+ * 
+ * The status is built from the copies the clients stage for the checkpoint and from the statistics
+ * of their connections, so a request never waits for a bus or holds up a poll. Everything is
+ * allocated when the server starts listening, and the response is reused for STATUS_CACHE_TIME.
+ * 
+ */
+class StatusServer : Executor
+{
+private:
+    int listener;
+    StatusClient_t clients[STATUS_MAX_CLIENTS];
+    ProfiledModbusClient* modbusClients[HUB_MAX_BUSES];
+    uint8_t modbusClientCount;
+    // Copies of the state of one client at a time, taken from the client and read while serialising
+    ClientCheckpoint_t* snapshot;
+    DeviceHealth_t health[PROFILE_MAX_DEVICES];
+    char* response;
+    size_t responseLength;
+    bool overflowed;
+    chrono::steady_clock::time_point startTime;
+    chrono::steady_clock::time_point builtTime;
+    bool built;
+    void accept();
+    void receive(uint8_t client);
+    void answer(uint8_t client);
+    void send(uint8_t client, const char* status, const char* body, size_t length);
+    void drop(uint8_t client);
+    void build();
+    void buildDevice(ProfiledModbusClient* modbusClient, int index, int64_t stagedAt);
+    void append(const char* format, ...);
+    void appendString(const char* value);
+    void appendMeasurement(const Measurement_t& measurement);
+protected:
+    int32_t doExecute();
+public:
+    StatusServer();
+    ~StatusServer();
+
+    /**
+     * @brief Adds the devices and statistics of a bus to the status
+     * 
+     * @param modbusClient Must outlive the server
+     * @return int non-zero return if there is no room for another bus
+     */
+    int addClient(ProfiledModbusClient* modbusClient);
+
+    /**
+     * @brief Starts listening for requests
+     * 
+     * @param address IPv4 address to listen on
+     * @param port 
+     * @return int non-zero return if the socket could not be opened
+     */
+    int listen(const char* address, int port);
+
+    using Executor::execute;
+    using Executor::executeSync;
+};
+
+#endif /* STATUSSERVER */
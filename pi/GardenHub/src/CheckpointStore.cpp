@@ -0,0 +1,271 @@
+/*
+ * File: CheckpointStore.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "CheckpointStore.h"
+#include "Logger.h"
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CHECKPOINT_STORE "Checkpoint Store: "
+
+// The start of a client record, everything before its devices
+#define CLIENT_PREFIX_SIZE offsetof(ClientCheckpoint_t, devices)
+#define CLIENT_RECORD_SIZE(deviceCount) (sizeof(int32_t) + CLIENT_PREFIX_SIZE + (deviceCount) * sizeof(DeviceCheckpoint_t))
+#define CHECKPOINT_MAX_LENGTH (HUB_MAX_BUSES * CLIENT_RECORD_SIZE(PROFILE_MAX_DEVICES))
+
+#define CRC32_POLYNOMIAL 0xEDB88320
+
+static uint32_t crc32(uint32_t crc, const void* data, size_t length)
+{
+    const uint8_t* bytes = (const uint8_t*) data;
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+        }
+    }
+
+    return ~crc;
+}
+
+CheckpointStore::CheckpointStore(const char* path, int32_t period) : path(path), period(period), clientCount(0), savedCrc(0), savedLength(0)
+{
+    checkpoints = new ClientCheckpoint_t[HUB_MAX_BUSES];
+}
+
+CheckpointStore::~CheckpointStore()
+{
+    delete[] checkpoints;
+}
+
+int CheckpointStore::addClient(ProfiledModbusClient* client)
+{
+    if (clientCount >= HUB_MAX_BUSES)
+    {
+        return -1;
+    }
+
+    clients[clientCount++] = client;
+    return 0;
+}
+
+int CheckpointStore::restore()
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    CheckpointHeader_t header;
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == NULL)
+    {
+        // No checkpoint yet is normal on a first start
+        if (errno != ENOENT)
+        {
+            HUB_LOG(LOG_LEVEL_WARNING, CHECKPOINT_STORE "unable to read %s. Error: %s", path.c_str(), strerror(errno));
+        }
+        return -1;
+    }
+
+    uint8_t* body = NULL;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CHECKPOINT_MAGIC && header.version == CHECKPOINT_VERSION &&
+        header.clientSize == CLIENT_PREFIX_SIZE && header.deviceSize == sizeof(DeviceCheckpoint_t) && header.length <= CHECKPOINT_MAX_LENGTH;
+
+    if (valid)
+    {
+        body = new uint8_t[header.length];
+        valid = fread(body, 1, header.length, file) == header.length && crc32(0, body, header.length) == header.crc;
+    }
+
+    fclose(file);
+
+    if (!valid)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, CHECKPOINT_STORE "ignoring %s, it is damaged or from another version", path.c_str());
+        delete[] body;
+        return -1;
+    }
+
+    int64_t age = (int64_t) time(NULL) - header.savedAt;
+
+    if (age < 0 || age > CHECKPOINT_MAX_AGE)
+    {
+        HUB_LOG(LOG_LEVEL_INFO, CHECKPOINT_STORE "ignoring %s, it was saved %llds ago", path.c_str(), (long long) age);
+        delete[] body;
+        return -1;
+    }
+
+    int restored = 0;
+    size_t offset = 0;
+
+    for (uint16_t c = 0; c < header.clientCount && offset + CLIENT_RECORD_SIZE(0) <= header.length; c++)
+    {
+        ClientCheckpoint_t& checkpoint = checkpoints[0];
+        int32_t bus;
+
+        memcpy(&bus, &body[offset], sizeof(bus));
+        memcpy(&checkpoint, &body[offset + sizeof(bus)], CLIENT_PREFIX_SIZE);
+
+        if (checkpoint.deviceCount > PROFILE_MAX_DEVICES || offset + CLIENT_RECORD_SIZE(checkpoint.deviceCount) > header.length)
+        {
+            break;
+        }
+
+        memcpy(checkpoint.devices, &body[offset + sizeof(bus) + CLIENT_PREFIX_SIZE], checkpoint.deviceCount * sizeof(DeviceCheckpoint_t));
+        offset += CLIENT_RECORD_SIZE(checkpoint.deviceCount);
+
+        // A bus that no longer has a port is skipped, its devices are gone until it comes back
+        for (uint8_t i = 0; i < clientCount; i++)
+        {
+            if (clients[i]->getBus() == bus)
+            {
+                restored += clients[i]->restore(checkpoint);
+            }
+        }
+    }
+
+    delete[] body;
+
+    HUB_LOG(LOG_LEVEL_INFO, CHECKPOINT_STORE "restored %d devices from %llds ago in %dms", restored, (long long) age,
+        (int) chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count());
+
+    return restored;
+}
+
+int CheckpointStore::save()
+{
+    lock_guard<mutex> guard(saveLock);
+    CheckpointHeader_t header;
+    bool taken[HUB_MAX_BUSES];
+    uint16_t count = 0;
+    uint32_t crc = 0;
+    uint32_t length = 0;
+
+    // Copied from every client first, so the file can be skipped when nothing changed
+    for (uint8_t i = 0; i < clientCount; i++)
+    {
+        taken[i] = clients[i]->getCheckpoint(&checkpoints[i]) == 0;
+
+        if (taken[i])
+        {
+            int32_t bus = clients[i]->getBus();
+
+            crc = crc32(crc, &bus, sizeof(bus));
+            crc = crc32(crc, &checkpoints[i], CLIENT_PREFIX_SIZE);
+            crc = crc32(crc, checkpoints[i].devices, checkpoints[i].deviceCount * sizeof(DeviceCheckpoint_t));
+            length += CLIENT_RECORD_SIZE(checkpoints[i].deviceCount);
+            count++;
+        }
+    }
+
+    if (count == 0 || (crc == savedCrc && length == savedLength))
+    {
+        return 0;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.clientCount = count;
+    header.clientSize = CLIENT_PREFIX_SIZE;
+    header.deviceSize = sizeof(DeviceCheckpoint_t);
+    header.savedAt = time(NULL);
+    header.length = length;
+    header.crc = crc;
+
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CHECKPOINT_STORE "unable to write %s. Error: %s", temporary.c_str(), strerror(errno));
+        return -1;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (uint8_t i = 0; written && i < clientCount; i++)
+    {
+        if (!taken[i])
+        {
+            continue;
+        }
+
+        int32_t bus = clients[i]->getBus();
+
+        written = fwrite(&bus, sizeof(bus), 1, file) == 1 && fwrite(&checkpoints[i], CLIENT_PREFIX_SIZE, 1, file) == 1 &&
+            fwrite(checkpoints[i].devices, sizeof(DeviceCheckpoint_t), checkpoints[i].deviceCount, file) == checkpoints[i].deviceCount;
+    }
+
+    // On disk before the rename, otherwise a power cut could leave the new name pointing at an empty file
+    written = written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    written = fclose(file) == 0 && written;
+
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CHECKPOINT_STORE "unable to save %s. Error: %s", path.c_str(), strerror(errno));
+        unlink(temporary.c_str());
+        return -1;
+    }
+
+    // The rename itself is only durable once the directory is synced
+    size_t separator = path.find_last_of('/');
+    int directory = open(separator == string::npos ? "." : path.substr(0, separator == 0 ? 1 : separator).c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (directory >= 0)
+    {
+        fsync(directory);
+        close(directory);
+    }
+
+    savedCrc = crc;
+    savedLength = length;
+
+    return 0;
+}
+
+int32_t CheckpointStore::doExecute()
+{
+    save();
+    return period;
+}
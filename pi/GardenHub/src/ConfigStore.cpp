@@ -0,0 +1,220 @@
+/*
+ * File: ConfigStore.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "ConfigStore.h"
+#include <cstring>
+#include <cerrno>
+#include "Logger.h"
+#include <poll.h>
+#include <sys/inotify.h>
+
+#define CONFIG_STORE "Config Store: "
+
+#define EVENT_BUFFER_SIZE 4096
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+
+ConfigStore::ConfigStore(const char* path) : path(path), inotifyDescriptor(-1), current(defaults()), version(0)
+{
+    size_t separator = this->path.find_last_of('/');
+
+    directory = separator == string::npos ? "." : this->path.substr(0, separator == 0 ? 1 : separator);
+    fileName = separator == string::npos ? this->path : this->path.substr(separator + 1);
+}
+
+ConfigStore::~ConfigStore()
+{
+    if (inotifyDescriptor >= 0)
+    {
+        close(inotifyDescriptor);
+    }
+}
+
+shared_ptr<const HubConfig_t> ConfigStore::defaults()
+{
+    static shared_ptr<const HubConfig_t> snapshot = [] () {
+        shared_ptr<HubConfig_t> config = make_shared<HubConfig_t>();
+        defaultHubConfig(config.get());
+        return shared_ptr<const HubConfig_t>(config);
+    }();
+
+    return snapshot;
+}
+
+int ConfigStore::reload()
+{
+    shared_ptr<HubConfig_t> config = make_shared<HubConfig_t>();
+    int result = loadHubConfig(path.c_str(), config.get());
+
+    if (result != 0)
+    {
+        return result;
+    }
+
+    shared_ptr<const HubConfig_t> previous = get();
+
+    if (memcmp(previous->modbus, config->modbus, sizeof(config->modbus)) != 0 || memcmp(&previous->mqtt, &config->mqtt, sizeof(MqttConfig_t)) != 0 ||
+        memcmp(&previous->gateway, &config->gateway, sizeof(GatewayConfig_t)) != 0 || memcmp(&previous->status, &config->status, sizeof(StatusConfig_t)) != 0 ||
+        memcmp(&previous->checkpoint, &config->checkpoint, sizeof(CheckpointConfig_t)) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, CONFIG_STORE "modbus, mqtt, gateway, status and checkpoint changes are only applied on restart");
+    }
+
+    bool devicesChanged = previous->deviceCount != config->deviceCount;
+
+    for (int32_t i = 0; i < config->deviceCount && !devicesChanged; i++)
+    {
+        const DeviceConfig_t& before = previous->devices[i];
+        const DeviceConfig_t& after = config->devices[i];
+
+        devicesChanged = strcmp(before.name, after.name) != 0 || strcmp(before.profile, after.profile) != 0 ||
+            before.bus != after.bus || before.slaveId != after.slaveId;
+    }
+
+    if (devicesChanged)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, CONFIG_STORE "added and removed devices, and profile, bus and slave changes are only applied on restart");
+    }
+
+    atomic_store(&current, shared_ptr<const HubConfig_t>(config));
+    version++;
+
+    Logger::setLevel(config->log.level);
+
+    return 0;
+}
+
+int ConfigStore::load()
+{
+    int result = reload();
+
+    if (result < 0)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, CONFIG_STORE "unable to read %s, using the defaults", path.c_str());
+        return 0;
+    }
+
+    if (result > 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CONFIG_STORE "invalid configuration in %s", path.c_str());
+        return -1;
+    }
+
+    HUB_LOG(LOG_LEVEL_INFO, CONFIG_STORE "loaded %s", path.c_str());
+    return 0;
+}
+
+int ConfigStore::watch()
+{
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotifyDescriptor < 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CONFIG_STORE "unable to start watching for changes. Error: %s", std::strerror(errno));
+        return -1;
+    }
+
+    if (inotify_add_watch(inotifyDescriptor, directory.c_str(), WATCH_EVENTS) < 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CONFIG_STORE "unable to watch %s. Error: %s", directory.c_str(), std::strerror(errno));
+        close(inotifyDescriptor);
+        inotifyDescriptor = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+shared_ptr<const HubConfig_t> ConfigStore::get() const
+{
+    return atomic_load(&current);
+}
+
+uint32_t ConfigStore::getVersion() const
+{
+    return version;
+}
+
+int32_t ConfigStore::doExecute()
+{
+    alignas(struct inotify_event) char buffer[EVENT_BUFFER_SIZE];
+    pollfd descriptor = { inotifyDescriptor, POLLIN, 0 };
+    bool changed = false;
+
+    if (inotifyDescriptor < 0)
+    {
+        return CONFIG_WATCH_TIMEOUT;
+    }
+
+    if (poll(&descriptor, 1, CONFIG_WATCH_TIMEOUT) <= 0)
+    {
+        return 0;
+    }
+
+    // Collect every event until the writes settle, so a save only causes a single reload
+    do
+    {
+        ssize_t length;
+
+        while ((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* position = buffer; position < buffer + length; )
+            {
+                struct inotify_event* event = (struct inotify_event*) position;
+
+                if (event->len > 0 && fileName == event->name)
+                {
+                    changed = true;
+                }
+
+                position += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    } while (poll(&descriptor, 1, CONFIG_SETTLE_TIME) > 0);
+
+    if (!changed)
+    {
+        return 0;
+    }
+
+    int result = reload();
+
+    if (result == 0)
+    {
+        HUB_LOG(LOG_LEVEL_INFO, CONFIG_STORE "reloaded %s", path.c_str());
+    }
+    else if (result > 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, CONFIG_STORE "keeping the previous configuration, %s is invalid", path.c_str());
+    }
+
+    return 0;
+}
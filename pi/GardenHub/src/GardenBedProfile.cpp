@@ -1,7 +1,7 @@
 /*
- * File: GardenShedClient.h
+ * File: GardenBedProfile.cpp
  * Project: gardener
- * Created Date: Saturday November 12th 2022
+ * Created Date: Monday October 19th 2026
  * Author: Kyle Hofer
  * 
  * MIT License
@@ -29,26 +29,34 @@
  * HISTORY:
  */
 
-#ifndef GARDENSHED
-#define GARDENSHED
-
-#include "ModbusClient.h"
-#include "Executor.h"
-
-class GardenShedClient : ModbusClient, Executor
-{
-    private:
-    protected:
-        int32_t doExecute();
-        using ModbusClient::readInputRegisters;
-        using ModbusClient::readRegisters;
-        using ModbusClient::writeRegister;
-        using ModbusClient::writeRegisters;
-    public:
-        GardenShedClient();
-        GardenShedClient(ModbusConnection* connection);
-        using Executor::execute;
-        using Executor::executeSync;
+
+
+#include "DeviceProfile.h"
+#include "GardenBedCommon.h"
+
+using namespace GardenBed;
+
+static const ProfileGroup_t GROUPS[] = {
+    { TABLE_HOLDING_REGISTERS,  MODBUS_START_REGISTER,  TOTAL_HOLDING_REGISTERS,    PERIOD_POLL },
+    { TABLE_HOLDING_REGISTERS,  GROUP_REGISTERS_ADDRESS, GROUP_REGISTER_COUNT,      PERIOD_TELEMETRY }
 };
 
-#endif /* GARDENSHED */
+static const ProfileMetric_t METRICS[] = {
+    { "Garden Bed/Light Level", TABLE_HOLDING_REGISTERS, METRIC_NUMBER, { GARDEN_LIGHT_LEVEL, REGISTER_UINT16, UNIT_PERCENT, 0 }, 0 }
+};
+
+static const ProfileWrite_t WRITES[] = {
+    { GARDEN_LIGHT_COMMAND, WRITE_SCHEDULE, 0 },
+    { GROUP_REGISTER(GROUP_MEMBERSHIP), WRITE_GROUPS, 0 }
+};
+
+const DeviceProfile_t GARDEN_BED_PROFILE = {
+    "Garden Bed",
+    MODBUS_ID,
+    PROFILE_ENTRIES(GROUPS),
+    PROFILE_ENTRIES(METRICS),
+    PROFILE_ENTRIES(WRITES),
+    NO_EVENT_LOG, 0,
+    NULL, 0,
+    GROUP_REGISTERS_ADDRESS
+};
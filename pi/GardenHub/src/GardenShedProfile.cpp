@@ -0,0 +1,94 @@
+/*
+ * File: GardenShedProfile.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "DeviceProfile.h"
+#include "GardenShedCommon.h"
+
+using namespace GardenShed;
+
+// Power readings change every block from the charger, the identity only after a firmware update
+static const ProfileGroup_t GROUPS[] = {
+    { TABLE_INPUT_REGISTERS,    SHED_LIGHT_LEVEL,       SHED_EVENTS_END - SHED_LIGHT_LEVEL + 1,                 PERIOD_POLL },
+    { TABLE_INPUT_REGISTERS,    VICTRON_VOLTAGE_UPPER,  VICTRON_DAY_SEQUENCE - VICTRON_VOLTAGE_UPPER + 1,       PERIOD_TELEMETRY },
+    { TABLE_INPUT_REGISTERS,    VICTRON_OFF_REASON,     VICTRON_HEX_VALUE_LOWER - VICTRON_OFF_REASON + 1,       PERIOD_TELEMETRY },
+    { TABLE_INPUT_REGISTERS,    VICTRON_SERIAL_NUMBER,  VICTRON_FIRMWARE_END - VICTRON_SERIAL_NUMBER + 1,       3600000 },
+    { TABLE_HOLDING_REGISTERS,  MODBUS_START_REGISTER,  TOTAL_HOLDING_REGISTERS,                                PERIOD_TELEMETRY },
+    { TABLE_HOLDING_REGISTERS,  GROUP_REGISTERS_ADDRESS, GROUP_REGISTER_COUNT,                                  PERIOD_TELEMETRY }
+};
+
+static const ProfileMetric_t METRICS[] = {
+    { "Garden Shed/Battery Voltage",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_VOLTAGE_UPPER,        REGISTER_INT32,     UNIT_VOLT,              -3 }, 0 },
+    { "Garden Shed/Panel Voltage",          TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_PANEL_VOLTAGE_UPPER,  REGISTER_INT32,     UNIT_VOLT,              -3 }, 0 },
+    { "Garden Shed/Battery Current",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_CURRENT_UPPER,        REGISTER_INT32,     UNIT_AMP,               -3 }, 0 },
+    { "Garden Shed/Panel Power",            TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_PANEL_POWER,          REGISTER_UINT16,    UNIT_WATT,              0 }, 0 },
+    { "Garden Shed/Load Current",           TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_LOAD_CURRENT_UPPER,   REGISTER_INT32,     UNIT_AMP,               -3 }, 0 },
+    { "Garden Shed/Yield Total",            TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_YIELD_TOTAL_UPPER,    REGISTER_UINT32,    UNIT_KILOWATT_HOUR,     -2 }, 0 },
+    { "Garden Shed/Yield Today",            TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_YIELD_TODAY,          REGISTER_UINT16,    UNIT_KILOWATT_HOUR,     -2 }, 0 },
+    { "Garden Shed/Max Power Today",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_MAX_POWER_TODAY,      REGISTER_UINT16,    UNIT_WATT,              0 }, 0 },
+    { "Garden Shed/Yield Yesterday",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_YIELD_YESTERDAY,      REGISTER_UINT16,    UNIT_KILOWATT_HOUR,     -2 }, 0 },
+    { "Garden Shed/Max Power Yesterday",    TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_MAX_POWER_YESTERDAY,  REGISTER_UINT16,    UNIT_WATT,              0 }, 0 },
+    { "Garden Shed/Operation State",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_OPERATION_STATE,      REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Error State",            TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_ERROR_STATE,          REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Load",                   TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_LOAD,                 REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Tracker Operation Mode", TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_TRACKER_OPERATION_MODE, REGISTER_UINT16,  UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Off Reason",             TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { VICTRON_OFF_REASON,           REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Serial Number",          TABLE_INPUT_REGISTERS, METRIC_STRING,  { VICTRON_SERIAL_NUMBER,        REGISTER_UINT16,    UNIT_NONE,              0 }, STRING_REGISTER_COUNT(VICTRON_SERIAL_NUMBER) },
+    { "Garden Shed/Product ID",             TABLE_INPUT_REGISTERS, METRIC_STRING,  { VICTRON_PRODUCT_ID,           REGISTER_UINT16,    UNIT_NONE,              0 }, STRING_REGISTER_COUNT(VICTRON_PRODUCT_ID) },
+    { "Garden Shed/Firmware",               TABLE_INPUT_REGISTERS, METRIC_STRING,  { VICTRON_FIRMWARE,             REGISTER_UINT16,    UNIT_NONE,              0 }, STRING_REGISTER_COUNT(VICTRON_FIRMWARE) },
+    { "Garden Shed/Light Level",            TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { SHED_LIGHT_LEVEL,             REGISTER_UINT16,    UNIT_PERCENT,           0 }, 0 },
+    { "Garden Shed/Door Open",              TABLE_INPUT_REGISTERS, METRIC_BOOLEAN, { SHED_DOOR_STATE,              REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Door Open Count",        TABLE_INPUT_REGISTERS, METRIC_NUMBER,  { SHED_DOOR_OPEN_COUNT,         REGISTER_UINT16,    UNIT_NONE,              0 }, 0 },
+    { "Garden Shed/Door Changed",           TABLE_INPUT_REGISTERS, METRIC_UPTIME,  { SHED_DOOR_CHANGED_UPPER,      REGISTER_UINT32,    UNIT_NONE,              0 }, 0 }
+};
+
+static const ProfileWrite_t WRITES[] = {
+    { SHED_LIGHT_COMMAND, WRITE_SCHEDULE, 0 },
+    { GROUP_REGISTER(GROUP_MEMBERSHIP), WRITE_GROUPS, 0 }
+};
+
+// Names of SHED_EVENT_TYPES
+static const char* const EVENT_NAMES[] = {
+    "door",
+    "light"
+};
+
+const DeviceProfile_t GARDEN_SHED_PROFILE = {
+    "Garden Shed",
+    MODBUS_ID,
+    PROFILE_ENTRIES(GROUPS),
+    PROFILE_ENTRIES(METRICS),
+    PROFILE_ENTRIES(WRITES),
+    SHED_EVENTS, SHED_EVENT_LOG_LENGTH,
+    PROFILE_ENTRIES(EVENT_NAMES),
+    GROUP_REGISTERS_ADDRESS
+};
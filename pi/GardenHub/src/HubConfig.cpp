@@ -0,0 +1,452 @@
+/*
+ * File: HubConfig.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "HubConfig.h"
+#include <LightRamp.h>
+#include <ModbusGroups.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "Logger.h"
+
+#define HUB_CONFIG "Hub Config: "
+
+enum ConfigType
+{
+    CONFIG_STRING,
+    CONFIG_INT,
+    CONFIG_BOOL,
+    CONFIG_CHAR,
+    CONFIG_TIME,    // HH:MM, stored as minutes past midnight
+    CONFIG_DOUBLE,
+    CONFIG_PROGRAM  // See parseScheduleProgram
+};
+
+typedef struct {
+    const char* section;
+    const char* key;
+    uint8_t type;
+    size_t offset;
+    int32_t minimum;
+    int32_t maximum;
+} ConfigKey_t;
+
+
+#define CONFIG_KEY(section, key, type, member, minimum, maximum) { section, key, type, offsetof(HubConfig_t, member), minimum, maximum }
+// Every bus has the same keys in its own section
+#define BUS_KEYS(section, bus) \
+    CONFIG_KEY(section,     "port",         CONFIG_STRING,  modbus[bus].port,       0,      0), \
+    CONFIG_KEY(section,     "baud",         CONFIG_INT,     modbus[bus].baud,       1200,   1000000), \
+    CONFIG_KEY(section,     "parity",       CONFIG_CHAR,    modbus[bus].parity,     0,      0), \
+    CONFIG_KEY(section,     "data_bits",    CONFIG_INT,     modbus[bus].dataBits,   5,      8), \
+    CONFIG_KEY(section,     "stop_bits",    CONFIG_INT,     modbus[bus].stopBits,   1,      2)
+// Keys of a device section, relative to its DeviceConfig_t
+#define DEVICE_KEY(key, type, member, minimum, maximum) { DEVICE_SECTION, key, type, offsetof(DeviceConfig_t, member), minimum, maximum }
+#define DEVICE_SECTION "device"
+#define DEVICE_PREFIX DEVICE_SECTION "."
+
+static const ConfigKey_t CONFIG_KEYS[] = {
+    BUS_KEYS("modbus",  0),
+    BUS_KEYS("modbus1", 1),
+    BUS_KEYS("modbus2", 2),
+    BUS_KEYS("modbus3", 3),
+    CONFIG_KEY("mqtt",      "host",         CONFIG_STRING,  mqtt.host,          0,      0),
+    CONFIG_KEY("mqtt",      "port",         CONFIG_INT,     mqtt.port,          1,      65535),
+    CONFIG_KEY("mqtt",      "group",        CONFIG_STRING,  mqtt.group,         0,      0),
+    CONFIG_KEY("mqtt",      "node",         CONFIG_STRING,  mqtt.node,          0,      0),
+    CONFIG_KEY("mqtt",      "sequence_path", CONFIG_STRING, mqtt.sequencePath,  0,      0),
+    CONFIG_KEY("gateway",   "enabled",      CONFIG_BOOL,    gateway.enabled,    0,      0),
+    CONFIG_KEY("gateway",   "address",      CONFIG_STRING,  gateway.address,    0,      0),
+    CONFIG_KEY("gateway",   "port",         CONFIG_INT,     gateway.port,       1,      65535),
+    CONFIG_KEY("gateway",   "bus",          CONFIG_INT,     gateway.bus,        0,      HUB_MAX_BUSES - 1),
+    CONFIG_KEY("status",    "enabled",      CONFIG_BOOL,    status.enabled,     0,      0),
+    CONFIG_KEY("status",    "address",      CONFIG_STRING,  status.address,     0,      0),
+    CONFIG_KEY("status",    "port",         CONFIG_INT,     status.port,        1,      65535),
+    CONFIG_KEY("log",       "level",        CONFIG_INT,     log.level,          0,      LOG_LEVEL_COUNT - 1),
+    CONFIG_KEY("checkpoint", "path",        CONFIG_STRING,  checkpoint.path,    0,      0),
+    CONFIG_KEY("checkpoint", "period",      CONFIG_INT,     checkpoint.period,  1,      3600),
+    CONFIG_KEY("location",  "latitude",     CONFIG_DOUBLE,  location.latitude,  -90,    90),
+    CONFIG_KEY("location",  "longitude",    CONFIG_DOUBLE,  location.longitude, -180,   180),
+    CONFIG_KEY("scene",     "enabled",      CONFIG_BOOL,    scene.enabled,      0,      0),
+    CONFIG_KEY("scene",     "groups",       CONFIG_INT,     scene.groups,       0,      GROUP_ALL),
+    CONFIG_KEY("scene",     "level",        CONFIG_INT,     scene.level,        0,      100),
+    CONFIG_KEY("scene",     "ramp",         CONFIG_INT,     scene.rampTime,     0,      6553),
+    CONFIG_KEY("scene",     "ramp_curve",   CONFIG_INT,     scene.rampCurve,    0,      RAMP_CURVE_COUNT - 1)
+};
+
+static const ConfigKey_t DEVICE_KEYS[] = {
+    DEVICE_KEY("profile",       CONFIG_STRING,  profile,        0,      0),
+    DEVICE_KEY("enabled",       CONFIG_BOOL,    enabled,        0,      0),
+    DEVICE_KEY("bus",           CONFIG_INT,     bus,            0,      HUB_MAX_BUSES - 1),
+    DEVICE_KEY("slave",         CONFIG_INT,     slaveId,        0,      247),
+    DEVICE_KEY("poll",          CONFIG_INT,     pollTime,       1,      60000),
+    DEVICE_KEY("telemetry",     CONFIG_INT,     telemetryTime,  1,      3600000),
+    DEVICE_KEY("light_high",    CONFIG_INT,     lightHigh,      0,      100),
+    DEVICE_KEY("light_on",      CONFIG_TIME,    lightOn,        0,      0),
+    DEVICE_KEY("light_off",     CONFIG_TIME,    lightOff,       0,      0),
+    DEVICE_KEY("program",       CONFIG_PROGRAM, program,        0,      0),
+    DEVICE_KEY("ramp_curve",    CONFIG_INT,     rampCurve,      0,      RAMP_CURVE_COUNT - 1),
+    DEVICE_KEY("groups",        CONFIG_INT,     groups,         0,      GROUP_ALL)
+};
+
+/**
+ * @brief Gets the device with the name, adding it with the defaults of every device if it is new
+ * 
+ * @return DeviceConfig_t* NULL if there is no room for another device
+ */
+static DeviceConfig_t* deviceSection(HubConfig_t* config, const char* name)
+{
+    DeviceConfig_t* device = (DeviceConfig_t*) findDeviceConfig(config, name);
+
+    if (device != NULL || config->deviceCount >= HUB_MAX_DEVICES)
+    {
+        return device;
+    }
+
+    device = &config->devices[config->deviceCount++];
+
+    memset(device, 0, sizeof(DeviceConfig_t));
+    strcpy(device->name, name);
+    device->enabled = true;
+    device->pollTime = 5;
+    device->telemetryTime = 1000;
+    device->rampCurve = RAMP_PERCEPTUAL;
+    device->groups = 1;
+
+    return device;
+}
+
+void defaultHubConfig(HubConfig_t* config)
+{
+    memset(config, 0, sizeof(HubConfig_t));
+
+    // Only the first bus has a port by default, the others share its line settings
+    for (uint8_t i = 0; i < HUB_MAX_BUSES; i++)
+    {
+        config->modbus[i].baud = 38400;
+        config->modbus[i].parity = 'N';
+        config->modbus[i].dataBits = 8;
+        config->modbus[i].stopBits = 2;
+    }
+
+    strcpy(config->modbus[0].port, "/dev/ttySC0");
+
+    strcpy(config->mqtt.host, "localhost");
+    config->mqtt.port = 1883;
+    strcpy(config->mqtt.group, "Gardener");
+    strcpy(config->mqtt.node, "GardenHub");
+    strcpy(config->mqtt.sequencePath, "/var/lib/gardener/gardenhub.bdseq");
+
+    config->gateway.enabled = false;
+    strcpy(config->gateway.address, "127.0.0.1");
+    config->gateway.port = 1502;
+    config->gateway.bus = 0;
+
+    config->status.enabled = true;
+    strcpy(config->status.address, "127.0.0.1");
+    config->status.port = 8080;
+
+    config->log.level = LOG_LEVEL_INFO;
+
+    strcpy(config->checkpoint.path, "/var/lib/gardener/gardenhub.state");
+    config->checkpoint.period = 60;
+
+    DeviceConfig_t* bed = deviceSection(config, "bed");
+    strcpy(bed->profile, "bed");
+    bed->lightHigh = 45;
+    bed->lightOn = 20 * 60;
+    bed->lightOff = 22 * 60;
+
+    DeviceConfig_t* shed = deviceSection(config, "shed");
+    strcpy(shed->profile, "shed");
+    shed->lightHigh = 15;
+
+    config->scene.enabled = false;
+    config->scene.groups = GROUP_ALL;
+    config->scene.rampCurve = RAMP_PERCEPTUAL;
+}
+
+/**
+ * @brief Trims whitespace from both ends of a string in place
+ * 
+ * @param text 
+ * @return char* The start of the trimmed string
+ */
+static char* trim(char* text)
+{
+    while (isspace((unsigned char) *text))
+    {
+        text++;
+    }
+
+    char* end = text + strlen(text);
+
+    while (end > text && isspace((unsigned char) end[-1]))
+    {
+        *--end = '\0';
+    }
+
+    return text;
+}
+
+static int parseValue(const ConfigKey_t* key, const char* value, void* section)
+{
+    void* member = (uint8_t*) section + key->offset;
+    char* end;
+    long number;
+    int hours, minutes;
+
+    switch (key->type)
+    {
+        case CONFIG_STRING:
+            if (strlen(value) >= CONFIG_STRING_LENGTH)
+            {
+                return -1;
+            }
+            strcpy((char*) member, value);
+            return 0;
+        case CONFIG_INT:
+            number = strtol(value, &end, 10);
+            if (*value == '\0' || *end != '\0' || number < key->minimum || number > key->maximum)
+            {
+                return -1;
+            }
+            *((int32_t*) member) = (int32_t) number;
+            return 0;
+        case CONFIG_BOOL:
+            if (strcmp(value, "true") == 0 || strcmp(value, "1") == 0)
+            {
+                *((bool*) member) = true;
+            }
+            else if (strcmp(value, "false") == 0 || strcmp(value, "0") == 0)
+            {
+                *((bool*) member) = false;
+            }
+            else
+            {
+                return -1;
+            }
+            return 0;
+        case CONFIG_CHAR:
+            if (strlen(value) != 1)
+            {
+                return -1;
+            }
+            *((char*) member) = value[0];
+            return 0;
+        case CONFIG_TIME:
+            if (sscanf(value, "%d:%d", &hours, &minutes) != 2 || hours < 0 || hours > 23 || minutes < 0 || minutes > 59)
+            {
+                return -1;
+            }
+            *((int32_t*) member) = hours * 60 + minutes;
+            return 0;
+        case CONFIG_DOUBLE:
+        {
+            double decimal = strtod(value, &end);
+            if (*value == '\0' || *end != '\0' || decimal < key->minimum || decimal > key->maximum)
+            {
+                return -1;
+            }
+            *((double*) member) = decimal;
+            return 0;
+        }
+        case CONFIG_PROGRAM:
+            return parseScheduleProgram(value, (ScheduleProgram_t*) member);
+        default:
+            return -1;
+    }
+}
+
+int parseHubConfig(const char* text, HubConfig_t* config)
+{
+    char line[CONFIG_LINE_LENGTH];
+    char section[CONFIG_STRING_LENGTH] = "";
+    DeviceConfig_t* device = NULL;
+    int lineNumber = 0;
+
+    while (*text != '\0')
+    {
+        size_t length = strcspn(text, "\n");
+
+        lineNumber++;
+
+        if (length >= CONFIG_LINE_LENGTH)
+        {
+            HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "line %d is too long", lineNumber);
+            return lineNumber;
+        }
+
+        memcpy(line, text, length);
+        line[length] = '\0';
+        text += text[length] == '\n' ? length + 1 : length;
+
+        line[strcspn(line, "#;")] = '\0';
+        char* content = trim(line);
+
+        if (*content == '\0')
+        {
+            continue;
+        }
+
+        if (*content == '[')
+        {
+            char* end = strchr(content, ']');
+
+            if (end == NULL || end[1] != '\0' || (size_t) (end - content - 1) >= CONFIG_STRING_LENGTH)
+            {
+                HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "invalid section on line %d", lineNumber);
+                return lineNumber;
+            }
+
+            *end = '\0';
+            strcpy(section, trim(content + 1));
+
+            const char* name = NULL;
+
+            // [bed] and [shed] are the sections from before devices were named
+            if (strncmp(section, DEVICE_PREFIX, strlen(DEVICE_PREFIX)) == 0)
+            {
+                name = &section[strlen(DEVICE_PREFIX)];
+            }
+            else if (strcmp(section, "bed") == 0 || strcmp(section, "shed") == 0)
+            {
+                name = section;
+            }
+
+            device = name != NULL && *name != '\0' ? deviceSection(config, name) : NULL;
+
+            if (name != NULL && device == NULL)
+            {
+                HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "invalid device section on line %d, there can be up to %d devices", lineNumber, HUB_MAX_DEVICES);
+                return lineNumber;
+            }
+            continue;
+        }
+
+        char* separator = strchr(content, '=');
+
+        if (separator == NULL)
+        {
+            HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "expected key = value on line %d", lineNumber);
+            return lineNumber;
+        }
+
+        *separator = '\0';
+        char* key = trim(content);
+        char* value = trim(separator + 1);
+        const ConfigKey_t* match = NULL;
+
+        // Every device section has the same keys
+        const char* keySection = device != NULL ? DEVICE_SECTION : section;
+        const ConfigKey_t* keys = device != NULL ? DEVICE_KEYS : CONFIG_KEYS;
+        size_t keyCount = device != NULL ? sizeof(DEVICE_KEYS) / sizeof(DEVICE_KEYS[0]) : sizeof(CONFIG_KEYS) / sizeof(CONFIG_KEYS[0]);
+
+        for (size_t i = 0; i < keyCount; i++)
+        {
+            if (strcmp(keys[i].section, keySection) == 0 && strcmp(keys[i].key, key) == 0)
+            {
+                match = &keys[i];
+                break;
+            }
+        }
+
+        if (match == NULL)
+        {
+            HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "unknown key %s.%s on line %d", section, key, lineNumber);
+            return lineNumber;
+        }
+
+        if (parseValue(match, value, device != NULL ? (void*) device : (void*) config) != 0)
+        {
+            HUB_LOG(LOG_LEVEL_ERROR, HUB_CONFIG "invalid value for %s.%s on line %d", section, key, lineNumber);
+            return lineNumber;
+        }
+    }
+
+    return 0;
+}
+
+int loadHubConfig(const char* path, HubConfig_t* config)
+{
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        return -1;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+
+    defaultHubConfig(config);
+
+    return parseHubConfig(text.str().c_str(), config);
+}
+
+const DeviceConfig_t* findDeviceConfig(const HubConfig_t* config, const char* name)
+{
+    for (int32_t i = 0; i < config->deviceCount; i++)
+    {
+        if (strcmp(config->devices[i].name, name) == 0)
+        {
+            return &config->devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+void deviceProgram(const DeviceConfig_t* device, ScheduleProgram_t* program)
+{
+    if (device->program.count > 0)
+    {
+        *program = device->program;
+        return;
+    }
+
+    // A window that starts and ends at the same time stays at lightHigh, such as the shed
+    // where the light level is fixed and the door switches it
+    if (device->lightOn == device->lightOff)
+    {
+        program->count = 1;
+        program->events[0] = { ANCHOR_MIDNIGHT, 0, device->lightHigh, 0 };
+        return;
+    }
+
+    program->count = 2;
+    program->events[0] = { ANCHOR_MIDNIGHT, device->lightOn, device->lightHigh, 0 };
+    program->events[1] = { ANCHOR_MIDNIGHT, device->lightOff, 0, 0 };
+}
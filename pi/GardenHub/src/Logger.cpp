@@ -0,0 +1,216 @@
+/*
+ * File: Logger.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "Logger.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+
+#define LOG_SLOT_MASK (LOG_SLOTS - 1)
+
+/**
+ * @brief A message in the ring. The sequence says whose turn the slot is: equal to the position
+ * when it is free to be written, one past it once the message is ready to be read.
+ * 
+ */
+typedef struct {
+    atomic<uint32_t> sequence;
+    uint8_t level;
+    char text[LOG_MESSAGE_LENGTH];
+} LogSlot_t;
+
+/**
+ * @brief Bounded queue with many writers and a single reader
+ * 
+ */
+class LogRing
+{
+public:
+    LogSlot_t slots[LOG_SLOTS];
+    atomic<uint32_t> head;          // Next position to be claimed by a writer
+    uint32_t tail;                  // Next position to be read, only used under the flush lock
+    atomic<uint32_t> dropped;
+    atomic<int> level;
+    mutex flushLock;
+
+    LogRing() : head(0), tail(0), dropped(0), level(LOG_LEVEL_INFO)
+    {
+        for (uint32_t i = 0; i < LOG_SLOTS; i++)
+        {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+};
+
+static LogRing ring;
+
+static uint32_t milliseconds()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Decides whether a call site can log again, and takes the count it held back since it last did
+ * 
+ * @return true if the message should be logged
+ */
+static bool allow(LogLimit_t* limit, uint32_t* suppressed)
+{
+    uint32_t now = milliseconds();
+    uint32_t start = limit->start.load(memory_order_relaxed);
+
+    // Whichever thread wins the exchange starts the new period, a count lost to a race only costs a message
+    if (now - start >= LOG_LIMIT_PERIOD && limit->start.compare_exchange_strong(start, now, memory_order_relaxed))
+    {
+        limit->count.store(0, memory_order_relaxed);
+    }
+
+    if (limit->count.fetch_add(1, memory_order_relaxed) >= LOG_BURST)
+    {
+        limit->suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    *suppressed = limit->suppressed.exchange(0, memory_order_relaxed);
+    return true;
+}
+
+void Logger::log(int level, LogLimit_t* limit, const char* format, ...)
+{
+    uint32_t suppressed = 0;
+    uint32_t position;
+    LogSlot_t* slot;
+
+    if (level < ring.level.load(memory_order_relaxed) || (limit != NULL && !allow(limit, &suppressed)))
+    {
+        return;
+    }
+
+    position = ring.head.load(memory_order_relaxed);
+
+    for (;;)
+    {
+        slot = &ring.slots[position & LOG_SLOT_MASK];
+        int32_t difference = (int32_t) (slot->sequence.load(memory_order_acquire) - position);
+
+        if (difference == 0)
+        {
+            if (ring.head.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Still holds a message from the last lap, the reader has fallen a whole ring behind
+            ring.dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = ring.head.load(memory_order_relaxed);
+        }
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(slot->text, LOG_MESSAGE_LENGTH, format, arguments);
+    va_end(arguments);
+
+    if (suppressed > 0 && length >= 0 && length < LOG_MESSAGE_LENGTH)
+    {
+        snprintf(&slot->text[length], LOG_MESSAGE_LENGTH - length, " (%u similar messages suppressed)", suppressed);
+    }
+
+    slot->level = level;
+    slot->sequence.store(position + 1, memory_order_release);
+}
+
+void Logger::setLevel(int level)
+{
+    ring.level.store(level, memory_order_relaxed);
+}
+
+uint32_t Logger::getDropped()
+{
+    return ring.dropped.load(memory_order_relaxed);
+}
+
+int Logger::flush()
+{
+    // Only one reader at a time, so a flush at exit can run alongside the logger thread
+    lock_guard<mutex> guard(ring.flushLock);
+    static uint32_t reported = 0;
+    int count = 0;
+
+    for (;;)
+    {
+        LogSlot_t* slot = &ring.slots[ring.tail & LOG_SLOT_MASK];
+
+        if (slot->sequence.load(memory_order_acquire) != ring.tail + 1)
+        {
+            break;
+        }
+
+        FILE* stream = slot->level >= LOG_LEVEL_WARNING ? stderr : stdout;
+        fputs(slot->text, stream);
+        fputc('\n', stream);
+
+        slot->sequence.store(ring.tail + LOG_SLOTS, memory_order_release);
+        ring.tail++;
+        count++;
+    }
+
+    uint32_t dropped = ring.dropped.load(memory_order_relaxed);
+
+    if (dropped != reported)
+    {
+        fprintf(stderr, "Logger: dropped %u messages\n", dropped - reported);
+        reported = dropped;
+    }
+
+    if (count > 0)
+    {
+        fflush(stdout);
+        fflush(stderr);
+    }
+
+    return count;
+}
+
+int32_t Logger::doExecute()
+{
+    flush();
+    return LOG_FLUSH_TIME;
+}
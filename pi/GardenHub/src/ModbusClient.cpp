@@ -74,4 +74,9 @@ int ModbusClient::writeRegister(int address, uint16_t value)
 int ModbusClient::writeRegisters(int address, int size, uint16_t* values)
 {
     return connection->writeRegisters(slaveId, address, size, values);
+}
+
+int ModbusClient::broadcastRegisters(int broadcastId, int address, int size, uint16_t* values)
+{
+    return connection->broadcastRegisters(broadcastId, address, size, values);
 }
\ No newline at end of file
@@ -33,18 +33,22 @@
 #include <stdexcept>
 #include <cstring>
 #include <cerrno>
-#include <iostream>
+#include "Logger.h"
 
-#define MODBUS_CONNECTION "Modbus Connection: " <<
+#define MODBUS_CONNECTION "Modbus Connection: "
 
 #define MODBUS_TIMEOUT_MICRO 500000
 #define MODBUS_TIMEOUT_SECOND 0
 
 #define POLL_TIMEOUT 100
 
+// Wait before retrying a port that is down, doubling from the minimum up to the maximum
+#define RECONNECT_MINIMUM 100
+#define RECONNECT_MAXIMUM 2000
+
 // #define DEBUG
 
-ModbusConnection::ModbusConnection() : connected(false), modbusContext(NULL) { }
+ModbusConnection::ModbusConnection() : slaveId(-1), connected(false), modbusContext(NULL), port(NULL), backoff(RECONNECT_MINIMUM), requests(0), failures(0), reconnects(0), outage(0) { }
 
 ModbusConnection::~ModbusConnection() 
 {
@@ -68,7 +72,7 @@ int ModbusConnection::configure(const char *port, int baud, char parity, int dat
     modbusContext = modbus_new_rtu(port, baud, parity, data_bit, stop_bit);
     if (modbusContext == NULL)
     {
-        std::cout << MODBUS_CONNECTION "Unable to create the modbus context for the port: " << port << ". Error: " << std::strerror(errno) << "\n";
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "Unable to create the modbus context for the port: %s. Error: %s", port, std::strerror(errno));
         return -1;
     }
 
@@ -76,7 +80,7 @@ int ModbusConnection::configure(const char *port, int baud, char parity, int dat
     modbus_set_debug(modbusContext, TRUE);
     #endif
 
-    std::cout << MODBUS_CONNECTION "connection initialized on port " << port << ". BAUD: " << baud << ", PARITY: " << parity << ", DATA BITS: " << data_bit << ", STOP BITS: " << stop_bit << "\n";
+    HUB_LOG(LOG_LEVEL_INFO, MODBUS_CONNECTION "connection initialized on port %s. BAUD: %d, PARITY: %c, DATA BITS: %d, STOP BITS: %d", port, baud, parity, data_bit, stop_bit);
 
     this->port = port;
 
@@ -91,7 +95,7 @@ int ModbusConnection::configure(const char *port, int baud, char parity, int dat
 
     if (result < 0)
     {
-        std::cout << MODBUS_CONNECTION "Error while trying to configure response timeout. Error: " << std::strerror(errno) << "\n";
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "Error while trying to configure response timeout. Error: %s", std::strerror(errno));
         return -1;
     }
 
@@ -106,7 +110,7 @@ int ModbusConnection::configure(const char *port, int baud, char parity, int dat
 
     if (result < 0)
     {
-        std::cout << MODBUS_CONNECTION "Error while trying to configure indication timeout. Error: " << std::strerror(errno) << "\n";
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "Error while trying to configure indication timeout. Error: %s", std::strerror(errno));
         return -1;
     }
 
@@ -117,18 +121,23 @@ int ModbusConnection::connect()
 {
     if (modbusContext == NULL)
     {
-        std::cout << MODBUS_CONNECTION "cannot connect as it has not been configured.\n";
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "cannot connect as it has not been configured.");
         return -1;
     }
 
+    lock_guard<mutex> guard(connectionLock);
+
     int result = modbus_connect(modbusContext);
     if(result < 0)
     {
-        std::cout << MODBUS_CONNECTION "Error while trying to connect to port: " << port << ". Error: " << std::strerror(errno) << "\n";
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "Error while trying to connect to port: %s. Error: %s", port, std::strerror(errno));
+        // Requests keep retrying the port, so one that appears later is picked up without a restart
+        lostTime = chrono::steady_clock::now();
+        retryTime = lostTime + chrono::milliseconds(backoff);
         return result;
     }
 
-    std::cout << MODBUS_CONNECTION "Successfully connected\n";
+    HUB_LOG(LOG_LEVEL_INFO, MODBUS_CONNECTION "Successfully connected");
     
     connected = true;
     return 0;
@@ -136,8 +145,80 @@ int ModbusConnection::connect()
 
 void ModbusConnection::disconnect()
 {
+    lock_guard<mutex> guard(connectionLock);
+    modbus_close(modbusContext);
+    connected = false;
+}
+
+bool ModbusConnection::isConnected()
+{
+    return connected;
+}
+
+const char* ModbusConnection::getPort()
+{
+    return port;
+}
+
+inline bool ModbusConnection::isLinkError(int error)
+{
+    // Timeouts and bad replies are a device problem, these mean the port itself has gone
+    switch (error)
+    {
+        case EIO:
+        case EBADF:
+        case ENXIO:
+        case ENODEV:
+        case EPIPE:
+        case ECONNRESET:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline void ModbusConnection::lost(int error)
+{
+    HUB_LOG(LOG_LEVEL_WARNING, MODBUS_CONNECTION "Lost the connection to port: %s. Error: %s", port, std::strerror(error));
+
+    modbus_close(modbusContext);
+    connected = false;
+    slaveId = -1;
+
+    // The first retry is immediate, most drops are a glitch or an adapter that comes straight back
+    lostTime = chrono::steady_clock::now();
+    retryTime = lostTime;
+    backoff = RECONNECT_MINIMUM;
+}
+
+inline int ModbusConnection::reconnect()
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+    if (modbusContext == NULL || now < retryTime)
+    {
+        return -1;
+    }
+
+    // Reopened by path, so an adapter that came back under the same name is found again
     modbus_close(modbusContext);
+    if (modbus_connect(modbusContext) < 0)
+    {
+        retryTime = now + chrono::milliseconds(backoff);
+        backoff = backoff * 2 < RECONNECT_MAXIMUM ? backoff * 2 : RECONNECT_MAXIMUM;
+        return -1;
+    }
+
+    // Anything left in the buffers belongs to requests from before the drop
+    modbus_flush(modbusContext);
+
     connected = true;
+    backoff = RECONNECT_MINIMUM;
+    outage = chrono::duration_cast<chrono::milliseconds>(now - lostTime).count();
+    reconnects++;
+
+    HUB_LOG(LOG_LEVEL_INFO, MODBUS_CONNECTION "Reconnected to port: %s after %ums", port, outage.load());
+    return 0;
 }
 
 inline int ModbusConnection::setSlaveId(int slaveId)
@@ -149,7 +230,7 @@ inline int ModbusConnection::setSlaveId(int slaveId)
         result = modbus_set_slave(modbusContext, slaveId);
         if(result < 0)
         {
-            std::cout << MODBUS_CONNECTION "Error while trying to set slave id to: " << slaveId << ". Error: " << std::strerror(errno) << "\n";
+            HUB_LOG(LOG_LEVEL_ERROR, MODBUS_CONNECTION "Error while trying to set slave id to: %d. Error: %s", slaveId, std::strerror(errno));
             return result;
         }
         this->slaveId = slaveId;
@@ -160,7 +241,32 @@ inline int ModbusConnection::setSlaveId(int slaveId)
 inline void ModbusConnection::lock()
 {
     connectionLock.lock();
-    std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT)); 
+    // Only a working bus needs the gap between requests, a port that is down fails straight away
+    if (connected)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TIMEOUT)); 
+    }
+}
+
+inline int ModbusConnection::ready()
+{
+    if (connected || reconnect() == 0)
+    {
+        return 0;
+    }
+    errno = ENOTCONN;
+    return -1;
+}
+
+inline int ModbusConnection::begin(int slaveId)
+{
+    lock();
+    int result = ready();
+    if (result == 0)
+    {
+        result = setSlaveId(slaveId);
+    }
+    return result;
 }
 
 inline void ModbusConnection::unlock()
@@ -168,26 +274,63 @@ inline void ModbusConnection::unlock()
     connectionLock.unlock();
 }
 
+inline void ModbusConnection::count(int result)
+{
+    int error = errno;
+
+    requests++;
+    if (result < 0)
+    {
+        failures++;
+        if (connected && isLinkError(error))
+        {
+            lost(error);
+        }
+    }
+}
+
+ModbusStatistics_t ModbusConnection::getStatistics()
+{
+    ModbusStatistics_t statistics;
+    statistics.requests = requests;
+    statistics.failures = failures;
+    statistics.reconnects = reconnects;
+    statistics.outage = outage;
+    return statistics;
+}
+
 int ModbusConnection::request(int slaveId, uint8_t* modbusRequest)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_receive(modbusContext, modbusRequest);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_receive(modbusContext, modbusRequest);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::reply(int slaveId, uint8_t* modbusRequest, int modbusRequestResult, modbus_mapping_t* mapping)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_reply(modbusContext, modbusRequest, modbusRequestResult, mapping);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_reply(modbusContext, modbusRequest, modbusRequestResult, mapping);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::readBits(int slaveId, int address, int size, uint8_t* data)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_read_bits(modbusContext, address, size, data);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_read_bits(modbusContext, address, size, data);
+    }
+    count(result);
     unlock();
     return result;
 }
@@ -195,56 +338,156 @@ int ModbusConnection::readBits(int slaveId, int address, int size, uint8_t* data
 
 int ModbusConnection::readInputBits(int slaveId, int address, int size, uint8_t* data)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_read_input_bits(modbusContext, address, size, data);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_read_input_bits(modbusContext, address, size, data);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::readRegisters(int slaveId, int address, int size, uint16_t* data)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_read_registers(modbusContext, address, size, data);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_read_registers(modbusContext, address, size, data);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::readInputRegisters(int slaveId, int address, int size, uint16_t* data)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_read_input_registers(modbusContext, address, size, data);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_read_input_registers(modbusContext, address, size, data);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::writeBit(int slaveId, int address, int value)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_write_bit(modbusContext, address, value);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_write_bit(modbusContext, address, value);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::writeBits(int slaveId, int address, int size, uint8_t* values)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_write_bits(modbusContext, address, size, values);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_write_bits(modbusContext, address, size, values);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::writeRegister(int slaveId, int address, uint16_t value)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_write_register(modbusContext, address, value);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_write_register(modbusContext, address, value);
+    }
+    count(result);
     unlock();
     return result;
 }
 
 int ModbusConnection::writeRegisters(int slaveId, int address, int size, uint16_t* values)
 {
-    lock();
-    int result = setSlaveId(slaveId) || modbus_write_registers(modbusContext, address, size, values);
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_write_registers(modbusContext, address, size, values);
+    }
+    count(result);
     unlock();
     return result;
+}
+
+int ModbusConnection::forward(int slaveId, const uint8_t* request, int length, uint8_t* response)
+{
+    // An RTU frame is the slave id, the PDU and a CRC
+    uint8_t frame[MODBUS_RTU_MAX_ADU_LENGTH];
+
+    if (length <= 0 || length > MODBUS_MAX_PDU_LENGTH)
+    {
+        return -1;
+    }
+
+    frame[0] = slaveId;
+    memcpy(&frame[1], request, length);
+
+    int result = begin(slaveId);
+    if (result == 0)
+    {
+        result = modbus_send_raw_request(modbusContext, frame, length + 1);
+    }
+    if (result >= 0)
+    {
+        result = modbus_receive_confirmation(modbusContext, frame);
+    }
+    count(result);
+    unlock();
+
+    if (result <= 3)
+    {
+        return -1;
+    }
+
+    memcpy(response, &frame[1], result - 3);
+    return result - 3;
+}
+
+int ModbusConnection::broadcastRegisters(int broadcastId, int address, int size, uint16_t* values)
+{
+    // Slave id, write multiple registers, address, count and byte count, then the values
+    uint8_t frame[MODBUS_RTU_MAX_ADU_LENGTH];
+    int length = 7;
+
+    if (size <= 0 || size > MODBUS_MAX_WRITE_REGISTERS)
+    {
+        return -1;
+    }
+
+    frame[0] = broadcastId;
+    frame[1] = MODBUS_FC_WRITE_MULTIPLE_REGISTERS;
+    frame[2] = address >> 8;
+    frame[3] = address & 0xFF;
+    frame[4] = size >> 8;
+    frame[5] = size & 0xFF;
+    frame[6] = size * 2;
+
+    for (int i = 0; i < size; i++)
+    {
+        frame[length++] = values[i] >> 8;
+        frame[length++] = values[i] & 0xFF;
+    }
+
+    // Sent raw, as libmodbus would wait out the response timeout for a reply that never comes
+    lock();
+    int result = ready();
+    if (result == 0)
+    {
+        result = modbus_send_raw_request(modbusContext, frame, length);
+    }
+    count(result);
+    unlock();
+
+    return result < 0 ? -1 : size;
 }
\ No newline at end of file
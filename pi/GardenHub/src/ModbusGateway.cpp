@@ -0,0 +1,468 @@
+/*
+ * File: ModbusGateway.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "ModbusGateway.h"
+#include <cstring>
+#include <cerrno>
+#include "Logger.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define MODBUS_GATEWAY "Modbus Gateway: "
+
+#define READ_COILS 0x01
+#define READ_INPUT_REGISTERS 0x04
+#define EXCEPTION_FLAG 0x80
+
+/**
+ * @brief Only reads are shared, every write has to reach the device
+ * 
+ */
+static inline bool isRead(uint8_t function)
+{
+    return function >= READ_COILS && function <= READ_INPUT_REGISTERS;
+}
+
+static int setNonBlocking(int descriptor)
+{
+    int flags = fcntl(descriptor, F_GETFL, 0);
+
+    return flags < 0 ? -1 : fcntl(descriptor, F_SETFL, flags | O_NONBLOCK);
+}
+
+ModbusGateway::ModbusGateway(ModbusConnection* connection) :
+    connection(connection), listener(-1), order(0), requests(0), transactions(0)
+{
+    wake[0] = wake[1] = -1;
+
+    for (uint8_t i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        clients[i].socket = -1;
+        clients[i].generation = 0;
+        clients[i].length = 0;
+    }
+
+    for (uint8_t i = 0; i < GATEWAY_MAX_FLIGHTS; i++)
+    {
+        flights[i].state = FLIGHT_FREE;
+    }
+}
+
+ModbusGateway::~ModbusGateway()
+{
+    for (uint8_t i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        drop(i);
+    }
+
+    if (listener >= 0)
+    {
+        close(listener);
+    }
+
+    if (wake[0] >= 0)
+    {
+        close(wake[0]);
+        close(wake[1]);
+    }
+}
+
+int ModbusGateway::listen(const char* address, int port)
+{
+    sockaddr_in local;
+    int reuse = 1;
+
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, address, &local.sin_addr) != 1)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_GATEWAY "invalid address %s", address);
+        return -1;
+    }
+
+    if (pipe(wake) != 0 || setNonBlocking(wake[0]) != 0 || setNonBlocking(wake[1]) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_GATEWAY "unable to create the wake pipe. Error: %s", std::strerror(errno));
+        return -1;
+    }
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listener < 0 || setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(listener, (sockaddr*) &local, sizeof(local)) != 0 || ::listen(listener, GATEWAY_BACKLOG) != 0 ||
+        setNonBlocking(listener) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_GATEWAY "unable to listen on %s:%d. Error: %s", address, port, std::strerror(errno));
+        return -1;
+    }
+
+    HUB_LOG(LOG_LEVEL_INFO, MODBUS_GATEWAY "listening on %s:%d", address, port);
+
+    return 0;
+}
+
+void ModbusGateway::accept()
+{
+    int descriptor = ::accept(listener, NULL, NULL);
+    int noDelay = 1;
+
+    if (descriptor < 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        if (clients[i].socket < 0)
+        {
+            // Responses are single small writes, so they are sent straight away
+            setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            setNonBlocking(descriptor);
+            clients[i].socket = descriptor;
+            clients[i].length = 0;
+            return;
+        }
+    }
+
+    HUB_LOG(LOG_LEVEL_WARNING, MODBUS_GATEWAY "too many clients, connection refused");
+    close(descriptor);
+}
+
+void ModbusGateway::drop(uint8_t client)
+{
+    if (clients[client].socket < 0)
+    {
+        return;
+    }
+
+    close(clients[client].socket);
+    clients[client].socket = -1;
+    clients[client].length = 0;
+    // Any response still waiting for the client is thrown away
+    clients[client].generation++;
+}
+
+void ModbusGateway::receive(uint8_t client)
+{
+    GatewayClient_t& state = clients[client];
+    ssize_t result = recv(state.socket, &state.buffer[state.length], sizeof(state.buffer) - state.length, 0);
+
+    if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        drop(client);
+        return;
+    }
+
+    if (result < 0)
+    {
+        return;
+    }
+
+    state.length += result;
+
+    // Clients may send several requests without waiting for the responses
+    while (state.socket >= 0 && state.length >= MBAP_HEADER_LENGTH)
+    {
+        uint16_t protocol = (state.buffer[2] << 8) | state.buffer[3];
+        uint16_t length = (state.buffer[4] << 8) | state.buffer[5];
+        uint16_t frameLength = length + MBAP_HEADER_LENGTH - 1;
+
+        // The length covers the unit id and a PDU with at least a function code
+        if (protocol != 0 || length < 2 || length > MODBUS_MAX_PDU_LENGTH + 1)
+        {
+            HUB_LOG(LOG_LEVEL_WARNING, MODBUS_GATEWAY "invalid frame, dropping the client");
+            drop(client);
+            return;
+        }
+
+        if (state.length < frameLength)
+        {
+            return;
+        }
+
+        submit(client, state.buffer, frameLength);
+
+        state.length -= frameLength;
+        memmove(state.buffer, &state.buffer[frameLength], state.length);
+    }
+}
+
+void ModbusGateway::submit(uint8_t client, const uint8_t* frame, uint16_t length)
+{
+    uint16_t transaction = (frame[0] << 8) | frame[1];
+    uint8_t unit = frame[MBAP_HEADER_LENGTH - 1];
+    const uint8_t* pdu = &frame[MBAP_HEADER_LENGTH];
+    uint16_t pduLength = length - MBAP_HEADER_LENGTH;
+    GatewayFlight_t* flight = NULL;
+
+    requests++;
+
+    // Broadcasts have no response to hand back, so only single devices are reachable
+    if (unit == MODBUS_BROADCAST_ADDRESS || unit > GATEWAY_MAX_UNIT)
+    {
+        exception(client, transaction, unit, pdu[0], GATEWAY_EXCEPTION_PATH_UNAVAILABLE);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(flightLock);
+
+        // A flight that is still waiting or on the bus can take more readers, a finished one cannot
+        for (uint8_t i = 0; isRead(pdu[0]) && flight == NULL && i < GATEWAY_MAX_FLIGHTS; i++)
+        {
+            GatewayFlight_t& candidate = flights[i];
+
+            if ((candidate.state == FLIGHT_QUEUED || candidate.state == FLIGHT_RUNNING) && candidate.unit == unit &&
+                candidate.requestLength == pduLength && candidate.waiterCount < GATEWAY_MAX_WAITERS &&
+                memcmp(candidate.request, pdu, pduLength) == 0)
+            {
+                flight = &candidate;
+            }
+        }
+
+        for (uint8_t i = 0; flight == NULL && i < GATEWAY_MAX_FLIGHTS; i++)
+        {
+            if (flights[i].state == FLIGHT_FREE)
+            {
+                flight = &flights[i];
+                flight->state = FLIGHT_QUEUED;
+                flight->order = order++;
+                flight->unit = unit;
+                memcpy(flight->request, pdu, pduLength);
+                flight->requestLength = pduLength;
+                flight->waiterCount = 0;
+                queued.notify_one();
+            }
+        }
+
+        if (flight != NULL)
+        {
+            GatewayWaiter_t& waiter = flight->waiters[flight->waiterCount++];
+
+            waiter.client = client;
+            waiter.generation = clients[client].generation;
+            waiter.transaction = transaction;
+            return;
+        }
+    }
+
+    exception(client, transaction, unit, pdu[0], GATEWAY_EXCEPTION_SERVER_BUSY);
+}
+
+void ModbusGateway::reply(uint8_t client, uint16_t transaction, uint8_t unit, const uint8_t* pdu, uint16_t length)
+{
+    uint8_t frame[MODBUS_TCP_MAX_ADU_LENGTH];
+    uint16_t mbapLength = length + 1;
+
+    if (clients[client].socket < 0)
+    {
+        return;
+    }
+
+    frame[0] = transaction >> 8;
+    frame[1] = transaction & 0xFF;
+    frame[2] = 0;
+    frame[3] = 0;
+    frame[4] = mbapLength >> 8;
+    frame[5] = mbapLength & 0xFF;
+    frame[6] = unit;
+    memcpy(&frame[MBAP_HEADER_LENGTH], pdu, length);
+
+    ssize_t frameLength = MBAP_HEADER_LENGTH + length;
+
+    // A client too slow to take a single response is dropped rather than holding up the others
+    if (send(clients[client].socket, frame, frameLength, MSG_NOSIGNAL) != frameLength)
+    {
+        drop(client);
+    }
+}
+
+void ModbusGateway::exception(uint8_t client, uint16_t transaction, uint8_t unit, uint8_t function, uint8_t code)
+{
+    uint8_t pdu[] = { (uint8_t) (function | EXCEPTION_FLAG), code };
+
+    reply(client, transaction, unit, pdu, sizeof(pdu));
+}
+
+void ModbusGateway::complete()
+{
+    uint8_t drain[GATEWAY_MAX_FLIGHTS];
+
+    while (read(wake[0], drain, sizeof(drain)) > 0) { }
+
+    lock_guard<mutex> lock(flightLock);
+
+    for (uint8_t i = 0; i < GATEWAY_MAX_FLIGHTS; i++)
+    {
+        GatewayFlight_t& flight = flights[i];
+
+        if (flight.state != FLIGHT_DONE)
+        {
+            continue;
+        }
+
+        for (uint8_t w = 0; w < flight.waiterCount; w++)
+        {
+            const GatewayWaiter_t& waiter = flight.waiters[w];
+
+            if (clients[waiter.client].generation != waiter.generation)
+            {
+                continue;
+            }
+
+            if (flight.responseLength < 0)
+            {
+                exception(waiter.client, waiter.transaction, flight.unit, flight.request[0], GATEWAY_EXCEPTION_TARGET_FAILED);
+            }
+            else
+            {
+                reply(waiter.client, waiter.transaction, flight.unit, flight.response, flight.responseLength);
+            }
+        }
+
+        flight.state = FLIGHT_FREE;
+    }
+}
+
+void ModbusGateway::forward()
+{
+    GatewayFlight_t* flight = NULL;
+
+    {
+        unique_lock<mutex> lock(flightLock);
+
+        while (flight == NULL)
+        {
+            for (uint8_t i = 0; i < GATEWAY_MAX_FLIGHTS; i++)
+            {
+                // Oldest first, compared by difference so the order can wrap
+                if (flights[i].state == FLIGHT_QUEUED && (flight == NULL || (int32_t) (flights[i].order - flight->order) < 0))
+                {
+                    flight = &flights[i];
+                }
+            }
+
+            if (flight == NULL)
+            {
+                queued.wait(lock);
+            }
+        }
+
+        flight->state = FLIGHT_RUNNING;
+    }
+
+    // The request is only written while the flight is free, and the response is only read once it is done,
+    // so neither needs the lock while the bus is busy
+    flight->responseLength = connection->forward(flight->unit, flight->request, flight->requestLength, flight->response);
+    transactions++;
+
+    {
+        lock_guard<mutex> lock(flightLock);
+        flight->state = FLIGHT_DONE;
+    }
+
+    uint8_t signal = 0;
+
+    if (write(wake[1], &signal, 1) < 0 && errno != EAGAIN)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, MODBUS_GATEWAY "unable to signal a response. Error: %s", std::strerror(errno));
+    }
+}
+
+GatewayStatistics_t ModbusGateway::getStatistics()
+{
+    GatewayStatistics_t statistics;
+    statistics.requests = requests;
+    statistics.transactions = transactions;
+    return statistics;
+}
+
+int32_t ModbusGateway::doExecute()
+{
+    pollfd descriptors[GATEWAY_MAX_CLIENTS + 2];
+    uint8_t indexes[GATEWAY_MAX_CLIENTS];
+    nfds_t count = 2;
+
+    if (listener < 0)
+    {
+        return GATEWAY_POLL_TIMEOUT;
+    }
+
+    descriptors[0].fd = wake[0];
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = listener;
+    descriptors[1].events = POLLIN;
+
+    for (uint8_t i = 0; i < GATEWAY_MAX_CLIENTS; i++)
+    {
+        if (clients[i].socket >= 0)
+        {
+            descriptors[count].fd = clients[i].socket;
+            descriptors[count].events = POLLIN;
+            indexes[count - 2] = i;
+            count++;
+        }
+    }
+
+    // The wait is in poll, so there is no delay before the next execute
+    if (poll(descriptors, count, GATEWAY_POLL_TIMEOUT) <= 0)
+    {
+        return 0;
+    }
+
+    if (descriptors[0].revents & POLLIN)
+    {
+        complete();
+    }
+
+    for (nfds_t i = 2; i < count; i++)
+    {
+        if (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            receive(indexes[i - 2]);
+        }
+    }
+
+    if (descriptors[1].revents & POLLIN)
+    {
+        accept();
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * File: MqttConnection.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "MqttConnection.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstddef>
+
+MqttConnection::MqttConnection() : mosquittoContext(NULL), host(NULL), port(0), connected(false), session(0), messageHandler(NULL), messageContext(NULL),
+    disconnectHandler(NULL), disconnectContext(NULL)
+{
+    mosquitto_lib_init();
+}
+
+MqttConnection::~MqttConnection()
+{
+    disconnect();
+
+    if (mosquittoContext != NULL)
+    {
+        mosquitto_destroy(mosquittoContext);
+    }
+
+    mosquitto_lib_cleanup();
+}
+
+void MqttConnection::onConnect(struct mosquitto* mosquittoContext, void* object, int result)
+{
+    MqttConnection* connection = (MqttConnection*) object;
+
+    if (result != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, "Error while connecting to the MQTT broker: %s", mosquitto_connack_string(result));
+        return;
+    }
+
+    connection->session++;
+    connection->connected = true;
+}
+
+void MqttConnection::onDisconnect(struct mosquitto* mosquittoContext, void* object, int result)
+{
+    MqttConnection* connection = (MqttConnection*) object;
+
+    connection->connected = false;
+
+    if (connection->disconnectHandler != NULL)
+    {
+        connection->disconnectHandler(connection->disconnectContext);
+    }
+}
+
+void MqttConnection::onMessage(struct mosquitto* mosquittoContext, void* object, const struct mosquitto_message* message)
+{
+    MqttConnection* connection = (MqttConnection*) object;
+
+    if (connection->messageHandler != NULL)
+    {
+        connection->messageHandler(message->topic, message->payload, message->payloadlen, connection->messageContext);
+    }
+}
+
+int MqttConnection::configure(const char* host, int port, const char* clientId)
+{
+    if (mosquittoContext != NULL)
+    {
+        mosquitto_destroy(mosquittoContext);
+    }
+
+    mosquittoContext = mosquitto_new(clientId, true, this);
+
+    if (mosquittoContext == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, "Error while creating the MQTT client: %s", clientId);
+        return -1;
+    }
+
+    this->host = host;
+    this->port = port;
+
+    mosquitto_connect_callback_set(mosquittoContext, onConnect);
+    mosquitto_disconnect_callback_set(mosquittoContext, onDisconnect);
+    mosquitto_message_callback_set(mosquittoContext, onMessage);
+    mosquitto_reconnect_delay_set(mosquittoContext, MQTT_RECONNECT_DELAY, MQTT_RECONNECT_DELAY_MAX, true);
+
+    return 0;
+}
+
+int MqttConnection::setWill(const char* topic, const void* payload, int length, int qos, bool retain)
+{
+    if (mosquittoContext == NULL)
+    {
+        return -1;
+    }
+
+    return mosquitto_will_set(mosquittoContext, topic, length, payload, qos, retain) == MOSQ_ERR_SUCCESS ? 0 : -1;
+}
+
+void MqttConnection::setMessageHandler(MqttMessageHandler handler, void* context)
+{
+    messageContext = context;
+    messageHandler = handler;
+}
+
+void MqttConnection::setDisconnectHandler(MqttDisconnectHandler handler, void* context)
+{
+    disconnectContext = context;
+    disconnectHandler = handler;
+}
+
+int MqttConnection::connect()
+{
+    if (mosquittoContext == NULL)
+    {
+        return -1;
+    }
+
+    int result = mosquitto_connect_async(mosquittoContext, host, port, MQTT_KEEP_ALIVE);
+
+    // The background thread keeps retrying, so a broker that is down at startup is not fatal
+    if (result != MOSQ_ERR_SUCCESS)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, "Error while connecting to the MQTT broker %s:%d. Error: %s", host, port, mosquitto_strerror(result));
+    }
+
+    return mosquitto_loop_start(mosquittoContext) == MOSQ_ERR_SUCCESS ? 0 : -1;
+}
+
+void MqttConnection::disconnect()
+{
+    if (mosquittoContext == NULL)
+    {
+        return;
+    }
+
+    mosquitto_disconnect(mosquittoContext);
+    mosquitto_loop_stop(mosquittoContext, false);
+    connected = false;
+}
+
+bool MqttConnection::isConnected()
+{
+    return connected;
+}
+
+uint32_t MqttConnection::getSession()
+{
+    return session;
+}
+
+int MqttConnection::publish(const char* topic, const void* payload, int length, int qos, bool retain)
+{
+    if (!connected)
+    {
+        return -1;
+    }
+
+    return mosquitto_publish(mosquittoContext, NULL, topic, length, payload, qos, retain) == MOSQ_ERR_SUCCESS ? 0 : -1;
+}
+
+int MqttConnection::subscribe(const char* topic, int qos)
+{
+    if (!connected)
+    {
+        return -1;
+    }
+
+    return mosquitto_subscribe(mosquittoContext, NULL, topic, qos) == MOSQ_ERR_SUCCESS ? 0 : -1;
+}
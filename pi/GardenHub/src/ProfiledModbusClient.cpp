@@ -0,0 +1,794 @@
+/*
+ * File: ProfiledModbusClient.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "ProfiledModbusClient.h"
+#include "HubConfig.h"
+#include "LightRamp.h"
+#include "ModbusEvents.h"
+#include "ModbusUtils.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include "Logger.h"
+
+/**
+ * @brief Milliseconds between reads of a group, resolving the periods taken from the device settings
+ * 
+ */
+static int32_t groupPeriod(const ProfileGroup_t& group, const DeviceConfig_t& settings)
+{
+    switch (group.period)
+    {
+        case PERIOD_POLL:
+            return settings.pollTime;
+        case PERIOD_TELEMETRY:
+            return settings.telemetryTime;
+        default:
+            return group.period;
+    }
+}
+
+/**
+ * @brief Gets the settings of a device. A device whose section is removed while running is disabled until it is back
+ * 
+ */
+static const DeviceConfig_t& deviceSettings(const HubConfig_t& config, const ProfiledDevice_t& device)
+{
+    static const DeviceConfig_t removed = DeviceConfig_t();
+    const DeviceConfig_t* settings = findDeviceConfig(&config, device.name);
+
+    return settings != NULL ? *settings : removed;
+}
+
+/**
+ * @brief Index of the write a profile keeps the light schedule with, or -1 if it has none
+ * 
+ */
+static int scheduleWrite(const DeviceProfile_t* profile)
+{
+    for (uint8_t i = 0; i < profile->writeCount; i++)
+    {
+        if (profile->writes[i].policy == WRITE_SCHEDULE)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+ProfiledModbusClient::ProfiledModbusClient(ModbusConnection* connection, SparkplugNode* node, ConfigStore* configStore, int bus) :
+    connection(connection), node(node), configStore(configStore), bus(bus), requestsAlias(-1), failuresAlias(-1), reconnectsAlias(-1), reconnects(0), deviceCount(0),
+    checkpointStaged(false), startTime(chrono::steady_clock::now()), polled(false)
+{
+    memset(&scene, 0, sizeof(scene));
+    memset(&groupCommand, 0, sizeof(groupCommand));
+    // Padding included, so unchanged state always checksums the same and the store can skip saving it
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    // Started from the clock, so a restarted hub is unlikely to repeat the last sequence a device saw
+    groupSequence = (uint16_t) time(NULL);
+
+    snprintf(requestsName, sizeof(requestsName), "Modbus/Bus %d/Requests", bus);
+    snprintf(failuresName, sizeof(failuresName), "Modbus/Bus %d/Failures", bus);
+    snprintf(reconnectsName, sizeof(reconnectsName), "Modbus/Bus %d/Reconnects", bus);
+
+    if (node != NULL)
+    {
+        requestsAlias = node->addMetric(requestsName, SPARKPLUG_UINT64);
+        failuresAlias = node->addMetric(failuresName, SPARKPLUG_UINT64);
+        reconnectsAlias = node->addMetric(reconnectsName, SPARKPLUG_UINT64);
+    }
+}
+
+int ProfiledModbusClient::addDevice(const DeviceProfile_t* profile, const char* name, int slaveId, const char* label)
+{
+    if (deviceCount >= PROFILE_MAX_DEVICES || strlen(name) >= CONFIG_STRING_LENGTH || profile->groupCount > PROFILE_MAX_GROUPS || profile->metricCount > PROFILE_MAX_METRICS)
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < profile->groupCount; i++)
+    {
+        const ProfileGroup_t& group = profile->groups[i];
+
+        if (group.table >= PROFILE_TABLE_COUNT || group.count == 0 || group.count > MODBUS_MAX_READ_REGISTERS ||
+            group.address + group.count > PROFILE_TABLE_SIZE)
+        {
+            return -1;
+        }
+    }
+
+    for (uint8_t i = 0; i < profile->writeCount; i++)
+    {
+        // Scheduled writes cover the command, ramp time and curve
+        if (profile->writes[i].address + (profile->writes[i].policy == WRITE_SCHEDULE ? 3 : 1) > PROFILE_TABLE_SIZE)
+        {
+            return -1;
+        }
+    }
+
+    if (profile->eventLog != NO_EVENT_LOG && profile->eventLog + EVENT_LOG_REGISTERS(profile->eventLogLength) > PROFILE_TABLE_SIZE)
+    {
+        return -1;
+    }
+
+    if (profile->groupRegisters != NO_GROUP_REGISTERS && profile->groupRegisters + GROUP_REGISTER_COUNT > PROFILE_TABLE_SIZE)
+    {
+        return -1;
+    }
+
+    ProfiledDevice_t& device = devices[deviceCount];
+
+    device.profile = profile;
+    device.slaveId = slaveId < 0 ? profile->slaveId : slaveId;
+    strcpy(device.name, name);
+    memset(device.registers, 0, sizeof(device.registers));
+    memset(device.uptimes, 0, sizeof(device.uptimes));
+    device.validGroups = 0;
+    device.readGroups = 0;
+    memset(&device.health, 0, sizeof(device.health));
+    device.eventSequence = 0;
+    device.eventUptime = 0;
+    device.synced = false;
+    // Every profiled device ramps its own lights, so the schedule only wakes for the start and end of a ramp
+    device.schedule = Schedule(true);
+    device.configVersion = 0;
+    device.scheduled = false;
+    device.groupPending = 0;
+    device.heldTarget = SCENE_NOT_HELD;
+
+    // Every group is read on the first execute
+    for (uint8_t i = 0; i < profile->groupCount; i++)
+    {
+        device.deadlines[i] = chrono::steady_clock::time_point();
+    }
+
+    for (uint8_t i = 0; i < profile->metricCount; i++)
+    {
+        const ProfileMetric_t& metric = profile->metrics[i];
+        size_t prefixLength = strlen(profile->name);
+        char* metricName = device.metricNames[i];
+
+        if (node == NULL)
+        {
+            device.aliases[i] = -1;
+            continue;
+        }
+
+        // Garden Bed/Light Level of a device labelled bed2 is published as Garden Bed/bed2/Light Level
+        if (label == NULL)
+        {
+            snprintf(metricName, PROFILE_METRIC_NAME_LENGTH, "%s", metric.name);
+        }
+        else if (strncmp(metric.name, profile->name, prefixLength) == 0 && metric.name[prefixLength] == '/')
+        {
+            snprintf(metricName, PROFILE_METRIC_NAME_LENGTH, "%s/%s%s", profile->name, label, &metric.name[prefixLength]);
+        }
+        else
+        {
+            snprintf(metricName, PROFILE_METRIC_NAME_LENGTH, "%s/%s", label, metric.name);
+        }
+
+        switch (metric.type)
+        {
+            case METRIC_NUMBER:
+                // Values with units are published in their base unit, everything else is an enum or a count
+                device.aliases[i] = metric.value.unit == UNIT_NONE ?
+                    node->addMetric(metricName, SPARKPLUG_INT32) :
+                    node->addMetric(metricName, SPARKPLUG_FLOAT, metric.value.exponent);
+                break;
+            case METRIC_BOOLEAN:
+                device.aliases[i] = node->addMetric(metricName, SPARKPLUG_BOOLEAN);
+                break;
+            case METRIC_STRING:
+                device.aliases[i] = node->addMetric(metricName, SPARKPLUG_STRING);
+                break;
+            case METRIC_UPTIME:
+                device.aliases[i] = node->addMetric(metricName, SPARKPLUG_UINT64);
+                break;
+            default:
+                device.aliases[i] = -1;
+                break;
+        }
+    }
+
+    return deviceCount++;
+}
+
+int ProfiledModbusClient::readGroup(ProfiledDevice_t& device, const ProfileGroup_t& group)
+{
+    uint16_t* registers = &device.registers[group.table][group.address];
+
+    if (group.table == TABLE_INPUT_REGISTERS)
+    {
+        return connection->readInputRegisters(device.slaveId, group.address, group.count, registers);
+    }
+
+    return connection->readRegisters(device.slaveId, group.address, group.count, registers);
+}
+
+void ProfiledModbusClient::readEvents(ProfiledDevice_t& device)
+{
+    const DeviceProfile_t* profile = device.profile;
+    ModbusEvent_t events[UINT8_MAX];
+    const uint16_t* log = &device.registers[TABLE_INPUT_REGISTERS][profile->eventLog];
+    int count = readEventLog(log, profile->eventLogLength, &device.eventSequence, &device.eventUptime, events);
+
+    if (count < 0)
+    {
+        // Events were missed or the device restarted, so every group is read again to catch up
+        for (uint8_t i = 0; i < profile->groupCount; i++)
+        {
+            device.deadlines[i] = chrono::steady_clock::time_point();
+        }
+
+        if (device.synced)
+        {
+            HUB_LOG(LOG_LEVEL_WARNING, "%s: missed events, reading every register", profile->name);
+        }
+
+        device.synced = true;
+        return;
+    }
+
+    // Events from before the hub started are already reflected in the registers
+    for (int i = 0; device.synced && i < count; i++)
+    {
+        const char* name = events[i].type < profile->eventNameCount ? profile->eventNames[events[i].type] : "unknown";
+
+        HUB_LOG(LOG_LEVEL_INFO, "%s: %s event %u, %us ago", profile->name, name, events[i].value, device.eventUptime - events[i].time);
+    }
+
+    device.synced = true;
+}
+
+void ProfiledModbusClient::publishGroup(ProfiledDevice_t& device, const ProfileGroup_t& group, bool cached)
+{
+    const DeviceProfile_t* profile = device.profile;
+    const uint16_t* registers = device.registers[group.table];
+
+    // The uptime in the log is needed to convert METRIC_UPTIME values, so events are read first
+    if (!cached && group.table == TABLE_INPUT_REGISTERS && profile->eventLog != NO_EVENT_LOG && profile->eventLog >= group.address &&
+        profile->eventLog + EVENT_LOG_REGISTERS(profile->eventLogLength) <= group.address + group.count)
+    {
+        readEvents(device);
+    }
+
+    if (node == NULL)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < profile->metricCount; i++)
+    {
+        const ProfileMetric_t& metric = profile->metrics[i];
+        uint16_t address = metric.value.address;
+
+        if (!metricInGroup(metric, group))
+        {
+            continue;
+        }
+
+        switch (metric.type)
+        {
+            case METRIC_NUMBER:
+            {
+                Measurement_t measurement;
+
+                // Unchanged values are dropped by the node, so every metric can be passed on each read
+                if (convertRegisters(registers, PROFILE_TABLE_SIZE, &metric.value, 1, &measurement) == 1)
+                {
+                    node->update(device.aliases[i], measurement);
+                }
+                break;
+            }
+            case METRIC_BOOLEAN:
+                node->update(device.aliases[i], registers[address] != 0);
+                break;
+            case METRIC_STRING:
+            {
+                char value[SPARKPLUG_STRING_LENGTH];
+
+                // Spans are zero until the device has something to put in them
+                if (unpackStringRegisters(&registers[address], metric.length, value, sizeof(value)) > 0)
+                {
+                    node->update(device.aliases[i], value);
+                }
+                break;
+            }
+            case METRIC_UPTIME:
+            {
+                uint32_t uptime = ((uint32_t) registers[address] << 16) | registers[address + 1];
+
+                // Converted to the wall clock once per change, converting every read would jitter by the uptime resolution.
+                // A cached uptime is from before the restart, so it waits for the device to be read
+                if (!cached && profile->eventLog != NO_EVENT_LOG && uptime != device.uptimes[i])
+                {
+                    int64_t wallNow = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+                    node->update(device.aliases[i], wallNow - (int64_t) (device.eventUptime - uptime) * 1000);
+                    device.uptimes[i] = uptime;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void ProfiledModbusClient::writeDevice(ProfiledDevice_t& device, const HubConfig_t& config, uint32_t version, chrono::steady_clock::time_point now)
+{
+    const DeviceProfile_t* profile = device.profile;
+    const DeviceConfig_t& settings = deviceSettings(config, device);
+
+    for (uint8_t i = 0; i < profile->writeCount; i++)
+    {
+        const ProfileWrite_t& write = profile->writes[i];
+        uint16_t* current = &device.registers[TABLE_HOLDING_REGISTERS][write.address];
+
+        switch (write.policy)
+        {
+            case WRITE_SCHEDULE:
+            {
+                if (!device.scheduled || version != device.configVersion)
+                {
+                    ScheduleProgram_t program;
+
+                    deviceProgram(&settings, &program);
+                    device.schedule.setProgram(program, config.location.latitude, config.location.longitude);
+                    device.configVersion = version;
+                    device.scheduled = true;
+                }
+
+                // The wall clock is only read at transitions, every other execute is a single comparison
+                if (device.schedule.due(now))
+                {
+                    device.schedule.update(time(NULL), now);
+                }
+
+                int32_t target = device.schedule.getTarget();
+
+                // A scene holds until the schedule moves on to another level
+                if (device.heldTarget != SCENE_NOT_HELD)
+                {
+                    if (target == device.heldTarget)
+                    {
+                        break;
+                    }
+
+                    device.heldTarget = SCENE_NOT_HELD;
+                }
+
+                if (*current == target)
+                {
+                    break;
+                }
+
+                // The command, ramp time and curve are contiguous, so a whole fade is a single request
+                int32_t rampTime = device.schedule.untilRampEnd(now) / LIGHT_RAMP_TIME_UNIT;
+                uint16_t command[] = {
+                    (uint16_t) target,
+                    (uint16_t) (rampTime < UINT16_MAX ? rampTime : UINT16_MAX),
+                    (uint16_t) settings.rampCurve
+                };
+
+                // The mirror is updated straight away, the next read of the group confirms it
+                if (connection->writeRegisters(device.slaveId, write.address, 3, command) >= 0)
+                {
+                    memcpy(current, command, sizeof(command));
+                    HUB_LOG(LOG_LEVEL_INFO, "%s: ramping to %d%% over %dms", profile->name, target, command[1] * LIGHT_RAMP_TIME_UNIT);
+                }
+                break;
+            }
+            case WRITE_CONSTANT:
+                if (*current != write.value && connection->writeRegister(device.slaveId, write.address, write.value) >= 0)
+                {
+                    *current = write.value;
+                }
+                break;
+            case WRITE_GROUPS:
+                if (*current != settings.groups && connection->writeRegister(device.slaveId, write.address, settings.groups) >= 0)
+                {
+                    *current = settings.groups;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void ProfiledModbusClient::writeScene(const HubConfig_t& config, chrono::steady_clock::time_point now)
+{
+    const SceneConfig_t& next = config.scene;
+
+    // Only a change is sent, so a scene stays until the schedules move on rather than being sent again
+    if (memcmp(&next, &scene, sizeof(SceneConfig_t)) == 0)
+    {
+        return;
+    }
+
+    if (!next.enabled)
+    {
+        // The schedules take over again straight away
+        for (uint8_t i = 0; i < deviceCount; i++)
+        {
+            devices[i].heldTarget = SCENE_NOT_HELD;
+            devices[i].groupPending = 0;
+        }
+
+        scene = next;
+        return;
+    }
+
+    uint16_t registers[GROUP_COMMAND_REGISTERS];
+
+    groupSequence = nextGroupSequence(groupSequence);
+    groupCommand.mask = next.groups;
+    groupCommand.sequence = groupSequence;
+    groupCommand.level = next.level;
+    groupCommand.rampTime = next.rampTime * 1000 / LIGHT_RAMP_TIME_UNIT;
+    groupCommand.rampCurve = next.rampCurve;
+    packGroupCommand(&groupCommand, registers);
+
+    // A broadcast that could not be sent is tried again on the next execute
+    if (connection->broadcastRegisters(GROUP_BROADCAST_ID, GROUP_REGISTER(GROUP_MASK), GROUP_COMMAND_REGISTERS, registers) < 0)
+    {
+        return;
+    }
+
+    scene = next;
+    HUB_LOG(LOG_LEVEL_INFO, "Scene: %d%% for groups %d over %ds", next.level, next.groups, next.rampTime);
+
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        ProfiledDevice_t& device = devices[i];
+        const DeviceProfile_t* profile = device.profile;
+        const DeviceConfig_t& settings = deviceSettings(config, device);
+        int write = scheduleWrite(profile);
+
+        if (!settings.enabled || write < 0 || profile->groupRegisters == NO_GROUP_REGISTERS || !inGroups(settings.groups, next.groups))
+        {
+            continue;
+        }
+
+        uint16_t* command = &device.registers[TABLE_HOLDING_REGISTERS][profile->writes[write].address];
+
+        device.groupPending = groupSequence;
+        device.heldTarget = device.scheduled ? device.schedule.getTarget() : SCENE_NOT_HELD;
+        // The mirror is updated straight away, as for a write to the device alone
+        command[0] = groupCommand.level;
+        command[1] = groupCommand.rampTime;
+        command[2] = groupCommand.rampCurve;
+
+        // Verified by the next read of the block, once the device has had time to act on it
+        for (uint8_t g = 0; g < profile->groupCount; g++)
+        {
+            const ProfileGroup_t& group = profile->groups[g];
+            chrono::steady_clock::time_point verify = now + chrono::milliseconds(GROUP_VERIFY_DELAY);
+
+            if (group.table == TABLE_HOLDING_REGISTERS && group.address <= profile->groupRegisters + GROUP_APPLIED &&
+                group.address + group.count > profile->groupRegisters + GROUP_APPLIED && verify < device.deadlines[g])
+            {
+                device.deadlines[g] = verify;
+            }
+        }
+    }
+}
+
+void ProfiledModbusClient::verifyScene(ProfiledDevice_t& device, const ProfileGroup_t& group)
+{
+    const DeviceProfile_t* profile = device.profile;
+
+    if (device.groupPending == 0 || group.table != TABLE_HOLDING_REGISTERS || group.address > profile->groupRegisters + GROUP_APPLIED ||
+        group.address + group.count <= profile->groupRegisters + GROUP_APPLIED)
+    {
+        return;
+    }
+
+    if (device.registers[TABLE_HOLDING_REGISTERS][profile->groupRegisters + GROUP_APPLIED] != device.groupPending)
+    {
+        // Missed the broadcast, or was not in the group yet, so the scene is written to the device alone
+        uint16_t command[] = { groupCommand.level, groupCommand.rampTime, groupCommand.rampCurve };
+
+        // Left pending when it fails, so it is tried again on the next read of the block
+        if (connection->writeRegisters(device.slaveId, profile->writes[scheduleWrite(profile)].address, 3, command) < 0)
+        {
+            return;
+        }
+
+        HUB_LOG(LOG_LEVEL_WARNING, "%s: missed scene %u, written directly", profile->name, device.groupPending);
+    }
+
+    device.groupPending = 0;
+}
+
+void ProfiledModbusClient::stageCheckpoint(chrono::steady_clock::time_point now)
+{
+    if (checkpointStaged && now - stageTime < chrono::milliseconds(CHECKPOINT_STAGE_TIME))
+    {
+        return;
+    }
+
+    lock_guard<mutex> guard(checkpointLock);
+
+    checkpoint.deviceCount = deviceCount;
+    checkpoint.scene = scene;
+    checkpoint.groupCommand = groupCommand;
+    checkpoint.groupSequence = groupSequence;
+    stagedAt = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        const ProfiledDevice_t& device = devices[i];
+        DeviceCheckpoint_t& saved = checkpoint.devices[i];
+
+        memset(saved.profile, 0, sizeof(saved.profile));
+        strncpy(saved.profile, device.profile->name, sizeof(saved.profile) - 1);
+        saved.slaveId = device.slaveId;
+        saved.validGroups = device.validGroups;
+        memcpy(saved.registers, device.registers, sizeof(saved.registers));
+        saved.eventSequence = device.eventSequence;
+        saved.eventUptime = device.eventUptime;
+        saved.synced = device.synced;
+        saved.groupPending = device.groupPending;
+        saved.heldTarget = device.heldTarget;
+        health[i] = device.health;
+    }
+
+    checkpointStaged = true;
+    stageTime = now;
+}
+
+int ProfiledModbusClient::getBus()
+{
+    return bus;
+}
+
+int ProfiledModbusClient::getCheckpoint(ClientCheckpoint_t* checkpoint)
+{
+    lock_guard<mutex> guard(checkpointLock);
+
+    if (!checkpointStaged)
+    {
+        return -1;
+    }
+
+    // Only the devices in use are copied, the rest of the copy is left as it was
+    memcpy(checkpoint, &this->checkpoint, offsetof(ClientCheckpoint_t, devices) + this->checkpoint.deviceCount * sizeof(DeviceCheckpoint_t));
+    return 0;
+}
+
+int ProfiledModbusClient::getHealth(DeviceHealth_t* health, int64_t* stagedAt)
+{
+    lock_guard<mutex> guard(checkpointLock);
+
+    if (!checkpointStaged)
+    {
+        return -1;
+    }
+
+    memcpy(health, this->health, checkpoint.deviceCount * sizeof(DeviceHealth_t));
+    *stagedAt = this->stagedAt;
+    return checkpoint.deviceCount;
+}
+
+const DeviceProfile_t* ProfiledModbusClient::getProfile(int index)
+{
+    return index >= 0 && index < deviceCount ? devices[index].profile : NULL;
+}
+
+const char* ProfiledModbusClient::getName(int index)
+{
+    return index >= 0 && index < deviceCount ? devices[index].name : NULL;
+}
+
+ModbusConnection* ProfiledModbusClient::getConnection()
+{
+    return connection;
+}
+
+int ProfiledModbusClient::restore(const ClientCheckpoint_t& checkpoint)
+{
+    int restored = 0;
+
+    scene = checkpoint.scene;
+    groupCommand = checkpoint.groupCommand;
+    groupSequence = checkpoint.groupSequence;
+
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        ProfiledDevice_t& device = devices[i];
+        const DeviceProfile_t* profile = device.profile;
+
+        for (uint8_t c = 0; c < checkpoint.deviceCount && c < PROFILE_MAX_DEVICES; c++)
+        {
+            const DeviceCheckpoint_t& saved = checkpoint.devices[c];
+
+            if (saved.slaveId != device.slaveId || strncmp(saved.profile, profile->name, sizeof(saved.profile)) != 0)
+            {
+                continue;
+            }
+
+            // Groups a profile no longer has are left out, their registers may have moved
+            device.validGroups = saved.validGroups & ((1 << profile->groupCount) - 1);
+            memcpy(device.registers, saved.registers, sizeof(device.registers));
+            // Events logged while the hub was down are reported on the first read, rather than taken as already seen
+            device.eventSequence = saved.eventSequence;
+            device.eventUptime = saved.eventUptime;
+            device.synced = saved.synced;
+            device.groupPending = saved.groupPending;
+            device.heldTarget = saved.heldTarget;
+
+            for (uint8_t g = 0; g < profile->groupCount; g++)
+            {
+                if (device.validGroups & (1 << g))
+                {
+                    publishGroup(device, profile->groups[g], true);
+                }
+            }
+
+            restored++;
+            break;
+        }
+    }
+
+    return restored;
+}
+
+int32_t ProfiledModbusClient::doExecute()
+{
+    // The version is read first, so a reload in between is picked up again on the next execute
+    uint32_t version = configStore != NULL ? configStore->getVersion() : 0;
+    // The snapshot is held for the whole execute, so a reload part way through cannot mix settings
+    shared_ptr<const HubConfig_t> config = configStore != NULL ? configStore->get() : ConfigStore::defaults();
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    int32_t wait = PROFILE_MAX_WAIT;
+    ModbusStatistics_t statistics = connection->getStatistics();
+
+    if (statistics.reconnects != reconnects)
+    {
+        // The devices may have changed or restarted while the bus was down. Their registers and any pending
+        // writes and scenes are kept, and every group is read straight away to bring them up to date
+        for (uint8_t i = 0; i < deviceCount; i++)
+        {
+            for (uint8_t g = 0; g < devices[i].profile->groupCount; g++)
+            {
+                devices[i].deadlines[g] = chrono::steady_clock::time_point();
+            }
+        }
+        reconnects = statistics.reconnects;
+    }
+
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        ProfiledDevice_t& device = devices[i];
+        const DeviceProfile_t* profile = device.profile;
+        const DeviceConfig_t& settings = deviceSettings(*config, device);
+
+        device.health.enabled = settings.enabled;
+
+        if (!settings.enabled)
+        {
+            continue;
+        }
+
+        for (uint8_t g = 0; g < profile->groupCount; g++)
+        {
+            const ProfileGroup_t& group = profile->groups[g];
+
+            if (now < device.deadlines[g])
+            {
+                continue;
+            }
+
+            // Failed reads wait for the next period rather than retrying straight away and holding up the bus
+            device.deadlines[g] = now + chrono::milliseconds(groupPeriod(group, settings));
+
+            if (readGroup(device, group) < 0)
+            {
+                device.health.failures++;
+                device.health.consecutiveFailures++;
+                device.health.online = device.health.consecutiveFailures < PROFILE_OFFLINE_FAILURES;
+            }
+            else
+            {
+                device.health.reads++;
+                device.health.consecutiveFailures = 0;
+                device.health.online = true;
+                device.health.lastRead = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+                device.validGroups |= 1 << g;
+                device.readGroups |= 1 << g;
+                publishGroup(device, group);
+                verifyScene(device, group);
+            }
+        }
+
+        writeDevice(device, *config, version, now);
+    }
+
+    // After the schedules, so a new scene holds against the level they have just moved to
+    writeScene(*config, now);
+    stageCheckpoint(now);
+
+    bool complete = true;
+
+    for (uint8_t i = 0; i < deviceCount; i++)
+    {
+        ProfiledDevice_t& device = devices[i];
+        const DeviceProfile_t* profile = device.profile;
+
+        if (!deviceSettings(*config, device).enabled)
+        {
+            continue;
+        }
+
+        complete = complete && device.readGroups == (1 << profile->groupCount) - 1;
+
+        // Wake for whichever group or scheduled transition comes first
+        for (uint8_t g = 0; g < profile->groupCount; g++)
+        {
+            int32_t until = device.deadlines[g] <= now ? 0 : (int32_t) chrono::duration_cast<chrono::milliseconds>(device.deadlines[g] - now).count();
+
+            wait = until < wait ? until : wait;
+        }
+
+        if (device.scheduled)
+        {
+            int32_t until = device.schedule.untilDeadline(now);
+
+            wait = until < wait ? until : wait;
+        }
+    }
+
+    // How long the hub runs on what it had before the devices answer, with or without a checkpoint
+    if (!polled && complete)
+    {
+        HUB_LOG(LOG_LEVEL_INFO, "Bus %d: every device read %dms after the start", bus,
+            (int) chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime).count());
+        polled = true;
+    }
+
+    if (node != NULL)
+    {
+        statistics = connection->getStatistics();
+
+        node->update(requestsAlias, (int64_t) statistics.requests);
+        node->update(failuresAlias, (int64_t) statistics.failures);
+        node->update(reconnectsAlias, (int64_t) statistics.reconnects);
+    }
+
+    return wait;
+}
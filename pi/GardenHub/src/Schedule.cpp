@@ -0,0 +1,351 @@
+/*
+ * File: Schedule.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "Schedule.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define DEGREES (M_PI / 180.0)
+// Julian dates of the unix epoch and of J2000
+#define JULIAN_UNIX_EPOCH 2440587.5
+#define JULIAN_2000 2451545.0
+// Refraction and the radius of the sun put sunrise and sunset slightly below the horizon
+#define SUN_ALTITUDE -0.833
+#define EARTH_TILT 23.4397
+
+#define MISSING_TIME ((time_t) -1)
+#define DAYS_EVALUATED 3
+#define MAX_WHEN_LENGTH 32
+
+/**
+ * @brief Days since the unix epoch of a civil date
+ * 
+ */
+static int64_t daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+int sunTimes(int year, int month, int day, double latitude, double longitude, time_t* sunrise, time_t* sunset)
+{
+    // Days since J2000 of the solar noon nearest the date at this longitude
+    double n = daysFromCivil(year, month, day) + JULIAN_UNIX_EPOCH + 0.5 - JULIAN_2000 + 0.0008;
+    double meanNoon = n - longitude / 360.0;
+    double anomaly = fmod(357.5291 + 0.98560028 * meanNoon, 360.0);
+    double centre = 1.9148 * sin(anomaly * DEGREES) + 0.02 * sin(2 * anomaly * DEGREES) + 0.0003 * sin(3 * anomaly * DEGREES);
+    double eclipticLongitude = fmod(anomaly + centre + 180.0 + 102.9372, 360.0);
+    double transit = JULIAN_2000 + meanNoon + 0.0053 * sin(anomaly * DEGREES) - 0.0069 * sin(2 * eclipticLongitude * DEGREES);
+    double declination = asin(sin(eclipticLongitude * DEGREES) * sin(EARTH_TILT * DEGREES));
+    double hourAngle = (sin(SUN_ALTITUDE * DEGREES) - sin(latitude * DEGREES) * sin(declination)) /
+        (cos(latitude * DEGREES) * cos(declination));
+
+    // Polar day or night
+    if (hourAngle < -1.0 || hourAngle > 1.0)
+    {
+        return -1;
+    }
+
+    double halfDay = acos(hourAngle) / DEGREES / 360.0;
+
+    *sunrise = (time_t) llround((transit - halfDay - JULIAN_UNIX_EPOCH) * 86400.0);
+    *sunset = (time_t) llround((transit + halfDay - JULIAN_UNIX_EPOCH) * 86400.0);
+
+    return 0;
+}
+
+/**
+ * @brief Parses the time of an event, HH:MM or an anchor with an optional minute offset
+ * 
+ */
+static int parseWhen(const char* when, ScheduleEvent_t* event)
+{
+    const char* offset = NULL;
+    int hours, minutes;
+    char extra;
+
+    if (strncmp(when, "sunrise", 7) == 0)
+    {
+        event->anchor = ANCHOR_SUNRISE;
+        offset = when + 7;
+    }
+    else if (strncmp(when, "sunset", 6) == 0)
+    {
+        event->anchor = ANCHOR_SUNSET;
+        offset = when + 6;
+    }
+
+    if (offset != NULL)
+    {
+        char* end;
+
+        if (*offset == '\0')
+        {
+            event->offset = 0;
+            return 0;
+        }
+
+        if (*offset != '+' && *offset != '-')
+        {
+            return -1;
+        }
+
+        event->offset = strtol(offset, &end, 10);
+        return *end == '\0' && abs(event->offset) < 24 * 60 ? 0 : -1;
+    }
+
+    if (sscanf(when, "%d:%d%c", &hours, &minutes, &extra) != 2 || hours < 0 || hours > 23 || minutes < 0 || minutes > 59)
+    {
+        return -1;
+    }
+
+    event->anchor = ANCHOR_MIDNIGHT;
+    event->offset = hours * 60 + minutes;
+
+    return 0;
+}
+
+int parseScheduleProgram(const char* text, ScheduleProgram_t* program)
+{
+    char token[MAX_WHEN_LENGTH * 2];
+    char when[MAX_WHEN_LENGTH];
+    char extra;
+
+    program->count = 0;
+
+    while (*text != '\0')
+    {
+        size_t length = strcspn(text, ",");
+
+        if (length >= sizeof(token) || program->count >= SCHEDULE_MAX_EVENTS)
+        {
+            return -1;
+        }
+
+        memcpy(token, text, length);
+        token[length] = '\0';
+        text += text[length] == ',' ? length + 1 : length;
+
+        ScheduleEvent_t* event = &program->events[program->count];
+        event->ramp = 0;
+
+        int fields = sscanf(token, "%31s %d %d %c", when, &event->level, &event->ramp, &extra);
+
+        if (fields < 2 || fields > 3 || event->level < 0 || event->level > SCHEDULE_MAX_LEVEL || event->ramp < 0 || parseWhen(when, event) != 0)
+        {
+            return -1;
+        }
+
+        program->count++;
+    }
+
+    return 0;
+}
+
+Schedule::Schedule(bool deviceRamps) : latitude(0), longitude(0), level(0), target(0), valid(false), deviceRamps(deviceRamps)
+{
+    program.count = 0;
+}
+
+void Schedule::setProgram(const ScheduleProgram_t& program, double latitude, double longitude)
+{
+    this->program = program;
+    this->latitude = latitude;
+    this->longitude = longitude;
+    valid = false;
+}
+
+int Schedule::eventTimes(const struct tm* date, time_t* times)
+{
+    time_t sunrise = MISSING_TIME, sunset = MISSING_TIME;
+    bool sun = sunTimes(date->tm_year + 1900, date->tm_mon + 1, date->tm_mday, latitude, longitude, &sunrise, &sunset) == 0;
+
+    for (uint8_t i = 0; i < program.count; i++)
+    {
+        const ScheduleEvent_t& event = program.events[i];
+
+        switch (event.anchor)
+        {
+            case ANCHOR_MIDNIGHT:
+            {
+                // Built from the local date so daylight saving changes are respected
+                struct tm local = *date;
+                local.tm_hour = 0;
+                local.tm_min = event.offset;
+                local.tm_sec = 0;
+                local.tm_isdst = -1;
+                times[i] = mktime(&local);
+                break;
+            }
+            case ANCHOR_SUNRISE:
+                times[i] = sun ? sunrise + event.offset * 60 : MISSING_TIME;
+                break;
+            case ANCHOR_SUNSET:
+                times[i] = sun ? sunset + event.offset * 60 : MISSING_TIME;
+                break;
+            default:
+                times[i] = MISSING_TIME;
+                break;
+        }
+    }
+
+    return sun ? 0 : -1;
+}
+
+int32_t Schedule::update(time_t wallNow, chrono::steady_clock::time_point now)
+{
+    time_t times[DAYS_EVALUATED * SCHEDULE_MAX_EVENTS];
+    uint8_t events[DAYS_EVALUATED * SCHEDULE_MAX_EVENTS];
+    int count = 0;
+    struct tm today;
+    time_t nextChange = wallNow + SCHEDULE_MAX_DEADLINE;
+
+    localtime_r(&wallNow, &today);
+
+    // Yesterday's events are needed for the level at the start of today, and tomorrow's for the next deadline
+    for (int day = -1; day <= 1; day++)
+    {
+        struct tm date = today;
+        time_t dayTimes[SCHEDULE_MAX_EVENTS];
+
+        date.tm_mday += day;
+        date.tm_hour = 12;
+        date.tm_min = 0;
+        date.tm_sec = 0;
+        date.tm_isdst = -1;
+        mktime(&date);
+        eventTimes(&date, dayTimes);
+
+        for (uint8_t i = 0; i < program.count; i++)
+        {
+            if (dayTimes[i] == MISSING_TIME)
+            {
+                continue;
+            }
+
+            // Insertion sort, there are only ever a couple of dozen events
+            int position = count++;
+
+            while (position > 0 && times[position - 1] > dayTimes[i])
+            {
+                times[position] = times[position - 1];
+                events[position] = events[position - 1];
+                position--;
+            }
+
+            times[position] = dayTimes[i];
+            events[position] = i;
+        }
+    }
+
+    int active = -1;
+
+    while (active + 1 < count && times[active + 1] <= wallNow)
+    {
+        active++;
+    }
+
+    rampEnd = now;
+
+    if (active < 0)
+    {
+        level = 0;
+    }
+    else
+    {
+        const ScheduleEvent_t& event = program.events[events[active]];
+        int32_t previous = active > 0 ? program.events[events[active - 1]].level : event.level;
+        time_t elapsed = wallNow - times[active];
+
+        if (event.ramp > 0 && elapsed < event.ramp && previous != event.level)
+        {
+            int32_t difference = event.level - previous;
+            int32_t step = event.ramp / abs(difference);
+
+            level = previous + (int32_t) ((int64_t) difference * elapsed / event.ramp);
+            rampEnd = now + chrono::seconds(event.ramp - elapsed);
+
+            // A device ramping by itself only needs waking at the end of the ramp
+            if (!deviceRamps)
+            {
+                nextChange = wallNow + (step > SCHEDULE_RAMP_STEP ? step : SCHEDULE_RAMP_STEP);
+            }
+
+            if (nextChange > times[active] + event.ramp)
+            {
+                nextChange = times[active] + event.ramp;
+            }
+        }
+        else
+        {
+            level = event.level;
+        }
+    }
+
+    if (active + 1 < count && times[active + 1] < nextChange)
+    {
+        nextChange = times[active + 1];
+    }
+
+    target = active < 0 ? level : program.events[events[active]].level;
+    deadline = now + chrono::seconds(nextChange - wallNow);
+    valid = true;
+
+    return level;
+}
+
+int32_t Schedule::untilRampEnd(chrono::steady_clock::time_point now) const
+{
+    if (!valid || now >= rampEnd)
+    {
+        return 0;
+    }
+
+    return (int32_t) chrono::duration_cast<chrono::milliseconds>(rampEnd - now).count();
+}
+
+int32_t Schedule::untilDeadline(chrono::steady_clock::time_point now) const
+{
+    if (due(now))
+    {
+        return 0;
+    }
+
+    return (int32_t) chrono::duration_cast<chrono::milliseconds>(deadline - now).count();
+}
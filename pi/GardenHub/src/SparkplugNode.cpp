@@ -0,0 +1,398 @@
+/*
+ * File: SparkplugNode.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "SparkplugNode.h"
+#include "Logger.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+// bdSeq and Rebirth are the first two metrics of every node
+#define BIRTH_SEQUENCE_ALIAS 0
+#define REBIRTH_ALIAS 1
+
+#define SPARKPLUG_NODE "Sparkplug Node: "
+
+static uint64_t currentTimestamp()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+SparkplugNode::SparkplugNode(MqttConnection* connection, const char* group, const char* node) :
+    connection(connection), metricCount(0), changedCount(0), sequence(0), birthSession(0), rebirth(false),
+    payload(buffer, SPARKPLUG_BUFFER_SIZE)
+{
+    snprintf(birthTopic, SPARKPLUG_TOPIC_LENGTH, SPARKPLUG_NAMESPACE "/%s/NBIRTH/%s", group, node);
+    snprintf(dataTopic, SPARKPLUG_TOPIC_LENGTH, SPARKPLUG_NAMESPACE "/%s/NDATA/%s", group, node);
+    snprintf(deathTopic, SPARKPLUG_TOPIC_LENGTH, SPARKPLUG_NAMESPACE "/%s/NDEATH/%s", group, node);
+    snprintf(commandTopic, SPARKPLUG_TOPIC_LENGTH, SPARKPLUG_NAMESPACE "/%s/NCMD/%s", group, node);
+
+    memset(&statistics, 0, sizeof(statistics));
+
+    addMetric(SPARKPLUG_BIRTH_SEQUENCE_NAME, SPARKPLUG_UINT64);
+    addMetric(SPARKPLUG_REBIRTH_NAME, SPARKPLUG_BOOLEAN);
+}
+
+/**
+ * @brief Reads the last bdSeq saved
+ * 
+ * @return bool false if there is none
+ */
+static bool loadBirthSequence(const string& path, int64_t* birthSequence)
+{
+    FILE* file = fopen(path.c_str(), "r");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    unsigned int value;
+    bool loaded = fscanf(file, "%u", &value) == 1 && value <= SPARKPLUG_BIRTH_SEQUENCE_MAX;
+
+    fclose(file);
+
+    if (loaded)
+    {
+        *birthSequence = value;
+    }
+
+    return loaded;
+}
+
+static void saveBirthSequence(const string& path, int64_t birthSequence)
+{
+    string temporary = path + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "w");
+
+    if (file == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, SPARKPLUG_NODE "unable to write %s. Error: %s", temporary.c_str(), strerror(errno));
+        return;
+    }
+
+    bool written = fprintf(file, "%u\n", (unsigned int) birthSequence) > 0 && fflush(file) == 0 && fsync(fileno(file)) == 0;
+
+    fclose(file);
+
+    // Renamed into place, so a power cut leaves either the old or the new bdSeq
+    if (!written || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, SPARKPLUG_NODE "unable to save %s. Error: %s", path.c_str(), strerror(errno));
+        remove(temporary.c_str());
+    }
+}
+
+int SparkplugNode::setWill()
+{
+    SparkplugMetric_t* birthSequence = &metrics[BIRTH_SEQUENCE_ALIAS];
+
+    birthSequence->value = birthSequence->value >= SPARKPLUG_BIRTH_SEQUENCE_MAX ? 0 : birthSequence->value + 1;
+    birthSequence->timestamp = currentTimestamp();
+
+    if (!sequencePath.empty())
+    {
+        saveBirthSequence(sequencePath, birthSequence->value);
+    }
+
+    payload.begin(birthSequence->timestamp);
+    payload.addMetric(birthSequence, true);
+
+    int length = payload.finish(-1);
+
+    if (length < 0 || connection->setWill(deathTopic, buffer, length, SPARKPLUG_QOS, false) != 0)
+    {
+        statistics.failures++;
+        return -1;
+    }
+
+    return 0;
+}
+
+int SparkplugNode::connect(const char* sequencePath)
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    this->sequencePath = sequencePath != NULL ? sequencePath : "";
+
+    // Without a saved bdSeq the first connection has 0
+    if (this->sequencePath.empty() || !loadBirthSequence(this->sequencePath, &metrics[BIRTH_SEQUENCE_ALIAS].value))
+    {
+        metrics[BIRTH_SEQUENCE_ALIAS].value = SPARKPLUG_BIRTH_SEQUENCE_MAX;
+    }
+
+    if (setWill() != 0)
+    {
+        return -1;
+    }
+
+    connection->setMessageHandler(onCommand, this);
+    connection->setDisconnectHandler(onDisconnect, this);
+
+    return connection->connect();
+}
+
+int SparkplugNode::addMetric(const char* name, uint8_t datatype, int8_t exponent, int64_t deadband)
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    if (metricCount >= SPARKPLUG_MAX_METRICS)
+    {
+        return -1;
+    }
+
+    SparkplugMetric_t* metric = &metrics[metricCount];
+
+    metric->name = name;
+    metric->timestamp = currentTimestamp();
+    metric->value = 0;
+    metric->alias = metricCount;
+    metric->datatype = datatype;
+    metric->exponent = exponent;
+    metric->string = strings[metricCount];
+    strings[metricCount][0] = '\0';
+    deadbands[metricCount] = deadband;
+    changed[metricCount] = false;
+
+    // The new metric has to be announced before it can be published by alias
+    rebirth = birthSession != 0;
+
+    return metricCount++;
+}
+
+void SparkplugNode::update(int alias, int64_t value)
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    if (alias < 0 || alias >= metricCount)
+    {
+        return;
+    }
+
+    SparkplugMetric_t* metric = &metrics[alias];
+    int64_t difference = value - metric->value;
+
+    // Only the published value is compared against, so slow drifts are still reported once they exceed the deadband
+    if (difference == 0 || (difference < 0 ? -difference : difference) < deadbands[alias])
+    {
+        return;
+    }
+
+    metric->value = value;
+    metric->timestamp = currentTimestamp();
+
+    if (!changed[alias])
+    {
+        changed[alias] = true;
+        changedCount++;
+    }
+}
+
+void SparkplugNode::update(int alias, const Measurement_t& measurement)
+{
+    if (alias < 0 || alias >= metricCount)
+    {
+        return;
+    }
+
+    update(alias, (int64_t) measurementAs(measurement, metrics[alias].exponent));
+}
+
+void SparkplugNode::update(int alias, const char* value)
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    if (alias < 0 || alias >= metricCount || strncmp(strings[alias], value, SPARKPLUG_STRING_LENGTH - 1) == 0)
+    {
+        return;
+    }
+
+    strncpy(strings[alias], value, SPARKPLUG_STRING_LENGTH - 1);
+    strings[alias][SPARKPLUG_STRING_LENGTH - 1] = '\0';
+    metrics[alias].timestamp = currentTimestamp();
+
+    if (!changed[alias])
+    {
+        changed[alias] = true;
+        changedCount++;
+    }
+}
+
+int SparkplugNode::publishBirth(uint64_t timestamp)
+{
+    payload.begin(timestamp);
+
+    for (uint16_t i = 0; i < metricCount; i++)
+    {
+        payload.addMetric(&metrics[i], true);
+    }
+
+    // NBIRTH always restarts the sequence
+    int length = payload.finish(0);
+
+    if (length < 0 || connection->publish(birthTopic, buffer, length, SPARKPLUG_QOS, false) != 0)
+    {
+        statistics.failures++;
+        return -1;
+    }
+
+    memset(changed, 0, sizeof(changed));
+    changedCount = 0;
+    sequence = 1;
+    statistics.births++;
+
+    return 0;
+}
+
+int SparkplugNode::publishData(uint64_t timestamp)
+{
+    payload.begin(timestamp);
+
+    for (uint16_t i = 0; i < metricCount; i++)
+    {
+        if (changed[i])
+        {
+            payload.addMetric(&metrics[i], false);
+        }
+    }
+
+    int length = payload.finish(sequence);
+
+    if (length < 0 || connection->publish(dataTopic, buffer, length, SPARKPLUG_QOS, false) != 0)
+    {
+        statistics.failures++;
+        return -1;
+    }
+
+    statistics.payloads++;
+    statistics.metrics += changedCount;
+    statistics.bytes += length;
+
+    memset(changed, 0, sizeof(changed));
+    changedCount = 0;
+    sequence++;
+
+    return 0;
+}
+
+int SparkplugNode::publish()
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    if (!connection->isConnected())
+    {
+        return -1;
+    }
+
+    uint32_t session = connection->getSession();
+
+    // A reconnect loses the birth certificate and the command subscription, so both are restated.
+    // The subscription comes first, so a Rebirth sent in answer to the NBIRTH is not missed
+    if (rebirth || session != birthSession)
+    {
+        if (session != birthSession && connection->subscribe(commandTopic, SPARKPLUG_QOS) != 0)
+        {
+            statistics.failures++;
+            return -1;
+        }
+
+        if (publishBirth(currentTimestamp()) != 0)
+        {
+            return -1;
+        }
+
+        birthSession = session;
+        rebirth = false;
+
+        return 0;
+    }
+
+    if (changedCount == 0)
+    {
+        return 0;
+    }
+
+    return publishData(currentTimestamp());
+}
+
+void SparkplugNode::onCommand(const char* topic, const void* payload, int length, void* context)
+{
+    SparkplugNode* node = (SparkplugNode*) context;
+    SparkplugPayloadReader reader(payload, length > 0 ? length : 0);
+    SparkplugReceivedMetric_t metric;
+    size_t nameLength = strlen(SPARKPLUG_REBIRTH_NAME);
+
+    // Rebirth is the only node command supported. Hosts send it by name, or by the alias from the NBIRTH
+    while (reader.nextMetric(&metric) > 0)
+    {
+        bool isRebirth = metric.name != NULL ?
+            metric.nameLength == nameLength && memcmp(metric.name, SPARKPLUG_REBIRTH_NAME, nameLength) == 0 :
+            metric.hasAlias && metric.alias == REBIRTH_ALIAS;
+
+        if (isRebirth && metric.hasBoolean && metric.boolean)
+        {
+            lock_guard<mutex> lock(node->metricsLock);
+            node->rebirth = true;
+            return;
+        }
+    }
+}
+
+void SparkplugNode::onDisconnect(void* context)
+{
+    SparkplugNode* node = (SparkplugNode*) context;
+    lock_guard<mutex> lock(node->metricsLock);
+
+    // The broker has published the NDEATH of the lost connection, the next one needs a new bdSeq
+    node->setWill();
+}
+
+SparkplugStatistics_t SparkplugNode::getStatistics()
+{
+    lock_guard<mutex> lock(metricsLock);
+
+    return statistics;
+}
+
+int32_t SparkplugNode::doExecute()
+{
+    if (!connection->isConnected())
+    {
+        return SPARKPLUG_RETRY_TIME;
+    }
+
+    publish();
+
+    return SPARKPLUG_PUBLISH_TIME;
+}
@@ -0,0 +1,374 @@
+/*
+ * File: SparkplugPayload.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+#include "SparkplugPayload.h"
+#include "Units.h"
+#include <cstring>
+
+// Protobuf wire types
+#define WIRE_VARINT 0
+#define WIRE_FIXED64 1
+#define WIRE_FIXED32 5
+#define WIRE_LENGTH 2
+#define WIRE_TYPE(tag) ((tag) & 0x07)
+
+#define FIELD_TAG(field, wire) ((uint8_t) (((field) << 3) | (wire)))
+
+// Payload fields
+#define PAYLOAD_TIMESTAMP FIELD_TAG(1, WIRE_VARINT)
+#define PAYLOAD_METRIC FIELD_TAG(2, WIRE_LENGTH)
+#define PAYLOAD_SEQUENCE FIELD_TAG(3, WIRE_VARINT)
+
+// Metric fields
+#define METRIC_NAME FIELD_TAG(1, WIRE_LENGTH)
+#define METRIC_ALIAS FIELD_TAG(2, WIRE_VARINT)
+#define METRIC_TIMESTAMP FIELD_TAG(3, WIRE_VARINT)
+#define METRIC_DATATYPE FIELD_TAG(4, WIRE_VARINT)
+#define METRIC_INT_VALUE FIELD_TAG(10, WIRE_VARINT)
+#define METRIC_LONG_VALUE FIELD_TAG(11, WIRE_VARINT)
+#define METRIC_FLOAT_VALUE FIELD_TAG(12, WIRE_FIXED32)
+#define METRIC_BOOLEAN_VALUE FIELD_TAG(14, WIRE_VARINT)
+#define METRIC_STRING_VALUE FIELD_TAG(15, WIRE_LENGTH)
+
+SparkplugPayload::SparkplugPayload(uint8_t* buffer, size_t size) : buffer(buffer), size(size), length(0), overflow(false) {}
+
+void SparkplugPayload::writeByte(uint8_t value)
+{
+    if (length < size)
+    {
+        buffer[length++] = value;
+    }
+    else
+    {
+        overflow = true;
+    }
+}
+
+void SparkplugPayload::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        writeByte((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+
+    writeByte((uint8_t) value);
+}
+
+void SparkplugPayload::writeFixed32(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        writeByte((uint8_t) (value >> (i * 8)));
+    }
+}
+
+void SparkplugPayload::writeBytes(const void* data, size_t size)
+{
+    if (length + size <= this->size)
+    {
+        memcpy(&buffer[length], data, size);
+        length += size;
+    }
+    else
+    {
+        overflow = true;
+    }
+}
+
+void SparkplugPayload::begin(uint64_t timestamp)
+{
+    length = 0;
+    overflow = false;
+
+    writeByte(PAYLOAD_TIMESTAMP);
+    writeVarint(timestamp);
+}
+
+void SparkplugPayload::addMetric(const SparkplugMetric_t* metric, bool birth)
+{
+    writeByte(PAYLOAD_METRIC);
+
+    // Metrics are nearly always shorter than 128 bytes, so reserve a single byte for the length
+    // and shift the metric along in the rare case it needs more.
+    size_t lengthPosition = length;
+    writeByte(0);
+
+    if (birth)
+    {
+        size_t nameLength = strlen(metric->name);
+
+        writeByte(METRIC_NAME);
+        writeVarint(nameLength);
+        writeBytes(metric->name, nameLength);
+    }
+
+    writeByte(METRIC_ALIAS);
+    writeVarint(metric->alias);
+    writeByte(METRIC_TIMESTAMP);
+    writeVarint(metric->timestamp);
+
+    if (birth)
+    {
+        writeByte(METRIC_DATATYPE);
+        writeVarint(metric->datatype);
+    }
+
+    switch (metric->datatype)
+    {
+        case SPARKPLUG_INT32:
+            writeByte(METRIC_INT_VALUE);
+            writeVarint((uint32_t) metric->value);
+            break;
+        case SPARKPLUG_UINT64:
+            writeByte(METRIC_LONG_VALUE);
+            writeVarint((uint64_t) metric->value);
+            break;
+        case SPARKPLUG_FLOAT:
+        {
+            float value = metric->exponent >= 0 ?
+                (float) metric->value * powerOfTen(metric->exponent) :
+                (float) metric->value / powerOfTen(-metric->exponent);
+            uint32_t bits;
+
+            memcpy(&bits, &value, sizeof(bits));
+            writeByte(METRIC_FLOAT_VALUE);
+            writeFixed32(bits);
+            break;
+        }
+        case SPARKPLUG_BOOLEAN:
+            writeByte(METRIC_BOOLEAN_VALUE);
+            writeVarint(metric->value ? 1 : 0);
+            break;
+        case SPARKPLUG_STRING:
+        {
+            size_t stringLength = metric->string != NULL ? strlen(metric->string) : 0;
+
+            writeByte(METRIC_STRING_VALUE);
+            writeVarint(stringLength);
+            if (stringLength > 0)
+            {
+                writeBytes(metric->string, stringLength);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (overflow)
+    {
+        return;
+    }
+
+    size_t metricLength = length - lengthPosition - 1;
+
+    if (metricLength < 0x80)
+    {
+        buffer[lengthPosition] = (uint8_t) metricLength;
+        return;
+    }
+
+    // Metric lengths never exceed two varint bytes, as names are bounded by the buffer size
+    if (length + 1 > size || metricLength >= 0x4000)
+    {
+        overflow = true;
+        return;
+    }
+
+    memmove(&buffer[lengthPosition + 2], &buffer[lengthPosition + 1], metricLength);
+    buffer[lengthPosition] = (uint8_t) (metricLength | 0x80);
+    buffer[lengthPosition + 1] = (uint8_t) (metricLength >> 7);
+    length++;
+}
+
+int SparkplugPayload::finish(int sequence)
+{
+    if (sequence >= 0)
+    {
+        writeByte(PAYLOAD_SEQUENCE);
+        writeVarint(sequence);
+    }
+
+    return overflow ? -1 : (int) length;
+}
+
+/**
+ * @brief Reads a varint without reading past the end
+ * 
+ * @return bool false if the varint is truncated or too long
+ */
+static bool readVarint(const uint8_t* data, size_t end, size_t* position, uint64_t* value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64 && *position < end; shift += 7)
+    {
+        uint8_t byte = data[(*position)++];
+
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Skips the value of a field that is not used
+ * 
+ * @return bool false if the value is truncated, or of a wire type that is not supported
+ */
+static bool skipField(const uint8_t* data, size_t end, size_t* position, uint8_t wire)
+{
+    uint64_t value;
+
+    switch (wire)
+    {
+        case WIRE_VARINT:
+            return readVarint(data, end, position, &value);
+        case WIRE_FIXED64:
+            value = 8;
+            break;
+        case WIRE_FIXED32:
+            value = 4;
+            break;
+        case WIRE_LENGTH:
+            if (!readVarint(data, end, position, &value))
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    if (value > end - *position)
+    {
+        return false;
+    }
+
+    *position += value;
+
+    return true;
+}
+
+SparkplugPayloadReader::SparkplugPayloadReader(const void* data, size_t length) : data((const uint8_t*) data), length(length), position(0) {}
+
+int SparkplugPayloadReader::nextMetric(SparkplugReceivedMetric_t* metric)
+{
+    uint64_t tag;
+    uint64_t value;
+
+    while (position < length)
+    {
+        if (!readVarint(data, length, &position, &tag))
+        {
+            return -1;
+        }
+
+        if (tag != PAYLOAD_METRIC)
+        {
+            if (!skipField(data, length, &position, WIRE_TYPE(tag)))
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        if (!readVarint(data, length, &position, &value) || value > length - position)
+        {
+            return -1;
+        }
+
+        // Fields of the metric are never read past its own length
+        size_t end = position + value;
+
+        memset(metric, 0, sizeof(SparkplugReceivedMetric_t));
+
+        while (position < end)
+        {
+            if (!readVarint(data, end, &position, &tag))
+            {
+                return -1;
+            }
+
+            switch (tag)
+            {
+                case METRIC_NAME:
+                    if (!readVarint(data, end, &position, &value) || value > end - position)
+                    {
+                        return -1;
+                    }
+                    metric->name = (const char*) &data[position];
+                    metric->nameLength = value;
+                    position += value;
+                    break;
+                case METRIC_ALIAS:
+                    if (!readVarint(data, end, &position, &metric->alias))
+                    {
+                        return -1;
+                    }
+                    metric->hasAlias = true;
+                    break;
+                case METRIC_DATATYPE:
+                    if (!readVarint(data, end, &position, &value))
+                    {
+                        return -1;
+                    }
+                    metric->datatype = (uint32_t) value;
+                    break;
+                case METRIC_BOOLEAN_VALUE:
+                    if (!readVarint(data, end, &position, &value))
+                    {
+                        return -1;
+                    }
+                    metric->hasBoolean = true;
+                    metric->boolean = value != 0;
+                    break;
+                default:
+                    if (!skipField(data, end, &position, WIRE_TYPE(tag)))
+                    {
+                        return -1;
+                    }
+                    break;
+            }
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
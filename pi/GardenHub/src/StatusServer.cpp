@@ -0,0 +1,563 @@
+/*
+ * File: StatusServer.cpp
+ * Project: gardener
+ * Created Date: Monday October 19th 2026
+ * Author: Kyle Hofer
+ * 
+ * MIT License
+ * 
+ * Copyright (c) 2022 Kyle Hofer
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * HISTORY:
+ */
+
+
+
+#include "StatusServer.h"
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <cerrno>
+#include <cinttypes>
+#include "Logger.h"
+#include "ModbusUtils.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define STATUS_SERVER "Status Server: "
+
+// Names of the units, indexed by Unit
+static const char* const UNIT_NAMES[] = { "", "V", "A", "W", "VA", "Ah", "kWh", "%", "C", "s", "min" };
+
+static int setNonBlocking(int descriptor)
+{
+    int flags = fcntl(descriptor, F_GETFL, 0);
+
+    return flags < 0 ? -1 : fcntl(descriptor, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ * @brief Sends all of a buffer on a blocking socket, giving up on an error or the send timeout
+ * 
+ */
+static int sendAll(int socket, const char* data, size_t length, int flags)
+{
+    while (length > 0)
+    {
+        ssize_t result = ::send(socket, data, length, flags | MSG_NOSIGNAL);
+
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (result <= 0)
+        {
+            return -1;
+        }
+
+        data += result;
+        length -= result;
+    }
+
+    return 0;
+}
+
+StatusServer::StatusServer() :
+    listener(-1), modbusClientCount(0), snapshot(NULL), response(NULL), responseLength(0), overflowed(false), startTime(chrono::steady_clock::now()), built(false)
+{
+    for (uint8_t i = 0; i < STATUS_MAX_CLIENTS; i++)
+    {
+        clients[i].socket = -1;
+        clients[i].length = 0;
+    }
+}
+
+StatusServer::~StatusServer()
+{
+    for (uint8_t i = 0; i < STATUS_MAX_CLIENTS; i++)
+    {
+        drop(i);
+    }
+
+    if (listener >= 0)
+    {
+        close(listener);
+    }
+
+    delete snapshot;
+    delete[] response;
+}
+
+int StatusServer::addClient(ProfiledModbusClient* modbusClient)
+{
+    if (modbusClientCount >= HUB_MAX_BUSES)
+    {
+        return -1;
+    }
+
+    modbusClients[modbusClientCount++] = modbusClient;
+    return 0;
+}
+
+int StatusServer::listen(const char* address, int port)
+{
+    sockaddr_in local;
+    int reuse = 1;
+
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, address, &local.sin_addr) != 1)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, STATUS_SERVER "invalid address %s", address);
+        return -1;
+    }
+
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listener < 0 || setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(listener, (sockaddr*) &local, sizeof(local)) != 0 || ::listen(listener, STATUS_BACKLOG) != 0 ||
+        setNonBlocking(listener) != 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, STATUS_SERVER "unable to listen on %s:%d. Error: %s", address, port, std::strerror(errno));
+
+        if (listener >= 0)
+        {
+            close(listener);
+            listener = -1;
+        }
+        return -1;
+    }
+
+    // Taken once the server is known to be needed, and never again while it runs
+    snapshot = new ClientCheckpoint_t;
+    response = new char[STATUS_RESPONSE_LENGTH];
+
+    HUB_LOG(LOG_LEVEL_INFO, STATUS_SERVER "listening on %s:%d", address, port);
+
+    return 0;
+}
+
+void StatusServer::accept()
+{
+    int descriptor = ::accept(listener, NULL, NULL);
+
+    if (descriptor < 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < STATUS_MAX_CLIENTS; i++)
+    {
+        if (clients[i].socket < 0)
+        {
+            setNonBlocking(descriptor);
+            clients[i].socket = descriptor;
+            clients[i].length = 0;
+            clients[i].accepted = chrono::steady_clock::now();
+            return;
+        }
+    }
+
+    HUB_LOG(LOG_LEVEL_WARNING, STATUS_SERVER "too many clients, connection refused");
+    close(descriptor);
+}
+
+void StatusServer::drop(uint8_t client)
+{
+    if (clients[client].socket < 0)
+    {
+        return;
+    }
+
+    close(clients[client].socket);
+    clients[client].socket = -1;
+    clients[client].length = 0;
+}
+
+void StatusServer::receive(uint8_t client)
+{
+    StatusClient_t& state = clients[client];
+    // One byte is kept for the terminator, so the request can be searched as a string
+    ssize_t result = recv(state.socket, &state.request[state.length], sizeof(state.request) - state.length - 1, 0);
+
+    if (result == 0 || (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+    {
+        drop(client);
+        return;
+    }
+
+    if (result < 0)
+    {
+        return;
+    }
+
+    state.length += result;
+    state.request[state.length] = '\0';
+
+    // Only the request line is used, so a request is answered as soon as its headers are in
+    if (strstr(state.request, "\r\n\r\n") != NULL || strstr(state.request, "\n\n") != NULL)
+    {
+        answer(client);
+    }
+    else if (state.length >= sizeof(state.request) - 1)
+    {
+        send(client, "431 Request Header Fields Too Large", NULL, 0);
+    }
+}
+
+void StatusServer::answer(uint8_t client)
+{
+    char* request = clients[client].request;
+    char* path = strchr(request, ' ');
+    char* end = path != NULL ? strpbrk(path + 1, " ?\r\n") : NULL;
+
+    if (path == NULL || end == NULL)
+    {
+        send(client, "400 Bad Request", NULL, 0);
+        return;
+    }
+
+    *path++ = '\0';
+    *end = '\0';
+
+    if (strcmp(request, "GET") != 0)
+    {
+        send(client, "405 Method Not Allowed", NULL, 0);
+    }
+    else if (strcmp(path, "/") != 0 && strcmp(path, "/status") != 0)
+    {
+        send(client, "404 Not Found", NULL, 0);
+    }
+    else
+    {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+        // Every request in a burst is sent the same response, so polling the status costs the hub next to nothing
+        if (!built || now - builtTime >= chrono::milliseconds(STATUS_CACHE_TIME))
+        {
+            build();
+            builtTime = now;
+            built = true;
+        }
+
+        if (overflowed)
+        {
+            send(client, "500 Internal Server Error", NULL, 0);
+        }
+        else
+        {
+            send(client, "200 OK", response, responseLength);
+        }
+    }
+}
+
+void StatusServer::send(uint8_t client, const char* status, const char* body, size_t length)
+{
+    char header[256];
+    int socket = clients[client].socket;
+    timeval timeout = { STATUS_CLIENT_TIMEOUT / 1000, (STATUS_CLIENT_TIMEOUT % 1000) * 1000 };
+    int headerLength = snprintf(header, sizeof(header),
+        "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n",
+        status, length);
+
+    // Responses are sent in one go, and a client that stops reading is given up on after the timeout
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) & ~O_NONBLOCK);
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (sendAll(socket, header, headerLength, length > 0 ? MSG_MORE : 0) == 0 && length > 0)
+    {
+        sendAll(socket, body, length, 0);
+    }
+
+    // Nothing more is read, so the client sees the end of the response rather than a reset
+    shutdown(socket, SHUT_WR);
+    drop(client);
+}
+
+void StatusServer::append(const char* format, ...)
+{
+    va_list arguments;
+
+    if (overflowed)
+    {
+        return;
+    }
+
+    va_start(arguments, format);
+    int result = vsnprintf(&response[responseLength], STATUS_RESPONSE_LENGTH - responseLength, format, arguments);
+    va_end(arguments);
+
+    if (result < 0 || (size_t) result >= STATUS_RESPONSE_LENGTH - responseLength)
+    {
+        overflowed = true;
+        return;
+    }
+
+    responseLength += result;
+}
+
+void StatusServer::appendString(const char* value)
+{
+    append("\"");
+
+    for (; *value != '\0' && !overflowed; value++)
+    {
+        unsigned char character = *value;
+
+        if (character == '"' || character == '\\')
+        {
+            append("\\%c", character);
+        }
+        else if (character < 0x20)
+        {
+            append("\\u%04x", character);
+        }
+        else
+        {
+            append("%c", character);
+        }
+    }
+
+    append("\"");
+}
+
+void StatusServer::appendMeasurement(const Measurement_t& measurement)
+{
+    // Printed as a fixed point decimal, so the value is exactly what the device reported
+    if (measurement.exponent >= 0)
+    {
+        append("%" PRId64, (int64_t) measurement.value * (int64_t) powerOfTen(measurement.exponent));
+    }
+    else
+    {
+        int64_t scale = powerOfTen(-measurement.exponent);
+        int64_t value = measurement.value;
+        uint64_t magnitude = value < 0 ? -value : value;
+
+        append("%s%" PRIu64 ".%0*" PRIu64, value < 0 ? "-" : "", magnitude / scale, -measurement.exponent, magnitude % scale);
+    }
+
+    append(",\"unit\":");
+    appendString(measurement.unit < sizeof(UNIT_NAMES) / sizeof(UNIT_NAMES[0]) ? UNIT_NAMES[measurement.unit] : "");
+}
+
+void StatusServer::buildDevice(ProfiledModbusClient* modbusClient, int index, int64_t stagedAt)
+{
+    const DeviceProfile_t* profile = modbusClient->getProfile(index);
+    const DeviceCheckpoint_t& device = snapshot->devices[index];
+    const DeviceHealth_t& state = health[index];
+    size_t prefixLength = strlen(profile->name);
+    bool first = true;
+
+    // Devices of the same profile are told apart by the name of their section
+    append("{\"name\":");
+    appendString(modbusClient->getName(index));
+    append(",\"profile\":");
+    appendString(profile->name);
+    append(",\"slave\":%d,\"enabled\":%s,\"online\":%s,\"reads\":%" PRIu32 ",\"failures\":%" PRIu32 ",\"consecutiveFailures\":%" PRIu32 ",\"lastRead\":",
+        device.slaveId, state.enabled ? "true" : "false", state.online ? "true" : "false", state.reads, state.failures, state.consecutiveFailures);
+    append(state.lastRead != 0 ? "%" PRId64 : "null", state.lastRead);
+    append(",\"metrics\":{");
+
+    for (uint8_t i = 0; i < profile->metricCount; i++)
+    {
+        const ProfileMetric_t& metric = profile->metrics[i];
+        const uint16_t* registers = device.registers[metric.table];
+        uint16_t address = metric.value.address;
+        bool valid = false;
+
+        // Only metrics of groups that have been read, or restored, have values
+        for (uint8_t g = 0; g < profile->groupCount && !valid; g++)
+        {
+            valid = (device.validGroups & (1 << g)) && metricInGroup(metric, profile->groups[g]);
+        }
+
+        if (!valid)
+        {
+            continue;
+        }
+
+        append(first ? "" : ",");
+        first = false;
+        // Metric names start with the name of the device, which the object already has
+        appendString(strncmp(metric.name, profile->name, prefixLength) == 0 && metric.name[prefixLength] == '/' ? &metric.name[prefixLength + 1] : metric.name);
+        append(":");
+
+        switch (metric.type)
+        {
+            case METRIC_NUMBER:
+            {
+                Measurement_t measurement;
+
+                if (convertRegisters(registers, PROFILE_TABLE_SIZE, &metric.value, 1, &measurement) == 1)
+                {
+                    append("{\"value\":");
+                    appendMeasurement(measurement);
+                    append("}");
+                }
+                else
+                {
+                    append("null");
+                }
+                break;
+            }
+            case METRIC_BOOLEAN:
+                append(registers[address] != 0 ? "true" : "false");
+                break;
+            case METRIC_STRING:
+            {
+                char value[SPARKPLUG_STRING_LENGTH];
+
+                if (unpackStringRegisters(&registers[address], metric.length, value, sizeof(value)) > 0)
+                {
+                    appendString(value);
+                }
+                else
+                {
+                    append("null");
+                }
+                break;
+            }
+            case METRIC_UPTIME:
+            {
+                uint32_t uptime = ((uint32_t) registers[address] << 16) | registers[address + 1];
+
+                // A wall clock time in milliseconds, known once the event log has given the uptime of the device
+                if (profile->eventLog != NO_EVENT_LOG && device.eventUptime != 0 && uptime <= device.eventUptime)
+                {
+                    append("%" PRId64, stagedAt - (int64_t) (device.eventUptime - uptime) * 1000);
+                }
+                else
+                {
+                    append("null");
+                }
+                break;
+            }
+            default:
+                append("null");
+                break;
+        }
+    }
+
+    append("}}");
+}
+
+void StatusServer::build()
+{
+    responseLength = 0;
+    overflowed = false;
+
+    append("{\"uptime\":%" PRId64 ",\"buses\":[",
+        (int64_t) chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - startTime).count());
+
+    for (uint8_t i = 0; i < modbusClientCount; i++)
+    {
+        ProfiledModbusClient* modbusClient = modbusClients[i];
+        ModbusConnection* connection = modbusClient->getConnection();
+        ModbusStatistics_t statistics = connection->getStatistics();
+        int64_t stagedAt = 0;
+        // The health and the values are copied separately, so they may be a single stage apart
+        int count = modbusClient->getCheckpoint(snapshot) == 0 ? modbusClient->getHealth(health, &stagedAt) : -1;
+
+        append("%s{\"bus\":%d,\"port\":", i > 0 ? "," : "", modbusClient->getBus());
+        appendString(connection->getPort() != NULL ? connection->getPort() : "");
+        append(",\"connected\":%s,\"requests\":%" PRIu32 ",\"failures\":%" PRIu32 ",\"reconnects\":%" PRIu32 ",\"outage\":%" PRIu32 ",\"updated\":",
+            connection->isConnected() ? "true" : "false", statistics.requests, statistics.failures, statistics.reconnects, statistics.outage);
+        append(count >= 0 ? "%" PRId64 : "null", stagedAt);
+        append(",\"devices\":[");
+
+        for (int d = 0; d < count; d++)
+        {
+            append(d > 0 ? "," : "");
+            buildDevice(modbusClient, d, stagedAt);
+        }
+
+        append("]}");
+    }
+
+    append("]}\n");
+
+    if (overflowed)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, STATUS_SERVER "the status is longer than %d bytes", STATUS_RESPONSE_LENGTH);
+    }
+}
+
+int32_t StatusServer::doExecute()
+{
+    pollfd descriptors[STATUS_MAX_CLIENTS + 1];
+    uint8_t indexes[STATUS_MAX_CLIENTS];
+    nfds_t count = 1;
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+    if (listener < 0)
+    {
+        return STATUS_POLL_TIMEOUT;
+    }
+
+    descriptors[0].fd = listener;
+    descriptors[0].events = POLLIN;
+
+    for (uint8_t i = 0; i < STATUS_MAX_CLIENTS; i++)
+    {
+        // Clients that never finish their request would otherwise hold their slot for good
+        if (clients[i].socket >= 0 && now - clients[i].accepted >= chrono::milliseconds(STATUS_CLIENT_TIMEOUT))
+        {
+            drop(i);
+        }
+
+        if (clients[i].socket >= 0)
+        {
+            descriptors[count].fd = clients[i].socket;
+            descriptors[count].events = POLLIN;
+            indexes[count - 1] = i;
+            count++;
+        }
+    }
+
+    // The wait is in poll, so there is no delay before the next execute
+    if (poll(descriptors, count, count > 1 ? STATUS_CLIENT_TIMEOUT : STATUS_POLL_TIMEOUT) <= 0)
+    {
+        return 0;
+    }
+
+    for (nfds_t i = 1; i < count; i++)
+    {
+        if (descriptors[i].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            receive(indexes[i - 1]);
+        }
+    }
+
+    if (descriptors[0].revents & POLLIN)
+    {
+        accept();
+    }
+
+    return 0;
+}
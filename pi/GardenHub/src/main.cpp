@@ -31,6 +31,7 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <cstring>
 
 #include <termios.h>
 #include <unistd.h>
@@ -42,15 +43,15 @@
 #include <csignal>
 #include <atomic>
 
-#include "GardenBedClient.h"
-#include "GardenShedClient.h"
+#include "ProfiledModbusClient.h"
+#include "ModbusGateway.h"
+#include "StatusServer.h"
 #include "ModbusConnection.h"
-
-#define MODBUS_PORT "/dev/ttySC0"
-#define MODBUS_BAUD 38400
-#define MODBUS_DATA_BITS 8
-#define MODBUS_STOP_BITS 2
-#define MODBUS_PARITY 'N'
+#include "MqttConnection.h"
+#include "SparkplugNode.h"
+#include "ConfigStore.h"
+#include "CheckpointStore.h"
+#include "Logger.h"
 
 #define MODBUS_ENABLED
 
@@ -58,40 +59,281 @@ using namespace std;
 
 vector<thread> threads;
 
-void gardenBedRunner(ModbusConnection* modbusConnection)
+// Set by SIGTERM and SIGINT, so the state can be saved before the hub stops
+volatile sig_atomic_t stopping = 0;
+
+void modbusRunner(ProfiledModbusClient* modbusClient)
+{
+    for(;;) { modbusClient->executeSync(); }
+}
+
+typedef struct {
+    const char* key;        // Named by the profile key of a device section
+    const DeviceProfile_t* profile;
+} ProfileKey_t;
+
+static const ProfileKey_t PROFILE_KEYS[] = {
+    { "bed", &GARDEN_BED_PROFILE },
+    { "shed", &GARDEN_SHED_PROFILE }
+};
+
+/**
+ * @brief Adds a device to the client of the bus it is wired to
+ * 
+ * @return int non-zero return if the device has no known profile or does not fit
+ */
+int addDevice(ProfiledModbusClient* clients[], const DeviceConfig_t& settings)
+{
+    const DeviceProfile_t* profile = NULL;
+
+    for (const ProfileKey_t& candidate : PROFILE_KEYS)
+    {
+        if (strcmp(candidate.key, settings.profile) == 0)
+        {
+            profile = candidate.profile;
+            break;
+        }
+    }
+
+    if (profile == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, "Device %s: unknown profile '%s'", settings.name, settings.profile);
+        return -1;
+    }
+
+    if (clients[settings.bus] == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, "%s: bus %d has no port, the device will not be polled", settings.name, settings.bus);
+        return 0;
+    }
+
+    // A device named after its profile, such as the default bed and shed, keeps the metric names of the profile
+    const char* label = strcmp(settings.name, settings.profile) == 0 ? NULL : settings.name;
+
+    if (clients[settings.bus]->addDevice(profile, settings.name, settings.slaveId != 0 ? settings.slaveId : -1, label) < 0)
+    {
+        HUB_LOG(LOG_LEVEL_ERROR, "Device %s: does not fit on bus %d", settings.name, settings.bus);
+        return -1;
+    }
+
+    return 0;
+}
+
+void gatewayRunner(ModbusGateway* gateway)
+{
+    for(;;) { gateway->executeSync(); }
+}
+
+void gatewayBusRunner(ModbusGateway* gateway)
+{
+    for(;;) { gateway->forward(); }
+}
+
+void statusRunner(StatusServer* statusServer)
+{
+    for(;;) { statusServer->executeSync(); }
+}
+
+void sparkplugRunner(SparkplugNode* sparkplugNode)
+{
+    for(;;) { sparkplugNode->executeSync(); }
+}
+
+void configRunner(ConfigStore* configStore)
 {
-    GardenBedClient gardenBed = GardenBedClient(modbusConnection);
+    for(;;) { configStore->executeSync(); }
+}
 
-    for(;;) { gardenBed.executeSync(); }
+void loggerRunner(Logger* logger)
+{
+    for(;;) { logger->executeSync(); }
 }
 
-void gardenShedRunner(ModbusConnection* modbusConnection)
+void checkpointRunner(CheckpointStore* checkpointStore)
 {
-    GardenShedClient gardenShed = GardenShedClient(modbusConnection);
+    for(;;) { checkpointStore->executeSync(); }
+}
 
-    for(;;) { gardenShed.executeSync(); }
+void flushLogger()
+{
+    Logger::flush();
+}
+
+void stop(int signalNumber)
+{
+    stopping = 1;
 }
 
 int main(int argc, char *argv[])
 {
-    ModbusConnection modbusConnection;
+    Logger logger;
 
-    if (modbusConnection.configure(MODBUS_PORT, MODBUS_BAUD, MODBUS_PARITY, MODBUS_DATA_BITS, MODBUS_STOP_BITS) != 0)
+    // Started first so nothing logged waits long, and flushed at exit so the reason for a failed start is not lost.
+    // Detached, as threads still joinable when exit destroys the list would abort the hub
+    atexit(flushLogger);
+    thread(loggerRunner, &logger).detach();
+
+    ConfigStore configStore(argc > 1 ? argv[1] : CONFIG_DEFAULT_PATH);
+
+    if (configStore.load() != 0)
     {
         exit(EXIT_FAILURE);
     }
 
-    if (modbusConnection.connect() != 0)
+    // Serial and broker settings are fixed for the life of the process, so the startup snapshot is kept for them
+    shared_ptr<const HubConfig_t> config = configStore.get();
+    const MqttConfig_t& mqtt = config->mqtt;
+    const GatewayConfig_t& gateway = config->gateway;
+    const StatusConfig_t& status = config->status;
+
+    // Every bus has its own connection, client and thread, so a slow bus never holds up the others
+    ModbusConnection modbusConnections[HUB_MAX_BUSES];
+    ProfiledModbusClient* modbusClients[HUB_MAX_BUSES] = { NULL };
+    MqttConnection mqttConnection;
+    SparkplugNode sparkplugNode(&mqttConnection, mqtt.group, mqtt.node);
+
+    for (int i = 0; i < HUB_MAX_BUSES; i++)
+    {
+        const SerialConfig_t& modbus = config->modbus[i];
+
+        if (modbus.port[0] == '\0')
+        {
+            continue;
+        }
+
+        if (modbusConnections[i].configure(modbus.port, modbus.baud, modbus.parity, modbus.dataBits, modbus.stopBits) != 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+
+        // A port that is missing at startup is retried by the client, the same as one lost while running
+        if (modbusConnections[i].connect() != 0)
+        {
+            HUB_LOG(LOG_LEVEL_WARNING, "Modbus bus %d is not connected, retrying in the background", i);
+        }
+
+        // Clients are never destroyed, their threads run for the life of the process
+        modbusClients[i] = new ProfiledModbusClient(&modbusConnections[i], &sparkplugNode, &configStore, i);
+    }
+
+    // Devices are added before any thread starts, in the order of their sections, so metric aliases are the same on every start
+    for (int32_t i = 0; i < config->deviceCount; i++)
+    {
+        if (addDevice(modbusClients, config->devices[i]) != 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    CheckpointStore* checkpointStore = NULL;
+
+    // Restored before any thread starts, so the cached state is published before the first read
+    if (config->checkpoint.path[0] != '\0')
+    {
+        checkpointStore = new CheckpointStore(config->checkpoint.path, config->checkpoint.period * 1000);
+
+        for (int i = 0; i < HUB_MAX_BUSES; i++)
+        {
+            if (modbusClients[i] != NULL)
+            {
+                checkpointStore->addClient(modbusClients[i]);
+            }
+        }
+
+        checkpointStore->restore();
+    }
+
+    ModbusGateway* modbusGateway = NULL;
+
+    if (gateway.enabled && modbusClients[gateway.bus] == NULL)
+    {
+        HUB_LOG(LOG_LEVEL_WARNING, "Modbus Gateway: bus %d has no port, the gateway will not be started", gateway.bus);
+    }
+    else if (gateway.enabled)
+    {
+        // Shares the connection of its bus, so its requests queue behind the hub's own
+        modbusGateway = new ModbusGateway(&modbusConnections[gateway.bus]);
+
+        if (modbusGateway->listen(gateway.address, gateway.port) != 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    StatusServer statusServer;
+    bool statusListening = false;
+
+    if (status.enabled)
+    {
+        for (int i = 0; i < HUB_MAX_BUSES; i++)
+        {
+            if (modbusClients[i] != NULL)
+            {
+                statusServer.addClient(modbusClients[i]);
+            }
+        }
+
+        // Only for watching the hub, so it keeps polling without it
+        statusListening = statusServer.listen(status.address, status.port) == 0;
+    }
+
+    if (mqttConnection.configure(mqtt.host, mqtt.port, mqtt.node) != 0)
     {
         exit(EXIT_FAILURE);
     }
 
+    if (sparkplugNode.connect(mqtt.sequencePath) != 0)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    threads.push_back(thread(sparkplugRunner, &sparkplugNode));
+
+    // Without a watch the hub still runs, changes just need a restart
+    if (configStore.watch() == 0)
+    {
+        threads.push_back(thread(configRunner, &configStore));
+    }
+
     #ifdef MODBUS_ENABLED
-    threads.push_back(thread(gardenBedRunner, &modbusConnection));
-    threads.push_back(thread(gardenShedRunner, &modbusConnection));
+    for (int i = 0; i < HUB_MAX_BUSES; i++)
+    {
+        if (modbusClients[i] != NULL)
+        {
+            threads.push_back(thread(modbusRunner, modbusClients[i]));
+        }
+    }
+
+    if (modbusGateway != NULL)
+    {
+        threads.push_back(thread(gatewayRunner, modbusGateway));
+        threads.push_back(thread(gatewayBusRunner, modbusGateway));
+    }
+
+    if (checkpointStore != NULL)
+    {
+        threads.push_back(thread(checkpointRunner, checkpointStore));
+    }
     #endif
 
-    for(;;) { this_thread::sleep_for(std::chrono::seconds(1)); }
+    if (statusListening)
+    {
+        threads.push_back(thread(statusRunner, &statusServer));
+    }
 
-    return 0;
+    signal(SIGTERM, stop);
+    signal(SIGINT, stop);
+
+    while (!stopping) { this_thread::sleep_for(std::chrono::milliseconds(100)); }
+
+    HUB_LOG(LOG_LEVEL_INFO, "Stopping");
+
+    if (checkpointStore != NULL)
+    {
+        checkpointStore->save();
+    }
+
+    // The other threads never return, so the hub leaves without unwinding them
+    Logger::flush();
+    _exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include <ctime>
+
+#include "Schedule.h"
+
+// Published times are to the minute, and the equation is accurate to a few minutes away from the poles
+#define SUN_TOLERANCE (3 * 60)
+
+static time_t utc(int year, int month, int day, int hour, int minute)
+{
+    struct tm date = {};
+
+    date.tm_year = year - 1900;
+    date.tm_mon = month - 1;
+    date.tm_mday = day;
+    date.tm_hour = hour;
+    date.tm_min = minute;
+
+    return timegm(&date);
+}
+
+TEST(Schedule, TestSunTimes) {
+    time_t sunrise, sunset;
+
+    // London on the June solstice, 04:43 and 21:21 BST
+    ASSERT_EQ(sunTimes(2024, 6, 21, 51.5074, -0.1278, &sunrise, &sunset), 0);
+    EXPECT_NEAR((double) sunrise, (double) utc(2024, 6, 21, 3, 43), SUN_TOLERANCE);
+    EXPECT_NEAR((double) sunset, (double) utc(2024, 6, 21, 20, 21), SUN_TOLERANCE);
+
+    // Sydney on the December solstice, 05:41 and 20:05 AEDT, so sunrise is the previous day in UTC
+    ASSERT_EQ(sunTimes(2024, 12, 21, -33.8688, 151.2093, &sunrise, &sunset), 0);
+    EXPECT_NEAR((double) sunrise, (double) utc(2024, 12, 20, 18, 41), SUN_TOLERANCE);
+    EXPECT_NEAR((double) sunset, (double) utc(2024, 12, 21, 9, 5), SUN_TOLERANCE);
+}
+
+TEST(Schedule, TestPolarDayAndNight) {
+    time_t sunrise = 0, sunset = 0;
+
+    // Tromsø has the midnight sun in June and the polar night in December
+    EXPECT_EQ(sunTimes(2024, 6, 21, 69.6492, 18.9553, &sunrise, &sunset), -1);
+    EXPECT_EQ(sunTimes(2024, 12, 21, 69.6492, 18.9553, &sunrise, &sunset), -1);
+    EXPECT_EQ(sunrise, 0);
+    EXPECT_EQ(sunset, 0);
+
+    // And the other way around at the south pole
+    EXPECT_EQ(sunTimes(2024, 6, 21, -89.0, 0.0, &sunrise, &sunset), -1);
+    EXPECT_EQ(sunTimes(2024, 12, 21, -89.0, 0.0, &sunrise, &sunset), -1);
+}
+
+TEST(Schedule, TestParseProgram) {
+    ScheduleProgram_t program;
+
+    ASSERT_EQ(parseScheduleProgram("sunset-15 45 600, 22:00 0 300, sunrise 100", &program), 0);
+    ASSERT_EQ(program.count, 3);
+    EXPECT_EQ(program.events[0].anchor, ANCHOR_SUNSET);
+    EXPECT_EQ(program.events[0].offset, -15);
+    EXPECT_EQ(program.events[0].level, 45);
+    EXPECT_EQ(program.events[0].ramp, 600);
+    EXPECT_EQ(program.events[1].anchor, ANCHOR_MIDNIGHT);
+    EXPECT_EQ(program.events[1].offset, 22 * 60);
+    EXPECT_EQ(program.events[1].level, 0);
+    EXPECT_EQ(program.events[1].ramp, 300);
+    EXPECT_EQ(program.events[2].anchor, ANCHOR_SUNRISE);
+    EXPECT_EQ(program.events[2].offset, 0);
+    EXPECT_EQ(program.events[2].level, SCHEDULE_MAX_LEVEL);
+    EXPECT_EQ(program.events[2].ramp, 0);
+
+    ASSERT_EQ(parseScheduleProgram("", &program), 0);
+    EXPECT_EQ(program.count, 0);
+}
+
+TEST(Schedule, TestParseInvalidProgram) {
+    ScheduleProgram_t program;
+    const char* invalid[] = {
+        "22:00 250",                // Above the highest level
+        "22:00 101",
+        "22:00 -1",
+        "22:00 10 -5",              // Negative ramp
+        "24:00 10",                 // Out of range times
+        "12:60 10",
+        "12:00x 10",
+        "noon 10",                  // Unknown anchor
+        "sunset*5 10",
+        "sunset+1440 10",           // Offsets of a day or more
+        "22:00",                    // Missing level
+        "22:00 10 5 extra",
+        "1:00 1, 2:00 1, 3:00 1, 4:00 1, 5:00 1, 6:00 1, 7:00 1, 8:00 1, 9:00 1"    // More than SCHEDULE_MAX_EVENTS
+    };
+
+    for (const char* text : invalid)
+    {
+        EXPECT_EQ(parseScheduleProgram(text, &program), -1) << text;
+    }
+}